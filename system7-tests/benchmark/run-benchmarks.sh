@@ -0,0 +1,493 @@
+#!/bin/sh
+
+# Performance benchmarks for s7.
+#
+# Generates a synthetic workspace out of local bare repos (no network involved)
+# and times real s7 paths on it: hooks triggered by git commands and s7 commands.
+# Benchmarks the s7 installed to /usr/local/bin/s7 – that's what git hooks call.
+#
+# Usage:
+#   run-benchmarks.sh [OPTIONS] [SCENARIO]...
+#   run-benchmarks.sh --compare BASELINE.json [RESULTS.json]
+#
+# Scenarios (all by default):
+#   checkout   post-checkout hook on a main repo branch switch that updates every subrepo
+#   status     `s7 status` on a clean workspace
+#   rebind     `s7 rebind` on a workspace with nothing to rebind
+#   merge      merge-driver merge with every subrepo diverged (S7_MERGE_DRIVER_RESPONSE=m)
+#   push       pre-push hook with --unpushed substate commits to push
+#
+# Workspace options:
+#   --subrepos N     number of subrepos in the main repo (default: 20)
+#   --depth D        nesting depth. Every subrepo is a chain of D nested s7 repos (default: 1)
+#   --commits H      history length of every repo (default: 200)
+#   --refs R         number of extra branches and tags in every repo (default: 20)
+#   --files F        number of files in every repo (default: 50)
+#   --unpushed K     number of substate commits for the push scenario (default: 3)
+#
+# Run options:
+#   --runs K         timed runs per scenario (default: 10)
+#   --warmup W       untimed runs before timed ones (default: 1)
+#   --output FILE    where to save results (default: benchmark-results.json)
+#   --keep           do not remove the sandbox after the run
+#
+# Compare options:
+#   --compare BASELINE [RESULTS]
+#                    compares medians of RESULTS (or of a fresh run with the options above)
+#                    with BASELINE. Fails if any scenario is slower by more than the threshold.
+#   --threshold P    allowed slowdown in percent (default: 10)
+#
+
+SCRIPT_SOURCE_DIR="$( cd "$( dirname "$0" )" >/dev/null 2>&1 && pwd )"
+
+SUBREPOS=20
+DEPTH=1
+COMMITS=200
+REFS=20
+FILES=50
+UNPUSHED=3
+RUNS=10
+WARMUP=1
+OUTPUT="benchmark-results.json"
+KEEP=0
+BASELINE=""
+RESULTS_TO_COMPARE=""
+THRESHOLD=10
+SCENARIOS=""
+
+ALL_SCENARIOS="checkout status rebind merge push"
+
+while [ $# -gt 0 ]
+do
+    case "$1" in
+        --subrepos)  SUBREPOS="$2"; shift ;;
+        --depth)     DEPTH="$2"; shift ;;
+        --commits)   COMMITS="$2"; shift ;;
+        --refs)      REFS="$2"; shift ;;
+        --files)     FILES="$2"; shift ;;
+        --unpushed)  UNPUSHED="$2"; shift ;;
+        --runs)      RUNS="$2"; shift ;;
+        --warmup)    WARMUP="$2"; shift ;;
+        --output)    OUTPUT="$2"; shift ;;
+        --keep)      KEEP=1 ;;
+        --threshold) THRESHOLD="$2"; shift ;;
+        --compare)
+            BASELINE="$2"
+            shift
+            if [ -n "$2" ] && [ "${2#--}" = "$2" ] && [ -f "$2" ]; then
+                RESULTS_TO_COMPARE="$2"
+                shift
+            fi
+            ;;
+        -h|--help)
+            sed -n '3,/^$/p' "$0" | sed 's/^# \{0,1\}//'
+            exit 0
+            ;;
+        -*)
+            echo >&2 "unknown option $1"
+            exit 1
+            ;;
+        *)
+            SCENARIOS="$SCENARIOS $1"
+            ;;
+    esac
+    shift
+done
+
+if [ -z "$SCENARIOS" ]; then
+    SCENARIOS="$ALL_SCENARIOS"
+fi
+
+for SCENARIO in $SCENARIOS
+do
+    case " $ALL_SCENARIOS " in
+        *" $SCENARIO "*) ;;
+        *) echo >&2 "unknown scenario '$SCENARIO'"; exit 1 ;;
+    esac
+done
+
+#
+# stats
+#
+
+# prints JSON object with stats of samples (one number in milliseconds per line) in file $1
+stats() {
+    sort -n "$1" | awk '
+        function percentile(p,    i) {
+            i = int(p / 100 * NR + 0.999999)
+            if (i < 1) i = 1
+            if (i > NR) i = NR
+            return a[i]
+        }
+        { a[NR] = $1; sum += $1 }
+        END {
+            if (NR % 2) median = a[(NR + 1) / 2]
+            else median = (a[NR / 2] + a[NR / 2 + 1]) / 2
+            printf "{\"runs\": %d, \"min_ms\": %.1f, \"median_ms\": %.1f, \"mean_ms\": %.1f, \"p90_ms\": %.1f, \"p95_ms\": %.1f, \"max_ms\": %.1f}",
+                   NR, a[1], median, sum / NR, percentile(90), percentile(95), a[NR]
+        }'
+}
+
+# prints "scenario median" lines from a results file written by this script
+medians() {
+    sed -n 's/^ *"\([a-z]*\)": {"runs": [0-9]*, .*"median_ms": \([0-9.]*\).*/\1 \2/p' "$1"
+}
+
+compare() {
+    local BASELINE_FILE="$1"
+    local RESULTS_FILE="$2"
+
+    medians "$BASELINE_FILE" > "$BASELINE_FILE.medians"
+    medians "$RESULTS_FILE" > "$RESULTS_FILE.medians"
+
+    awk -v threshold="$THRESHOLD" '
+        NR == FNR { baseline[$1] = $2; next }
+        BEGIN { printf "%-10s %12s %12s %9s\n", "scenario", "baseline ms", "current ms", "delta" }
+        {
+            if (!($1 in baseline)) {
+                printf "%-10s %12s %12.1f %9s\n", $1, "-", $2, "new"
+                next
+            }
+            delta = baseline[$1] > 0 ? ($2 - baseline[$1]) * 100 / baseline[$1] : 0
+            mark = ""
+            if (delta > threshold) { mark = "  🚨"; failed = 1 }
+            printf "%-10s %12.1f %12.1f %+8.1f%%%s\n", $1, baseline[$1], $2, delta, mark
+        }
+        END { exit failed }
+    ' "$BASELINE_FILE.medians" "$RESULTS_FILE.medians"
+    local EXIT_CODE=$?
+
+    rm -f "$BASELINE_FILE.medians" "$RESULTS_FILE.medians"
+
+    return $EXIT_CODE
+}
+
+if [ -n "$BASELINE" ] && [ -n "$RESULTS_TO_COMPARE" ]; then
+    compare "$BASELINE" "$RESULTS_TO_COMPARE"
+    exit $?
+fi
+
+#
+# workspace
+#
+
+SANDBOX_DIR="$SCRIPT_SOURCE_DIR/sandbox"
+GITHUB_DIR="$SANDBOX_DIR/github"
+WORKSPACE_DIR="$SANDBOX_DIR/workspace"
+LOG="$SANDBOX_DIR/log.txt"
+
+export GIT_AUTHOR_NAME="s7 benchmark"
+export GIT_AUTHOR_EMAIL="benchmark@s7"
+export GIT_COMMITTER_NAME="s7 benchmark"
+export GIT_COMMITTER_EMAIL="benchmark@s7"
+
+cleanup() {
+    if [ 0 -eq $KEEP ]; then
+        rm -rf "$SANDBOX_DIR"
+    fi
+}
+
+fail() {
+    echo >&2 "🚨 $*"
+    echo >&2 "   see $LOG for details"
+    KEEP=1
+    exit 1
+}
+
+# creates a bare repo with $COMMITS commits touching $FILES files, and $REFS extra branches and tags.
+# fast-import is way faster than committing in a loop
+createRepoWithHistory() {
+    local BARE_REPO_PATH="$1"
+
+    git init -q --bare "$BARE_REPO_PATH" || fail "failed to create $BARE_REPO_PATH"
+    git -C "$BARE_REPO_PATH" symbolic-ref HEAD refs/heads/main
+
+    awk -v files="$FILES" -v commits="$COMMITS" -v refs="$REFS" '
+        function data(s) { printf "data %d\n%s\n", length(s), s }
+        BEGIN {
+            for (c = 1; c <= commits; ++c) {
+                print "commit refs/heads/main"
+                print "mark :" c
+                print "committer s7 benchmark <benchmark@s7> " (1600000000 + c * 60) " +0000"
+                data("commit " c)
+                if (1 == c) {
+                    print "M 644 inline .gitignore"
+                    data("")
+                    for (f = 1; f <= files; ++f) {
+                        print "M 644 inline src/file" f ".txt"
+                        data("file " f)
+                    }
+                }
+                else {
+                    print "M 644 inline src/file" (c % files + 1) ".txt"
+                    data("file " (c % files + 1) " revision " c)
+                }
+                print ""
+            }
+            for (r = 1; r <= refs; ++r) {
+                print "reset " (r % 2 ? "refs/heads/branch-" : "refs/tags/tag-") r
+                print "from :" (r * 7 % commits + 1)
+                print ""
+            }
+        }' | git -C "$BARE_REPO_PATH" fast-import --quiet || fail "failed to generate history of $BARE_REPO_PATH"
+}
+
+# $1 – bare repo to make an s7 repo, $2 – url of the subrepo to add to it (optional)
+addSubrepos() {
+    local BARE_REPO_PATH="$1"
+    shift
+
+    local TMP_CLONE="$SANDBOX_DIR/tmp"
+    rm -rf "$TMP_CLONE"
+
+    (
+        git clone -q "$BARE_REPO_PATH" "$TMP_CLONE" &&
+        cd "$TMP_CLONE" &&
+        s7 init &&
+        for SUBREPO_URL in "$@"
+        do
+            s7 add --stage "Dependencies/$(basename "$SUBREPO_URL")" "$SUBREPO_URL" || exit 1
+        done &&
+        git add . &&
+        git commit -q -m "add subrepos" &&
+        git push -q
+    ) >>"$LOG" 2>&1 || fail "failed to add subrepos to $BARE_REPO_PATH"
+
+    rm -rf "$TMP_CLONE"
+}
+
+generateWorkspace() {
+    echo "generating workspace: $SUBREPOS subrepo(s), depth $DEPTH, $COMMITS commit(s), $REFS ref(s), $FILES file(s)"
+
+    mkdir -p "$GITHUB_DIR"
+
+    local TOP_LEVEL_SUBREPOS=""
+
+    for i in $(seq 1 $SUBREPOS)
+    do
+        # build chains bottom-up, so that every nested repo is ready before its parent is
+        local NESTED_URL=""
+        for LEVEL in $(seq $DEPTH -1 1)
+        do
+            local SUBREPO_URL="$GITHUB_DIR/lib$i-level$LEVEL"
+            createRepoWithHistory "$SUBREPO_URL"
+            if [ -n "$NESTED_URL" ]; then
+                addSubrepos "$SUBREPO_URL" "$NESTED_URL"
+            fi
+            NESTED_URL="$SUBREPO_URL"
+        done
+
+        TOP_LEVEL_SUBREPOS="$TOP_LEVEL_SUBREPOS $NESTED_URL"
+    done
+
+    createRepoWithHistory "$GITHUB_DIR/main"
+    addSubrepos "$GITHUB_DIR/main" $TOP_LEVEL_SUBREPOS
+
+    git clone -q "$GITHUB_DIR/main" "$WORKSPACE_DIR" >>"$LOG" 2>&1 || fail "failed to clone the main repo"
+
+    # s7 bootstrap filter isn't necessarily installed on this machine
+    if [ ! -d "$WORKSPACE_DIR/Dependencies" ]; then
+        (cd "$WORKSPACE_DIR" && s7 init) >>"$LOG" 2>&1 || fail "failed to init s7 in the workspace"
+    fi
+}
+
+# commits a change in every top-level subrepo on a branch $1 (created if necessary)
+# and rebinds the main repo
+commitInAllSubrepos() {
+    local SUBREPO_BRANCH="$1"
+    local FILE_NAME="$2"
+
+    for SUBREPO in Dependencies/*
+    do
+        (
+            cd "$SUBREPO" &&
+            git checkout -q -B "$SUBREPO_BRANCH" &&
+            echo "$FILE_NAME $(date +%s)" > "$FILE_NAME" &&
+            git add "$FILE_NAME" &&
+            git commit -q -m "$FILE_NAME"
+        ) || return 1
+    done
+
+    s7 rebind --stage && git commit -q -m "up subrepos ($FILE_NAME)"
+}
+
+#
+# timing
+#
+
+# runs shell command $1 and prints elapsed time in milliseconds.
+# perl is the most portable way to get sub-millisecond time on macOS
+timeCommand() {
+    perl -MTime::HiRes=time -e '
+        my $start = time;
+        system("sh", "-c", $ARGV[0]);
+        my $exitCode = $? >> 8;
+        printf("%.3f\n", (time - $start) * 1000);
+        exit($exitCode);
+    ' "$1 >>'$LOG' 2>&1"
+}
+
+# runs scenario $1: `setup` (untimed, evaluated in this shell) and `measure` (timed)
+# commands for every run. BENCHMARK_RUN is available to both.
+runScenario() {
+    local SCENARIO="$1"
+    local SETUP_COMMAND="$2"
+    local MEASURED_COMMAND="$3"
+
+    local SAMPLES="$SANDBOX_DIR/$SCENARIO.samples"
+    rm -f "$SAMPLES"
+
+    printf "  %-10s" "$SCENARIO"
+
+    local RUN=0
+    local TOTAL_RUNS=$((WARMUP + RUNS))
+    while [ $RUN -lt $TOTAL_RUNS ]
+    do
+        RUN=$((RUN + 1))
+        export BENCHMARK_RUN=$RUN
+
+        if [ -n "$SETUP_COMMAND" ]; then
+            eval "$SETUP_COMMAND" >>"$LOG" 2>&1 || fail "$SCENARIO: setup failed"
+        fi
+
+        local ELAPSED
+        ELAPSED=$(timeCommand "$MEASURED_COMMAND") || fail "$SCENARIO: '$MEASURED_COMMAND' failed"
+
+        if [ $RUN -gt $WARMUP ]; then
+            echo "$ELAPSED" >> "$SAMPLES"
+        fi
+
+        printf "."
+    done
+
+    SCENARIO_RESULTS="$SCENARIO_RESULTS$SCENARIO $(stats "$SAMPLES")
+"
+
+    echo " median $(medianOf "$SAMPLES") ms"
+}
+
+medianOf() {
+    stats "$1" | sed 's/.*"median_ms": \([0-9.]*\).*/\1/'
+}
+
+#
+# scenarios
+#
+
+prepareCheckoutScenario() {
+    git checkout -q -b bench-switch main &&
+    commitInAllSubrepos bench-switch checkout.txt &&
+    git checkout -q main
+}
+
+prepareMergeScenario() {
+    git checkout -q -b bench-merge-theirs main &&
+    commitInAllSubrepos bench-merge-theirs theirs.txt &&
+    git checkout -q -b bench-merge-ours main &&
+    commitInAllSubrepos bench-merge-ours ours.txt &&
+    git rev-parse HEAD > "$SANDBOX_DIR/merge-ours-revision"
+}
+
+preparePushScenario() {
+    git checkout -q -b bench-push main &&
+    git push -q -u origin bench-push
+}
+
+# commits $UNPUSHED substate commits, each updating the next subrepo
+commitForPushScenario() {
+    local SUBREPOS_ARRAY=(Dependencies/*)
+    local k=0
+    while [ $k -lt $UNPUSHED ]
+    do
+        local INDEX=$(( (BENCHMARK_RUN * UNPUSHED + k) % ${#SUBREPOS_ARRAY[@]} ))
+        local SUBREPO="${SUBREPOS_ARRAY[$INDEX]}"
+        (
+            cd "$SUBREPO" &&
+            echo "push $BENCHMARK_RUN $k" > push.txt &&
+            git add push.txt &&
+            git commit -q -m "push $BENCHMARK_RUN $k"
+        ) || return 1
+        s7 rebind --stage "$SUBREPO" && git commit -q -m "up $SUBREPO" || return 1
+        k=$((k + 1))
+    done
+}
+
+runScenarios() {
+    cd "$WORKSPACE_DIR"
+
+    echo "running scenarios ($RUNS run(s) each, $WARMUP warmup run(s)):"
+
+    for SCENARIO in $SCENARIOS
+    do
+        git checkout -q main >>"$LOG" 2>&1 || fail "failed to return to main"
+
+        case $SCENARIO in
+            checkout)
+                prepareCheckoutScenario >>"$LOG" 2>&1 || fail "checkout: preparation failed"
+                # every run is a switch to the other branch
+                runScenario checkout \
+                    "" \
+                    'if [ $((BENCHMARK_RUN % 2)) -eq 1 ]; then git checkout -q bench-switch; else git checkout -q main; fi'
+                ;;
+            status)
+                runScenario status "" "s7 status"
+                ;;
+            rebind)
+                runScenario rebind "" "s7 rebind"
+                ;;
+            merge)
+                prepareMergeScenario >>"$LOG" 2>&1 || fail "merge: preparation failed"
+                runScenario merge \
+                    "git checkout -q -B bench-merge-ours \$(cat '$SANDBOX_DIR/merge-ours-revision')" \
+                    "S7_MERGE_DRIVER_RESPONSE=m git merge -q --no-edit bench-merge-theirs"
+                ;;
+            push)
+                preparePushScenario >>"$LOG" 2>&1 || fail "push: preparation failed"
+                runScenario push \
+                    "commitForPushScenario" \
+                    "git push -q"
+                ;;
+        esac
+    done
+}
+
+writeResults() {
+    {
+        echo "{"
+        echo "  \"s7_version\": \"$(s7 version 2>/dev/null | head -n 1)\","
+        echo "  \"date\": \"$(date -u +%Y-%m-%dT%H:%M:%SZ)\","
+        echo "  \"parameters\": {\"subrepos\": $SUBREPOS, \"depth\": $DEPTH, \"commits\": $COMMITS, \"refs\": $REFS, \"files\": $FILES, \"unpushed\": $UNPUSHED, \"runs\": $RUNS, \"warmup\": $WARMUP},"
+        echo "  \"scenarios\": {"
+        printf "%s" "$SCENARIO_RESULTS" | awk '
+            NF { lines[++n] = "    \"" $1 "\": " substr($0, length($1) + 2) }
+            END { for (i = 1; i <= n; ++i) print lines[i] (i < n ? "," : "") }'
+        echo "  }"
+        echo "}"
+    } > "$OUTPUT"
+
+    echo "results saved to $OUTPUT"
+}
+
+case "$OUTPUT" in
+    /*) ;;
+    *) OUTPUT="$(pwd)/$OUTPUT" ;;
+esac
+
+which s7 > /dev/null || { echo >&2 "s7 is not installed"; exit 1; }
+
+trap cleanup EXIT
+
+rm -rf "$SANDBOX_DIR"
+mkdir -p "$SANDBOX_DIR"
+
+SCENARIO_RESULTS=""
+
+generateWorkspace
+runScenarios
+writeResults
+
+if [ -n "$BASELINE" ]; then
+    echo
+    compare "$BASELINE" "$OUTPUT"
+    exit $?
+fi
@@ -0,0 +1,94 @@
+//
+//  configJournalTests.m
+//  system7-tests
+//
+//  Copyright © 2026 Readdle. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "S7ConfigJournal.h"
+#import "Git+Statistics.h"
+
+@interface configJournalTests : XCTestCase
+@property (nonatomic, strong) TestReposEnvironment *env;
+@end
+
+@implementation configJournalTests
+
+- (void)setUp {
+    self.env = [[TestReposEnvironment alloc] initWithTestCaseName:self.className];
+}
+
+- (void)tearDown {
+    [GitRepository resetSpawnStatistics];
+}
+
+- (void)testConfigIsReadFromGitOnce {
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        s7init_deactivateHooks();
+
+        s7add(@"Dependencies/ReaddleLib", self.env.githubReaddleLibRepo.absolutePath);
+        [repo add:@[S7ConfigFileName, @".gitignore"]];
+        [repo commitWithMessage:@"add ReaddleLib"];
+
+        NSString *revision = nil;
+        [repo getCurrentRevision:&revision];
+
+        [GitRepository resetSpawnStatistics];
+
+        S7Config *config = nil;
+        XCTAssertEqual(0, getConfig(repo, revision, &config));
+        XCTAssertEqual(1, config.subrepoDescriptions.count);
+        XCTAssertEqual(1, repo.numberOfSpawnedCommands);
+
+        S7Config *journaledConfig = nil;
+        XCTAssertEqual(0, getConfig(repo, revision, &journaledConfig));
+        XCTAssertEqualObjects(config, journaledConfig);
+        XCTAssertEqual(1, repo.numberOfSpawnedCommands);
+    }];
+}
+
+- (void)testOnlyFullHashesAreJournaled {
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        s7init_deactivateHooks();
+
+        [S7ConfigJournal recordConfigContents:@"contents" atRevision:@"HEAD" inRepo:repo];
+        XCTAssertNil([S7ConfigJournal configContentsAtRevision:@"HEAD" inRepo:repo]);
+
+        NSString *revision = nil;
+        [repo getCurrentRevision:&revision];
+
+        NSString *shortRevision = [revision substringToIndex:7];
+        [S7ConfigJournal recordConfigContents:@"contents" atRevision:shortRevision inRepo:repo];
+        XCTAssertNil([S7ConfigJournal configContentsAtRevision:shortRevision inRepo:repo]);
+
+        [S7ConfigJournal recordConfigContents:@"contents" atRevision:revision inRepo:repo];
+        XCTAssertEqualObjects(@"contents", [S7ConfigJournal configContentsAtRevision:revision inRepo:repo]);
+    }];
+}
+
+- (void)testCorruptedJournalIsIgnored {
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        s7init_deactivateHooks();
+
+        [repo add:@[S7ConfigFileName]];
+        [repo commitWithMessage:@"init s7"];
+
+        NSString *revision = nil;
+        [repo getCurrentRevision:&revision];
+
+        NSString *journalPath = [S7ConfigJournal journalPathInRepo:repo];
+        XCTAssertTrue([@"{ not really json" writeToFile:journalPath atomically:YES encoding:NSUTF8StringEncoding error:nil]);
+
+        XCTAssertNil([S7ConfigJournal configContentsAtRevision:revision inRepo:repo]);
+
+        S7Config *config = nil;
+        XCTAssertEqual(0, getConfig(repo, revision, &config));
+
+        // and the journal is healed
+        XCTAssertNotNil([S7ConfigJournal configContentsAtRevision:revision inRepo:repo]);
+    }];
+}
+
+@end
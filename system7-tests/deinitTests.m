@@ -30,6 +30,7 @@ void assertRepoAtPWDIsFreeFromS7(void) {
     XCTAssertFalse([fileManager fileExistsAtPath:S7BootstrapFileName]);
     XCTAssertFalse([fileManager fileExistsAtPath:S7ControlFileName]);
     XCTAssertFalse([fileManager fileExistsAtPath:S7ConfigFileName]);
+    XCTAssertFalse([fileManager fileExistsAtPath:@".git/s7-trash"]);
 
     if ([fileManager fileExistsAtPath:@".gitignore"]) {
         NSString *gitignoreContents = [NSString stringWithContentsOfFile:@".gitignore" encoding:NSUTF8StringEncoding error:nil];
@@ -139,6 +140,25 @@ BOOL areStringEqualIgnoringEmptyLines(NSString *yellow, NSString *blue) {
     }];
 }
 
+- (void)testRemovesTrashOfRemovedSubrepos {
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        S7InitCommand *initCommand = [S7InitCommand new];
+        XCTAssertEqual(0, [initCommand runWithArguments:@[]]);
+
+        // as if checkout has moved a removed subrepo away, but didn't have time to delete it
+        NSString *trashedSubrepoPath = @".git/s7-trash/0D2A7C4E-ReaddleLib";
+        XCTAssertTrue([NSFileManager.defaultManager createDirectoryAtPath:trashedSubrepoPath
+                                              withIntermediateDirectories:YES
+                                                               attributes:nil
+                                                                    error:nil]);
+
+        S7DeinitCommand *deinitCommand = [S7DeinitCommand new];
+        XCTAssertEqual(S7ExitCodeSuccess, [deinitCommand runWithArguments:@[]]);
+
+        assertRepoAtPWDIsFreeFromS7();
+    }];
+}
+
 - (void)testOnS7PlusGitLFSRepo {
     [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
         NSString *prePushHookFilePath = @".git/hooks/pre-push";
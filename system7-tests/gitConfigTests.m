@@ -0,0 +1,252 @@
+//
+//  gitConfigTests.m
+//  system7-tests
+//
+//  Copyright © 2026 Readdle. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "GitConfig.h"
+#import "Git+Statistics.h"
+
+@interface gitConfigTests : XCTestCase
+@property (nonatomic, strong) TestReposEnvironment *env;
+@end
+
+@implementation gitConfigTests
+
+- (void)setUp {
+    self.env = [[TestReposEnvironment alloc] initWithTestCaseName:self.className];
+}
+
+- (void)tearDown {
+    [GitConfig invalidateCache];
+}
+
+- (NSString *)writeConfig:(NSString *)contents toFile:(NSString *)fileName {
+    NSString *filePath = [self.env.root stringByAppendingPathComponent:fileName];
+    [NSFileManager.defaultManager createDirectoryAtPath:[filePath stringByDeletingLastPathComponent]
+                            withIntermediateDirectories:YES
+                                             attributes:nil
+                                                  error:nil];
+    XCTAssertTrue([contents writeToFile:filePath atomically:YES encoding:NSUTF8StringEncoding error:nil]);
+    return filePath;
+}
+
+#pragma mark - parsing -
+
+- (void)testSectionsSubsectionsAndKeys {
+    NSString *configPath = [self writeConfig:
+                            @"[core]\n"
+                             "\tbare = false\n"
+                             "\tIgnoreCase = true\n"
+                             "[remote \"origin\"]\n"
+                             "\turl = git@github.com:readdle/rd2.git\n"
+                             "\tfetch = +refs/heads/*:refs/remotes/origin/*\n"
+                             "[branch \"Feature/PDF-1\"]\n"
+                             "\tremote = origin\n"
+                             "\tmerge = refs/heads/Feature/PDF-1\n"
+                             "[Branch.Main]\n"
+                             "\tremote = origin\n"
+                                      toFile:@"config"];
+
+    GitConfig *config = [GitConfig configWithContentsOfFile:configPath gitDirectory:nil];
+    XCTAssertFalse(config.requiresGit);
+
+    XCTAssertFalse([config boolForKey:@"core.bare" defaultValue:YES]);
+    XCTAssertTrue([config boolForKey:@"core.ignorecase" defaultValue:NO]);
+    XCTAssertTrue([config boolForKey:@"CORE.IGNORECASE" defaultValue:NO]);
+    XCTAssertTrue([config boolForKey:@"core.symlinks" defaultValue:YES]);
+
+    XCTAssertEqualObjects(@"git@github.com:readdle/rd2.git", [config stringForKey:@"remote.origin.url"]);
+
+    // subsection is case sensitive
+    XCTAssertEqualObjects(@"refs/heads/Feature/PDF-1", [config stringForKey:@"branch.Feature/PDF-1.merge"]);
+    XCTAssertNil([config stringForKey:@"branch.feature/pdf-1.merge"]);
+
+    // except for the deprecated syntax
+    XCTAssertEqualObjects(@"origin", [config stringForKey:@"branch.main.remote"]);
+
+    XCTAssertEqualObjects((@[ @"Feature/PDF-1", @"main" ]), [config subsectionsOfSection:@"branch"]);
+    XCTAssertEqualObjects(@[ @"origin" ], [config subsectionsOfSection:@"remote"]);
+}
+
+- (void)testMultiValuedKeys {
+    NSString *configPath = [self writeConfig:
+                            @"[remote \"origin\"]\n"
+                             "\tfetch = +refs/heads/*:refs/remotes/origin/*\n"
+                             "\tfetch = +refs/tags/*:refs/tags/*\n"
+                             "[remote \"origin\"]\n"
+                             "\tfetch = +refs/s7/*:refs/s7/*\n"
+                                      toFile:@"config"];
+
+    GitConfig *config = [GitConfig configWithContentsOfFile:configPath gitDirectory:nil];
+    XCTAssertFalse(config.requiresGit);
+
+    NSArray<NSString *> *expectedValues = @[
+        @"+refs/heads/*:refs/remotes/origin/*",
+        @"+refs/tags/*:refs/tags/*",
+        @"+refs/s7/*:refs/s7/*",
+    ];
+    XCTAssertEqualObjects(expectedValues, [config stringsForKey:@"remote.origin.fetch"]);
+    XCTAssertEqualObjects(expectedValues.lastObject, [config stringForKey:@"remote.origin.fetch"]);
+    XCTAssertEqualObjects(@[], [config stringsForKey:@"remote.origin.url"]);
+}
+
+- (void)testQuotedValues {
+    NSString *configPath = [self writeConfig:
+                            @"[alias]\n"
+                             "\tgreet = \"!echo \\\"hello; world\\\"\"\n"
+                             "\tpath = C:\\\\Program Files\n"
+                                      toFile:@"config"];
+
+    GitConfig *config = [GitConfig configWithContentsOfFile:configPath gitDirectory:nil];
+    XCTAssertFalse(config.requiresGit);
+    XCTAssertEqualObjects(@"!echo \"hello; world\"", [config stringForKey:@"alias.greet"]);
+    XCTAssertEqualObjects(@"C:\\Program Files", [config stringForKey:@"alias.path"]);
+}
+
+- (void)testEmptyValueIsEmptyString {
+    // unlike a bare `name`, `name =` is an empty string for Git – and thus boolean false
+    NSString *configPath = [self writeConfig:
+                            @"[core]\n"
+                             "\tbare =\n"
+                             "\thooksPath = \n"
+                                      toFile:@"config"];
+
+    GitConfig *config = [GitConfig configWithContentsOfFile:configPath gitDirectory:nil];
+    XCTAssertFalse(config.requiresGit);
+    XCTAssertEqualObjects(@"", [config stringForKey:@"core.bare"]);
+    XCTAssertFalse([config boolForKey:@"core.bare" defaultValue:YES]);
+    XCTAssertEqualObjects(@"", [config stringForKey:@"core.hookspath"]);
+}
+
+- (void)testIncludes {
+    [self writeConfig:@"[user]\n\tname = Included\n" toFile:@"included/identity"];
+
+    NSString *configPath = [self writeConfig:
+                            @"[user]\n"
+                             "\tname = Original\n"
+                             "[include]\n"
+                             "\tpath = included/identity\n"
+                                      toFile:@"config"];
+
+    GitConfig *config = [GitConfig configWithContentsOfFile:configPath gitDirectory:nil];
+    XCTAssertFalse(config.requiresGit);
+    XCTAssertEqualObjects(@"Included", [config stringForKey:@"user.name"]);
+    XCTAssertEqualObjects((@[ @"Original", @"Included" ]), [config stringsForKey:@"user.name"]);
+}
+
+- (void)testConditionalIncludes {
+    [self writeConfig:@"[user]\n\temail = work@readdle.com\n" toFile:@"included/work"];
+    [self writeConfig:@"[user]\n\temail = home@example.com\n" toFile:@"included/home"];
+
+    NSString *configPath = [self writeConfig:
+                            [NSString stringWithFormat:
+                             @"[includeIf \"gitdir:%@/work/\"]\n"
+                              "\tpath = included/work\n"
+                              "[includeIf \"gitdir:home/\"]\n"
+                              "\tpath = included/home\n",
+                             self.env.root]
+                                      toFile:@"config"];
+
+    NSString *workGitDir = [self.env.root stringByAppendingPathComponent:@"work/rd2/.git"];
+    GitConfig *config = [GitConfig configWithContentsOfFile:configPath gitDirectory:workGitDir];
+    XCTAssertFalse(config.requiresGit);
+    XCTAssertEqualObjects(@"work@readdle.com", [config stringForKey:@"user.email"]);
+
+    NSString *homeGitDir = [self.env.root stringByAppendingPathComponent:@"somewhere/home/rd2/.git"];
+    config = [GitConfig configWithContentsOfFile:configPath gitDirectory:homeGitDir];
+    XCTAssertFalse(config.requiresGit);
+    XCTAssertEqualObjects(@"home@example.com", [config stringForKey:@"user.email"]);
+
+    NSString *otherGitDir = [self.env.root stringByAppendingPathComponent:@"other/rd2/.git"];
+    config = [GitConfig configWithContentsOfFile:configPath gitDirectory:otherGitDir];
+    XCTAssertFalse(config.requiresGit);
+    XCTAssertNil([config stringForKey:@"user.email"]);
+}
+
+- (void)testExoticConfigRequiresGit {
+    NSString *configPath = [self writeConfig:
+                            @"[includeIf \"onbranch:main\"]\n"
+                             "\tpath = included/main\n"
+                                      toFile:@"onbranch"];
+    XCTAssertTrue([GitConfig configWithContentsOfFile:configPath gitDirectory:nil].requiresGit);
+
+    configPath = [self writeConfig:
+                  @"[alias]\n"
+                   "\tlong = log \\\n"
+                   "\t  --oneline\n"
+                            toFile:@"continuation"];
+    XCTAssertTrue([GitConfig configWithContentsOfFile:configPath gitDirectory:nil].requiresGit);
+
+    configPath = [self writeConfig:
+                  @"[core]\n"
+                   "\tbare\n"
+                            toFile:@"implicit-bool"];
+    XCTAssertTrue([GitConfig configWithContentsOfFile:configPath gitDirectory:nil].requiresGit);
+}
+
+#pragma mark - repository -
+
+- (void)testRepositoryQueriesDontSpawnGit {
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        [GitRepository resetSpawnStatistics];
+
+        NSString *url = nil;
+        XCTAssertEqual(0, [repo getUrl:&url]);
+        XCTAssertEqualObjects(self.env.githubRd2Repo.absolutePath, url);
+
+        NSString *remote = nil;
+        XCTAssertEqual(0, [repo getRemote:&remote]);
+        XCTAssertEqualObjects(@"origin", remote);
+
+        XCTAssertTrue([repo isBranchTrackingRemoteBranch:@"main"]);
+        XCTAssertFalse([repo isBranchTrackingRemoteBranch:@"no-such-branch"]);
+
+        XCTAssertFalse([repo isBareRepo]);
+        XCTAssertTrue([self.env.githubRd2Repo isBareRepo]);
+
+        XCTAssertEqual(0, [GitRepository numberOfSpawnedCommands]);
+    }];
+}
+
+- (void)testCachedConfigIsReReadOnChange {
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        XCTAssertFalse([repo isBranchTrackingRemoteBranch:@"feature"]);
+
+        XCTAssertEqual(0, [repo runGitCommand:@"config branch.feature.merge refs/heads/feature"]);
+        XCTAssertTrue([repo isBranchTrackingRemoteBranch:@"feature"]);
+
+        XCTAssertEqual(0, [repo runGitCommand:@"config remote.origin.url https://github.com/readdle/rd2"]);
+
+        NSString *url = nil;
+        XCTAssertEqual(0, [repo getUrl:&url]);
+        XCTAssertEqualObjects(@"https://github.com/readdle/rd2", url);
+    }];
+}
+
+- (void)testRepositoryQueriesInWorktree {
+    NSString *worktreePath = [self.env.root stringByAppendingPathComponent:@"pastey/rd2-worktree"];
+    XCTAssertEqual(0, [self.env.pasteyRd2Repo runGitWithArguments:@[ @"worktree", @"add", @"-b", @"worktree", worktreePath ]
+                                                     stdOutOutput:NULL
+                                                     stdErrOutput:NULL]);
+
+    // `.git` in a worktree is a gitfile – config must come from the main repo's git dir
+    GitRepository *worktreeRepo = [GitRepository repoAtPath:worktreePath];
+    XCTAssertNotNil(worktreeRepo);
+
+    NSString *url = nil;
+    XCTAssertEqual(0, [worktreeRepo getUrl:&url]);
+    XCTAssertEqualObjects(self.env.githubRd2Repo.absolutePath, url);
+
+    NSString *remote = nil;
+    XCTAssertEqual(0, [worktreeRepo getRemote:&remote]);
+    XCTAssertEqualObjects(@"origin", remote);
+
+    XCTAssertTrue([worktreeRepo isBranchTrackingRemoteBranch:@"main"]);
+    XCTAssertFalse([worktreeRepo isShallowRepo]);
+}
+
+@end
@@ -0,0 +1,209 @@
+//
+//  gitSSHMultiplexingTests.m
+//  system7-tests
+//
+//  Copyright © 2026 Readdle. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "Git.h"
+#import "Git+Tests.h"
+
+@interface gitSSHMultiplexingTests : XCTestCase
+@property (nonatomic, strong, nullable) NSTask *sshdTask;
+@end
+
+@implementation gitSSHMultiplexingTests
+
+- (void)tearDown {
+    [GitRepository stopSSHMultiplexing];
+
+    [self.sshdTask terminate];
+    [self.sshdTask waitUntilExit];
+}
+
+#pragma mark - utils -
+
+- (NSString *)controlDirectoryPathOfCommand:(NSString *)command {
+    NSRange const controlPathRange = [command rangeOfString:@"ControlPath="];
+    XCTAssertNotEqual(NSNotFound, controlPathRange.location);
+
+    NSString *const controlPath = [[command substringFromIndex:NSMaxRange(controlPathRange)] componentsSeparatedByString:@" "].firstObject;
+    return controlPath.stringByDeletingLastPathComponent;
+}
+
+- (int)runTool:(NSString *)launchPath arguments:(NSArray<NSString *> *)arguments {
+    NSTask *task = [NSTask new];
+    task.launchPath = launchPath;
+    task.arguments = arguments;
+    task.standardInput = NSFileHandle.fileHandleWithNullDevice;
+    task.standardOutput = NSFileHandle.fileHandleWithNullDevice;
+    task.standardError = NSFileHandle.fileHandleWithNullDevice;
+
+    if (NO == [task launchAndReturnError:nil]) {
+        return -1;
+    }
+
+    [task waitUntilExit];
+    return task.terminationStatus;
+}
+
+- (NSUInteger)numberOfOccurrencesOf:(NSString *)string inFileAtPath:(NSString *)filePath {
+    NSString *contents = [NSString stringWithContentsOfFile:filePath encoding:NSUTF8StringEncoding error:nil];
+    if (nil == contents) {
+        return 0;
+    }
+
+    return [contents componentsSeparatedByString:string].count - 1;
+}
+
+// sshd on localhost that lets the current user in with a throwaway key.
+// Returns port, or 0 if sshd isn't available
+- (in_port_t)startSSHDInDirectory:(NSString *)directoryPath
+                  identityFilePath:(NSString *)identityFilePath
+                       logFilePath:(NSString *)logFilePath
+{
+    // sshd re-execs itself and wants an absolute path
+    NSString *const sshdPath = @"/usr/sbin/sshd";
+    if (NO == [NSFileManager.defaultManager isExecutableFileAtPath:sshdPath]) {
+        return 0;
+    }
+
+    NSString *const hostKeyPath = [directoryPath stringByAppendingPathComponent:@"host_key"];
+    if (0 != [self runTool:@"/usr/bin/ssh-keygen" arguments:@[ @"-q", @"-t", @"ed25519", @"-N", @"", @"-f", hostKeyPath ]] ||
+        0 != [self runTool:@"/usr/bin/ssh-keygen" arguments:@[ @"-q", @"-t", @"ed25519", @"-N", @"", @"-f", identityFilePath ]])
+    {
+        return 0;
+    }
+
+    NSString *const authorizedKeysPath = [identityFilePath stringByAppendingPathExtension:@"pub"];
+
+    const in_port_t port = 20000 + arc4random_uniform(20000);
+
+    NSTask *task = [NSTask new];
+    task.launchPath = sshdPath;
+    task.arguments = @[ @"-D",
+                        @"-f", @"/dev/null",
+                        @"-h", hostKeyPath,
+                        @"-p", [NSString stringWithFormat:@"%u", port],
+                        @"-E", logFilePath,
+                        @"-o", @"ListenAddress=127.0.0.1",
+                        @"-o", [@"AuthorizedKeysFile=" stringByAppendingString:authorizedKeysPath],
+                        @"-o", @"StrictModes=no",
+                        @"-o", @"PidFile=none",
+                        @"-o", @"LogLevel=VERBOSE" ];
+    task.standardInput = NSFileHandle.fileHandleWithNullDevice;
+    task.standardOutput = NSFileHandle.fileHandleWithNullDevice;
+    task.standardError = NSFileHandle.fileHandleWithNullDevice;
+
+    if (NO == [task launchAndReturnError:nil]) {
+        return 0;
+    }
+
+    self.sshdTask = task;
+
+    for (int i = 0; i < 50 && task.isRunning; ++i) {
+        if ([self numberOfOccurrencesOf:@"Server listening on" inFileAtPath:logFilePath] > 0) {
+            return port;
+        }
+
+        usleep(100 * 1000);
+    }
+
+    return 0;
+}
+
+#pragma mark - GIT_SSH_COMMAND builder -
+
+- (void)testBuildsControlMasterCommand {
+    NSString *const command = [GitRepository sshMultiplexingCommandWithControlDirectory:@"/tmp/s7-ssh-abc123"
+                                                                     processEnvironment:@{}];
+    XCTAssertEqualObjects(@"ssh -o ControlMaster=auto -o ControlPath=/tmp/s7-ssh-abc123/%C -o ControlPersist=60", command);
+}
+
+- (void)testLeavesUserSSHCommandAlone {
+    XCTAssertNil([GitRepository sshMultiplexingCommandWithControlDirectory:@"/tmp/s7-ssh-abc123"
+                                                        processEnvironment:@{ @"GIT_SSH_COMMAND": @"ssh -i ~/.ssh/ci_key" }]);
+    XCTAssertNil([GitRepository sshMultiplexingCommandWithControlDirectory:@"/tmp/s7-ssh-abc123"
+                                                        processEnvironment:@{ @"GIT_SSH": @"/usr/local/bin/plink" }]);
+}
+
+- (void)testIgnoresEmptyUserSSHCommand {
+    XCTAssertNotNil([GitRepository sshMultiplexingCommandWithControlDirectory:@"/tmp/s7-ssh-abc123"
+                                                           processEnvironment:@{ @"GIT_SSH_COMMAND": @"" }]);
+}
+
+#pragma mark - start/stop -
+
+- (void)testStartInjectsCommandAndStopCleansUp {
+    XCTSkipIf(NSProcessInfo.processInfo.environment[@"GIT_SSH_COMMAND"] || NSProcessInfo.processInfo.environment[@"GIT_SSH"],
+              @"user ssh command is set in the environment");
+
+    [GitRepository startSSHMultiplexing];
+
+    NSString *const command = [GitRepository environmentOverrideValueForKey:@"GIT_SSH_COMMAND"];
+    XCTSkipIf(nil == command, @"core.sshCommand is configured on this machine");
+
+    NSString *const controlDirectoryPath = [self controlDirectoryPathOfCommand:command];
+
+    BOOL isDirectory = NO;
+    XCTAssertTrue([NSFileManager.defaultManager fileExistsAtPath:controlDirectoryPath isDirectory:&isDirectory]);
+    XCTAssertTrue(isDirectory);
+
+    [GitRepository stopSSHMultiplexing];
+
+    XCTAssertNil([GitRepository environmentOverrideValueForKey:@"GIT_SSH_COMMAND"]);
+    XCTAssertFalse([NSFileManager.defaultManager fileExistsAtPath:controlDirectoryPath]);
+}
+
+- (void)testFetchesShareOneMasterConnection {
+    XCTSkipIf(NSProcessInfo.processInfo.environment[@"GIT_SSH_COMMAND"] || NSProcessInfo.processInfo.environment[@"GIT_SSH"],
+              @"user ssh command is set in the environment");
+
+    TestReposEnvironment *env = [[TestReposEnvironment alloc] initWithTestCaseName:self.className];
+
+    NSString *const sshdDirectoryPath = [env.root stringByAppendingPathComponent:@"sshd"];
+    XCTAssertTrue([NSFileManager.defaultManager createDirectoryAtPath:sshdDirectoryPath withIntermediateDirectories:YES attributes:nil error:nil]);
+
+    NSString *const identityFilePath = [sshdDirectoryPath stringByAppendingPathComponent:@"id_ed25519"];
+    NSString *const logFilePath = [sshdDirectoryPath stringByAppendingPathComponent:@"sshd.log"];
+
+    const in_port_t port = [self startSSHDInDirectory:sshdDirectoryPath identityFilePath:identityFilePath logFilePath:logFilePath];
+    XCTSkipIf(0 == port, @"local sshd is not available");
+
+    [GitRepository startSSHMultiplexing];
+
+    NSString *const command = [GitRepository environmentOverrideValueForKey:@"GIT_SSH_COMMAND"];
+    XCTSkipIf(nil == command, @"core.sshCommand is configured on this machine");
+
+    NSString *const controlDirectoryPath = [self controlDirectoryPathOfCommand:command];
+
+    // keep s7's multiplexing options, just point ssh at our sshd without prompts
+    [GitRepository setEnvironmentOverrideValue:[command stringByAppendingFormat:@" -i %@ -o IdentitiesOnly=yes -o BatchMode=yes"
+                                                                                 " -o StrictHostKeyChecking=no -o UserKnownHostsFile=/dev/null",
+                                                                                 identityFilePath]
+                                        forKey:@"GIT_SSH_COMMAND"];
+
+    NSString *const url = [NSString stringWithFormat:@"ssh://%@@127.0.0.1:%u%@", NSUserName(), port, env.githubRd2Repo.absolutePath];
+
+    [env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        XCTAssertEqual(0, [repo runGitWithArguments:@[ @"fetch", url ] stdOutOutput:NULL stdErrOutput:NULL]);
+
+        NSArray<NSString *> *const socketsAfterFirstFetch = [NSFileManager.defaultManager contentsOfDirectoryAtPath:controlDirectoryPath error:nil];
+        XCTAssertEqual(1, socketsAfterFirstFetch.count);
+
+        XCTAssertEqual(0, [repo runGitWithArguments:@[ @"fetch", url ] stdOutOutput:NULL stdErrOutput:NULL]);
+
+        XCTAssertEqualObjects(socketsAfterFirstFetch, [NSFileManager.defaultManager contentsOfDirectoryAtPath:controlDirectoryPath error:nil]);
+    }];
+
+    // the second fetch went through the master – sshd authenticated us just once
+    XCTAssertEqual(1, [self numberOfOccurrencesOf:@"Accepted publickey" inFileAtPath:logFilePath]);
+
+    [GitRepository stopSSHMultiplexing];
+
+    XCTAssertFalse([NSFileManager.defaultManager fileExistsAtPath:controlDirectoryPath]);
+}
+
+@end
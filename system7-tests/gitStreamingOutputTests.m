@@ -0,0 +1,150 @@
+//
+//  gitStreamingOutputTests.m
+//  system7-tests
+//
+//  Copyright © 2026 Readdle. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "TestReposEnvironment.h"
+
+@interface gitStreamingOutputTests : XCTestCase
+
+@property (nonatomic, strong) TestReposEnvironment *env;
+
+@end
+
+@implementation gitStreamingOutputTests
+
+- (void)setUp {
+    self.env = [[TestReposEnvironment alloc] initWithTestCaseName:self.className];
+}
+
+#pragma mark - streaming -
+
+- (void)testLinesAreStreamedInOrder {
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        commit(repo, @"file", @"one", @"first");
+        commit(repo, @"file", @"two", @"second");
+        commit(repo, @"file", @"three", @"third");
+
+        NSMutableArray<NSString *> *lines = [NSMutableArray new];
+        // `--pretty=format:` doesn't terminate the last line – it must not get lost
+        const int exitStatus =
+        [repo
+         runGitWithArguments:@[ @"log", @"-3", @"--pretty=format:%s" ]
+         stdOutLineHandler:^(NSString * _Nonnull line, BOOL * _Nonnull stop) {
+            [lines addObject:line];
+        }];
+
+        XCTAssertEqual(0, exitStatus);
+        XCTAssertEqualObjects((@[ @"third", @"second", @"first" ]), lines);
+    }];
+}
+
+- (void)testStopTerminatesGit {
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        // an alias that would never stop writing on its own
+        __block NSUInteger numberOfLines = 0;
+        const int exitStatus =
+        [repo
+         runGitWithArguments:@[ @"-c", @"alias.forever=!yes", @"forever" ]
+         stdOutLineHandler:^(NSString * _Nonnull line, BOOL * _Nonnull stop) {
+            ++numberOfLines;
+            if (numberOfLines >= 10) {
+                *stop = YES;
+            }
+        }];
+
+        XCTAssertEqual(0, exitStatus);
+        XCTAssertEqual(10, numberOfLines);
+    }];
+}
+
+- (void)testExitStatusIsReportedIfNotStopped {
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        __block NSUInteger numberOfLines = 0;
+        const int exitStatus =
+        [repo
+         runGitWithArguments:@[ @"rev-list", @"no-such-revision" ]
+         stdOutLineHandler:^(NSString * _Nonnull line, BOOL * _Nonnull stop) {
+            ++numberOfLines;
+        }];
+
+        XCTAssertNotEqual(0, exitStatus);
+        XCTAssertEqual(0, numberOfLines);
+    }];
+}
+
+- (void)testStdErrIsCollectedIfOutputIsRedirectedToMemory {
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        repo.redirectOutputToMemory = YES;
+
+        const int exitStatus =
+        [repo
+         runGitWithArguments:@[ @"rev-list", @"no-such-revision" ]
+         stdOutLineHandler:^(NSString * _Nonnull line, BOOL * _Nonnull stop) {
+        }];
+
+        XCTAssertNotEqual(0, exitStatus);
+        XCTAssertNil(repo.lastCommandStdOutOutput);
+        XCTAssertTrue([repo.lastCommandStdErrOutput containsString:@"no-such-revision"]);
+
+        repo.redirectOutputToMemory = NO;
+    }];
+}
+
+#pragma mark - queries -
+
+- (void)testHasUnpushedCommits {
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        XCTAssertFalse([repo hasUnpushedCommits]);
+
+        for (int i = 0; i < 5; ++i) {
+            commit(repo, @"file", [NSString stringWithFormat:@"%d", i], @"local change");
+        }
+
+        XCTAssertTrue([repo hasUnpushedCommits]);
+
+        XCTAssertEqual(0, [repo pushCurrentBranch]);
+        XCTAssertFalse([repo hasUnpushedCommits]);
+    }];
+}
+
+- (void)testIsRevisionDetached {
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        NSString *pushedRevision = nil;
+        [repo getCurrentRevision:&pushedRevision];
+
+        int numberOfOrphanedCommits = -1;
+        XCTAssertFalse([repo isRevisionDetached:pushedRevision numberOfOrphanedCommits:&numberOfOrphanedCommits]);
+        XCTAssertEqual(0, numberOfOrphanedCommits);
+
+        commit(repo, @"file", @"one", @"first");
+        commit(repo, @"file", @"two", @"second");
+        NSString *detachedRevision = commit(repo, @"file", @"three", @"third");
+
+        XCTAssertEqual(0, [repo resetHardToRevision:pushedRevision]);
+
+        XCTAssertTrue([repo isRevisionDetached:detachedRevision numberOfOrphanedCommits:&numberOfOrphanedCommits]);
+        XCTAssertEqual(3, numberOfOrphanedCommits);
+
+        XCTAssertTrue([repo isRevisionDetached:detachedRevision numberOfOrphanedCommits:NULL]);
+        XCTAssertFalse([repo isRevisionDetached:pushedRevision numberOfOrphanedCommits:NULL]);
+    }];
+}
+
+- (void)testLogNotPushedCommits {
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        NSString *first = commit(repo, @"file", @"one", @"first");
+        NSString *second = commit(repo, @"file", @"two", @"second");
+
+        int exitStatus = -1;
+        NSArray<NSString *> *revisions = [repo logNotPushedCommitsFromRef:@"HEAD" file:nil exitStatus:&exitStatus];
+        XCTAssertEqual(0, exitStatus);
+        XCTAssertEqualObjects((@[ first, second ]), revisions);
+    }];
+}
+
+@end
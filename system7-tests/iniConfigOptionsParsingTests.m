@@ -10,6 +10,8 @@
 #import "S7IniConfig.h"
 #import "S7IniConfigOptions.h"
 #import "GitFilter.h"
+#import "GitURLMirror.h"
+#import "S7Options.h"
 
 @interface optionsParsingTests : XCTestCase
 
@@ -264,4 +266,220 @@
     XCTAssertEqual(options.filter, GitFilterUnspecified);
 }
 
+- (void)testCorrectFilterTreeNoneParsing {
+    S7IniConfig *config = [S7IniConfig configWithContentsOfString:
+                           @"[git]\n"
+                           "filter = tree:0"];
+    S7IniConfigOptions *options = [[S7IniConfigOptions alloc] initWithIniConfig:config];
+
+    XCTAssertEqual(options.filter, GitFilterTreeNone);
+}
+
+- (void)testCorrectDepthParsing {
+    S7IniConfig *config = [S7IniConfig configWithContentsOfString:
+                           @"[git]\n"
+                           "depth = 1"];
+    S7IniConfigOptions *options = [[S7IniConfigOptions alloc] initWithIniConfig:config];
+
+    XCTAssertEqualObjects(options.depth, @1);
+    XCTAssertNil(options.shallowSince);
+}
+
+- (void)testInvalidDepthParsing {
+    S7IniConfig *config = [S7IniConfig configWithContentsOfString:
+                           @"[git]\n"
+                           "depth = -1"];
+    S7IniConfigOptions *options = [[S7IniConfigOptions alloc] initWithIniConfig:config];
+    XCTAssertNil(options.depth);
+
+    config = [S7IniConfig configWithContentsOfString:
+              @"[git]\n"
+              "depth = 1O"];
+    options = [[S7IniConfigOptions alloc] initWithIniConfig:config];
+    XCTAssertNil(options.depth);
+}
+
+- (void)testCorrectShallowSinceParsing {
+    S7IniConfig *config = [S7IniConfig configWithContentsOfString:
+                           @"[git]\n"
+                           "shallow-since = 2023-01-01"];
+    S7IniConfigOptions *options = [[S7IniConfigOptions alloc] initWithIniConfig:config];
+
+    XCTAssertEqualObjects(options.shallowSince, @"2023-01-01");
+    XCTAssertNil(options.depth);
+}
+
+- (void)testCorrectSparseCheckoutParsing {
+    S7IniConfig *config = [S7IniConfig configWithContentsOfString:
+                           @"[git]\n"
+                           "sparse-checkout = include,  lib/x86 ,"];
+    S7IniConfigOptions *options = [[S7IniConfigOptions alloc] initWithIniConfig:config];
+
+    XCTAssertEqualObjects(options.sparseCheckoutDirectories, (@[ @"include", @"lib/x86" ]));
+}
+
+- (void)testSubrepoSectionParsing {
+    S7IniConfig *config = [S7IniConfig configWithContentsOfString:
+                           @"[git]\n"
+                           "filter = blob:none\n"
+                           "[subrepo \"Dependencies/openssl\"]\n"
+                           "filter = tree:0\n"
+                           "depth = 1\n"
+                           "sparse-checkout = include"];
+    S7IniConfigOptions *options = [[S7IniConfigOptions alloc] initWithIniConfig:config];
+
+    XCTAssertEqual(options.filter, GitFilterBlobNone);
+    XCTAssertNil(options.depth);
+    XCTAssertNil(options.sparseCheckoutDirectories);
+
+    S7IniConfigOptions *subrepoOptions = [options optionsForSubrepoAtPath:@"Dependencies/openssl"];
+    XCTAssertNotNil(subrepoOptions);
+    XCTAssertEqual(subrepoOptions.filter, GitFilterTreeNone);
+    XCTAssertEqualObjects(subrepoOptions.depth, @1);
+    XCTAssertEqualObjects(subrepoOptions.sparseCheckoutDirectories, (@[ @"include" ]));
+
+    XCTAssertNil([options optionsForSubrepoAtPath:@"Dependencies/zlib"]);
+}
+
+- (void)testCorrectJobsParsing {
+    S7IniConfig *config = [S7IniConfig configWithContentsOfString:
+                           @"[git]\n"
+                           "jobs = 4"];
+    S7IniConfigOptions *options = [[S7IniConfigOptions alloc] initWithIniConfig:config];
+
+    XCTAssertEqualObjects(options.jobs, @4);
+}
+
+- (void)testInvalidJobsParsing {
+    S7IniConfig *config = [S7IniConfig configWithContentsOfString:
+                           @"[git]\n"
+                           "jobs = 0"];
+    S7IniConfigOptions *options = [[S7IniConfigOptions alloc] initWithIniConfig:config];
+    XCTAssertNil(options.jobs);
+
+    config = [S7IniConfig configWithContentsOfString:
+              @"[git]\n"
+              "jobs = many"];
+    options = [[S7IniConfigOptions alloc] initWithIniConfig:config];
+    XCTAssertNil(options.jobs);
+}
+
+- (void)testLFSModeParsing {
+    S7IniConfig *config = [S7IniConfig configWithContentsOfString:
+                           @"[git]\n"
+                           "lfs = Deferred"];
+    S7IniConfigOptions *options = [[S7IniConfigOptions alloc] initWithIniConfig:config];
+    XCTAssertEqualObjects(options.lfsDeferred, @YES);
+
+    config = [S7IniConfig configWithContentsOfString:
+              @"[git]\n"
+              "lfs = inline"];
+    options = [[S7IniConfigOptions alloc] initWithIniConfig:config];
+    XCTAssertEqualObjects(options.lfsDeferred, @NO);
+
+    config = [S7IniConfig configWithContentsOfString:
+              @"[git]\n"
+              "lfs = later"];
+    options = [[S7IniConfigOptions alloc] initWithIniConfig:config];
+    XCTAssertNil(options.lfsDeferred);
+
+    config = [S7IniConfig configWithContentsOfString:@"[git]\n"];
+    options = [[S7IniConfigOptions alloc] initWithIniConfig:config];
+    XCTAssertNil(options.lfsDeferred);
+}
+
+- (void)testSSHMultiplexingParsing {
+    S7IniConfig *config = [S7IniConfig configWithContentsOfString:
+                           @"[git]\n"
+                           "ssh-multiplexing = True"];
+    S7IniConfigOptions *options = [[S7IniConfigOptions alloc] initWithIniConfig:config];
+    XCTAssertEqualObjects(options.sshMultiplexing, @YES);
+
+    config = [S7IniConfig configWithContentsOfString:
+              @"[git]\n"
+              "ssh-multiplexing = no"];
+    options = [[S7IniConfigOptions alloc] initWithIniConfig:config];
+    XCTAssertEqualObjects(options.sshMultiplexing, @NO);
+
+    config = [S7IniConfig configWithContentsOfString:
+              @"[git]\n"
+              "ssh-multiplexing = sometimes"];
+    options = [[S7IniConfigOptions alloc] initWithIniConfig:config];
+    XCTAssertNil(options.sshMultiplexing);
+
+    config = [S7IniConfig configWithContentsOfString:@"[git]\n"];
+    options = [[S7IniConfigOptions alloc] initWithIniConfig:config];
+    XCTAssertNil(options.sshMultiplexing);
+}
+
+- (void)testMirrorRulesParsing {
+    S7IniConfig *config = [S7IniConfig configWithContentsOfString:
+                           @"[mirror \"git@github.com:readdle/\"]\n"
+                           "url = https://git-cache.local/readdle/\n"
+                           "[mirror \"https://github.com/\"]\n"
+                           "url = https://git-cache.local/github/\n"
+                           "scope = Fetch-And-Push\n"
+                           "[mirror \"https://gitlab.com/\"]\n"
+                           "url = https://git-cache.local/gitlab/\n"
+                           "scope = push-only\n"
+                           "[mirror \"https://bitbucket.org/\"]\n"
+                           "scope = fetch\n"];
+    S7IniConfigOptions *options = [[S7IniConfigOptions alloc] initWithIniConfig:config];
+
+    NSArray<GitURLMirror *> *expectedMirrors = @[
+        [GitURLMirror mirrorWithPrefix:@"git@github.com:readdle/" mirrorPrefix:@"https://git-cache.local/readdle/" includesPush:NO],
+        [GitURLMirror mirrorWithPrefix:@"https://github.com/" mirrorPrefix:@"https://git-cache.local/github/" includesPush:YES],
+    ];
+    XCTAssertEqualObjects(options.urlMirrors, expectedMirrors);
+
+    config = [S7IniConfig configWithContentsOfString:@"[git]\n"];
+    options = [[S7IniConfigOptions alloc] initWithIniConfig:config];
+    XCTAssertNil(options.urlMirrors);
+}
+
+- (void)testMostSpecificMirrorRuleWins {
+    NSArray<GitURLMirror *> *rules = @[
+        [GitURLMirror mirrorWithPrefix:@"git@github.com:" mirrorPrefix:@"https://cache/github/" includesPush:YES],
+        [GitURLMirror mirrorWithPrefix:@"git@github.com:readdle/" mirrorPrefix:@"https://cache/readdle/" includesPush:NO],
+    ];
+
+    XCTAssertEqualObjects([GitURLMirror mirrorForURL:@"git@github.com:readdle/system7.git" amongRules:rules push:NO].mirrorPrefix,
+                          @"https://cache/readdle/");
+    // fetch-only rules never apply to push
+    XCTAssertEqualObjects([GitURLMirror mirrorForURL:@"git@github.com:readdle/system7.git" amongRules:rules push:YES].mirrorPrefix,
+                          @"https://cache/github/");
+    XCTAssertNil([GitURLMirror mirrorForURL:@"git@gitlab.com:readdle/system7.git" amongRules:rules push:NO]);
+
+    XCTAssertEqualObjects([rules.lastObject configCommandLineArguments],
+                          (@[ @"-c", @"url.https://cache/readdle/.insteadOf=git@github.com:readdle/" ]));
+}
+
+- (void)testOptionsSnapshotIsCachedUntilOptionsFileChanges {
+    NSString *repoPath = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSUUID UUID].UUIDString];
+    XCTAssertTrue([NSFileManager.defaultManager createDirectoryAtPath:repoPath withIntermediateDirectories:YES attributes:nil error:nil]);
+
+    NSString *optionsFilePath = [repoPath stringByAppendingPathComponent:S7OptionsFileName];
+    XCTAssertTrue([@"[git]\njobs = 3\n" writeToFile:optionsFilePath atomically:YES encoding:NSUTF8StringEncoding error:nil]);
+
+    S7Options *options = [S7Options optionsForRepoAtPath:repoPath];
+    XCTAssertEqualObjects(options.jobs, @3);
+    XCTAssertEqual(3, options.maxConcurrentJobs);
+
+    XCTAssertTrue(options == [S7Options optionsForRepoAtPath:repoPath]);
+    XCTAssertTrue(options == [S7Options optionsForRepoAtPath:[repoPath stringByAppendingString:@"/"]]);
+
+    XCTAssertTrue([@"[git]\njobs = 5\n" writeToFile:optionsFilePath atomically:YES encoding:NSUTF8StringEncoding error:nil]);
+
+    S7Options *updatedOptions = [S7Options optionsForRepoAtPath:repoPath];
+    XCTAssertTrue(options != updatedOptions);
+    XCTAssertEqualObjects(updatedOptions.jobs, @5);
+
+    XCTAssertTrue([NSFileManager.defaultManager removeItemAtPath:optionsFilePath error:nil]);
+
+    S7Options *defaultOptions = [S7Options optionsForRepoAtPath:repoPath];
+    XCTAssertTrue(updatedOptions != defaultOptions);
+
+    [NSFileManager.defaultManager removeItemAtPath:repoPath error:nil];
+}
+
 @end
@@ -0,0 +1,52 @@
+#!/bin/sh
+
+git clone github/rd2 pastey/rd2
+
+cd pastey/rd2
+
+assert s7 init
+assert git add .
+assert git commit -m "\"init s7\""
+
+assert s7 add --stage Dependencies/ReaddleLib '"$S7_ROOT/github/ReaddleLib"'
+assert git commit -m '"add ReaddleLib subrepo"'
+
+pushd Dependencies/ReaddleLib > /dev/null
+  echo sqrt > RDMath.h
+  git add RDMath.h
+  git commit -m"add RDMath.h"
+popd > /dev/null
+
+assert s7 rebind --stage
+assert git commit -m '"up ReaddleLib"'
+
+assert git push
+
+assert s7 bundle create '"$S7_ROOT/bundles"'
+assert test -f '"$S7_ROOT/bundles/s7bundles.manifest"'
+assert test -f '"$S7_ROOT/bundles/ReaddleLib.bundle"'
+
+
+# make subrepo origin unavailable to be sure that subrepo is cloned from the bundle
+mv "$S7_ROOT/github/ReaddleLib" "$S7_ROOT/ReaddleLib-offline"
+
+export S7_USER_OPTIONS_PATH="$S7_ROOT/nik/.s7options"
+printf "[git]\nbundle-dir = $S7_ROOT/bundles\n" > "$S7_USER_OPTIONS_PATH"
+
+cd "$S7_ROOT/nik"
+
+assert git clone '"$S7_ROOT/github/rd2"'
+
+cd rd2
+
+assert test -f Dependencies/ReaddleLib/RDMath.h
+
+# pinned revision stays referenced, so that gc doesn't take it away
+assert test -n '"$(git -C Dependencies/ReaddleLib for-each-ref refs/s7/pinned)"'
+
+assert test $(git -C Dependencies/ReaddleLib remote get-url origin) = "$S7_ROOT/github/ReaddleLib"
+assert test $(git -C Dependencies/ReaddleLib rev-parse --abbrev-ref HEAD) = main
+
+mv "$S7_ROOT/ReaddleLib-offline" "$S7_ROOT/github/ReaddleLib"
+
+assert s7 stat
@@ -0,0 +1,35 @@
+#!/bin/sh
+
+git clone github/rd2 pastey/rd2
+
+cd pastey/rd2
+
+assert s7 init
+assert git add .
+assert git commit -m "\"init s7\""
+
+assert s7 add --stage Dependencies/ReaddleLib '"$S7_ROOT/github/ReaddleLib"'
+assert s7 add --stage Dependencies/Thirdparty/ReaddleLib '"$S7_ROOT/github/ReaddleLib"'
+assert git commit -m '"add two clones of ReaddleLib"'
+
+# only the second clone knows about this commit
+pushd Dependencies/Thirdparty/ReaddleLib > /dev/null
+  echo sqrt > RDMath.h
+  git add RDMath.h
+  git commit -m"add RDMath.h"
+  NEW_REVISION=$(git rev-parse HEAD)
+popd > /dev/null
+
+assert s7 rebind --stage
+assert git commit -m '"up Thirdparty/ReaddleLib"'
+
+assert ! git -C Dependencies/ReaddleLib cat-file -e $NEW_REVISION
+
+assert s7 bundle create '"$S7_ROOT/bundles"'
+assert test -f '"$S7_ROOT/bundles/ReaddleLib.bundle"'
+assert test ! -f '"$S7_ROOT/bundles/ReaddleLib-2.bundle"'
+
+assert git bundle list-heads '"$S7_ROOT/bundles/ReaddleLib.bundle"' \| grep -q refs/s7/pinned/$NEW_REVISION
+
+# bundling refs are temporary
+assert test -z '"$(git -C Dependencies/Thirdparty/ReaddleLib for-each-ref refs/s7/pinned)"'
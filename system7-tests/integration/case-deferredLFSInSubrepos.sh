@@ -0,0 +1,64 @@
+#!/bin/sh
+
+git clone github/ReaddleLib pastey/ReaddleLib
+
+cd pastey/ReaddleLib
+
+assert git lfs install --local
+
+LARGE_FILE_CONTENT="MEGA-LONG-FILE-CONTENT"
+echo "$LARGE_FILE_CONTENT" > large-file
+assert git lfs track large-file
+
+assert git add large-file .gitattributes
+assert git commit -m '"track large file with Git LFS"'
+assert git push
+
+cd "$S7_ROOT"
+
+git clone github/rd2 pastey/rd2
+
+cd pastey/rd2
+
+assert s7 init
+assert git add .
+assert git commit -m "\"init s7\""
+
+assert s7 add --stage Dependencies/ReaddleLib '"$S7_ROOT/github/ReaddleLib"'
+assert git commit -m '"add ReaddleLib subrepo"'
+
+assert git push
+
+
+export S7_USER_OPTIONS_PATH="$S7_ROOT/nik/.s7options"
+printf "[git]\nlfs = deferred\n" > "$S7_USER_OPTIONS_PATH"
+
+cd "$S7_ROOT/nik"
+
+assert git clone '"$S7_ROOT/github/rd2"'
+
+cd rd2
+
+# content, not an LFS pointer
+assert test "$(cat Dependencies/ReaddleLib/large-file)" = "$LARGE_FILE_CONTENT"
+
+
+cd "$S7_ROOT/pastey/ReaddleLib"
+
+UPDATED_LARGE_FILE_CONTENT="EVEN-LONGER-FILE-CONTENT"
+echo "$UPDATED_LARGE_FILE_CONTENT" > large-file
+assert git commit -am '"update large file"'
+assert git push
+
+cd "$S7_ROOT/pastey/rd2"
+
+assert git -C Dependencies/ReaddleLib pull
+assert s7 rebind --stage
+assert git commit -m '"up ReaddleLib"'
+assert git push
+
+cd "$S7_ROOT/nik/rd2"
+
+assert git pull
+
+assert test "$(cat Dependencies/ReaddleLib/large-file)" = "$UPDATED_LARGE_FILE_CONTENT"
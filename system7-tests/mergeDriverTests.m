@@ -1696,4 +1696,104 @@
         XCTAssertEqualObjects(actualConfig, expectedConfig);
     }];
 }
+
+- (void)testAllDecisionsAreCollectedBeforeConcurrentMergeOfSeveralSubrepos {
+    __block S7Config *baseConfig = nil;
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        s7add(@"Dependencies/ReaddleLib", self.env.githubReaddleLibRepo.absolutePath);
+        s7add(@"Dependencies/RDPDFKit", self.env.githubRDPDFKitRepo.absolutePath);
+
+        [repo add:@[S7ConfigFileName, @".gitignore"]];
+        [repo commitWithMessage:@"add subrepos"];
+
+        baseConfig = [[S7Config alloc] initWithContentsOfFile:S7ConfigFileName];
+
+        s7push_currentBranch(repo);
+    }];
+
+    __block S7Config *niksConfig = nil;
+    __block NSString *readdleLib_niks_Revision = nil;
+    __block NSString *pdfKit_niks_Revision = nil;
+    [self.env.nikRd2Repo run:^(GitRepository * _Nonnull repo) {
+        [repo pull];
+
+        s7init_deactivateHooks();
+
+        S7PostMergeHook *postMergeHook = [S7PostMergeHook new];
+        XCTAssertEqual(0, [postMergeHook runWithArguments:@[]]);
+
+        GitRepository *readdleLibSubrepoGit = [GitRepository repoAtPath:@"Dependencies/ReaddleLib"];
+        readdleLib_niks_Revision = commit(readdleLibSubrepoGit, @"RDGeometry.h", @"xyz", @"some useful math func");
+
+        GitRepository *pdfKitSubrepoGit = [GitRepository repoAtPath:@"Dependencies/RDPDFKit"];
+        pdfKit_niks_Revision = commit(pdfKitSubrepoGit, @"RDPDFAnnotation.h", @"ink", @"ink annotations");
+
+        s7rebind_with_stage();
+        [repo commitWithMessage:@"up subrepos"];
+
+        niksConfig = [[S7Config alloc] initWithContentsOfFile:S7ConfigFileName];
+
+        s7push_currentBranch(repo);
+    }];
+
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        GitRepository *readdleLibSubrepoGit = [GitRepository repoAtPath:@"Dependencies/ReaddleLib"];
+        NSString *readdleLib_pasteys_Revision = commit(readdleLibSubrepoGit, @"RDSystemInfo.h", @"iPad 11''", @"add support for a new iPad model");
+
+        GitRepository *pdfKitSubrepoGit = [GitRepository repoAtPath:@"Dependencies/RDPDFKit"];
+        NSString *pdfKit_pasteys_Revision = commit(pdfKitSubrepoGit, @"RDPDFPage.h", @"rotate", @"page rotation");
+
+        s7rebind_with_stage();
+        [repo commitWithMessage:@"up subrepos"];
+
+        S7Config *ourConfig = [[S7Config alloc] initWithContentsOfFile:S7ConfigFileName];
+
+        [repo fetch];
+
+        S7ConfigMergeDriver *configMergeDriver = [S7ConfigMergeDriver new];
+        configMergeDriver.isTerminalInteractive = ^{ return NO; };
+
+        __block int callNumber = 0;
+        [configMergeDriver setResolveConflictBlock:^S7ConflictResolutionOption(S7SubrepoDescription * _Nonnull ourVersion,
+                                                                               S7SubrepoDescription * _Nonnull theirVersion)
+         {
+            ++callNumber;
+
+            // nothing must be merged until all questions are answered
+            NSString *readdleLibRevision = nil;
+            [readdleLibSubrepoGit getCurrentRevision:&readdleLibRevision];
+            XCTAssertEqualObjects(readdleLibRevision, readdleLib_pasteys_Revision);
+
+            NSString *pdfKitRevision = nil;
+            [pdfKitSubrepoGit getCurrentRevision:&pdfKitRevision];
+            XCTAssertEqualObjects(pdfKitRevision, pdfKit_pasteys_Revision);
+
+            return S7ConflictResolutionOptionMerge;
+         }];
+
+        const int mergeExitStatus = [configMergeDriver
+                                     mergeRepo:repo
+                                     baseConfig:baseConfig
+                                     ourConfig:ourConfig
+                                     theirConfig:niksConfig
+                                     saveResultToFilePath:S7ConfigFileName];
+        XCTAssertEqual(0, mergeExitStatus);
+        XCTAssertEqual(2, callNumber);
+
+        NSString *readdleLibActualRevision = nil;
+        [readdleLibSubrepoGit getCurrentRevision:&readdleLibActualRevision];
+        XCTAssertTrue([readdleLibSubrepoGit isRevisionAnAncestor:readdleLib_niks_Revision toRevision:readdleLibActualRevision]);
+        XCTAssertTrue([readdleLibSubrepoGit isRevisionAnAncestor:readdleLib_pasteys_Revision toRevision:readdleLibActualRevision]);
+
+        NSString *pdfKitActualRevision = nil;
+        [pdfKitSubrepoGit getCurrentRevision:&pdfKitActualRevision];
+        XCTAssertTrue([pdfKitSubrepoGit isRevisionAnAncestor:pdfKit_niks_Revision toRevision:pdfKitActualRevision]);
+        XCTAssertTrue([pdfKitSubrepoGit isRevisionAnAncestor:pdfKit_pasteys_Revision toRevision:pdfKitActualRevision]);
+
+        S7Config *actualConfig = [[S7Config alloc] initWithContentsOfFile:S7ConfigFileName];
+        XCTAssertEqualObjects(actualConfig.pathToDescriptionMap[@"Dependencies/ReaddleLib"].revision, readdleLibActualRevision);
+        XCTAssertEqualObjects(actualConfig.pathToDescriptionMap[@"Dependencies/RDPDFKit"].revision, pdfKitActualRevision);
+    }];
+}
+
 @end
@@ -0,0 +1,156 @@
+//
+//  mirrorTests.m
+//  system7-tests
+//
+//  Copyright © 2026 Readdle. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+
+@interface mirrorTests : XCTestCase
+@property (nonatomic, strong) TestReposEnvironment *env;
+@end
+
+@implementation mirrorTests
+
+- (void)setUp {
+    self.env = [[TestReposEnvironment alloc] initWithTestCaseName:self.className];
+}
+
+- (void)tearDown {
+    GitRepository.urlMirrors = nil;
+}
+
+#pragma mark -
+
+- (NSString *)addReaddleLibInPasteyRd2 {
+    __block NSString *readdleLibRevision = nil;
+
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        s7init_deactivateHooks();
+
+        GitRepository *readdleLibSubrepo = s7add_stage(@"Dependencies/ReaddleLib", self.env.githubReaddleLibRepo.absolutePath);
+        [repo commitWithMessage:@"add ReaddleLib subrepo"];
+
+        [readdleLibSubrepo getCurrentRevision:&readdleLibRevision];
+
+        s7push_currentBranch(repo);
+    }];
+
+    return readdleLibRevision;
+}
+
+- (GitRepository *)createReaddleLibMirror {
+    int exitStatus = 0;
+    GitRepository *mirrorRepo = [GitRepository
+                                 cloneRepoAtURL:self.env.githubReaddleLibRepo.absolutePath
+                                 branch:nil
+                                 bare:YES
+                                 destinationPath:[self.env.root stringByAppendingPathComponent:@"mirror/ReaddleLib"]
+                                 exitStatus:&exitStatus];
+    XCTAssertNotNil(mirrorRepo);
+    XCTAssertEqual(0, exitStatus);
+    return mirrorRepo;
+}
+
+- (void)setUpMirrorOfGithub {
+    NSString *githubPrefix = [self.env.githubReaddleLibRepo.absolutePath.stringByDeletingLastPathComponent stringByAppendingString:@"/"];
+    NSString *mirrorPrefix = [[self.env.root stringByAppendingPathComponent:@"mirror"] stringByAppendingString:@"/"];
+
+    GitRepository.urlMirrors = @[ [GitURLMirror mirrorWithPrefix:githubPrefix mirrorPrefix:mirrorPrefix includesPush:NO] ];
+}
+
+- (void)checkoutInNikRd2 {
+    [self.env.nikRd2Repo run:^(GitRepository * _Nonnull repo) {
+        [repo pull];
+
+        NSString *currentRevision = nil;
+        [repo getCurrentRevision:&currentRevision];
+
+        XCTAssertEqual(S7ExitCodeSuccess, s7checkout([GitRepository nullRevision], currentRevision));
+    }];
+}
+
+#pragma mark -
+
+- (void)testCloneGoesThroughMirrorButKeepsOriginalUrl {
+    NSString *readdleLibRevision = [self addReaddleLibInPasteyRd2];
+
+    GitRepository *mirrorRepo = [self createReaddleLibMirror];
+    // a branch that exists only on mirror tells where objects came from
+    XCTAssertEqual(0, [mirrorRepo runGitCommand:[NSString stringWithFormat:@"branch mirror-only %@", readdleLibRevision]]);
+
+    [self setUpMirrorOfGithub];
+
+    [self.env.nikRd2Repo run:^(GitRepository * _Nonnull repo) {
+        [repo pull];
+
+        NSString *currentRevision = nil;
+        [repo getCurrentRevision:&currentRevision];
+
+        XCTAssertEqual(S7ExitCodeSuccess, s7checkout([GitRepository nullRevision], currentRevision));
+
+        GitRepository *readdleLibSubrepo = [GitRepository repoAtPath:@"Dependencies/ReaddleLib"];
+        XCTAssertNotNil(readdleLibSubrepo);
+        XCTAssertTrue([readdleLibSubrepo doesBranchExist:@"origin/mirror-only"]);
+
+        NSString *remoteUrl = nil;
+        [readdleLibSubrepo getUrl:&remoteUrl];
+        XCTAssertEqualObjects(remoteUrl, self.env.githubReaddleLibRepo.absolutePath);
+
+        S7Config *controlConfig = [[S7Config alloc] initWithContentsOfFile:S7ControlFileName];
+        XCTAssertEqualObjects(controlConfig.pathToDescriptionMap[@"Dependencies/ReaddleLib"].url,
+                              self.env.githubReaddleLibRepo.absolutePath);
+    }];
+}
+
+- (void)testFetchFallsBackToOriginIfMirrorLagsBehind {
+    [self addReaddleLibInPasteyRd2];
+
+    [self createReaddleLibMirror];
+    [self setUpMirrorOfGithub];
+
+    [self checkoutInNikRd2];
+
+    // mirror doesn't get this one
+    __block NSString *newReaddleLibRevision = nil;
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        GitRepository *readdleLibSubrepo = [GitRepository repoAtPath:@"Dependencies/ReaddleLib"];
+        newReaddleLibRevision = commit(readdleLibSubrepo, @"RDGeometry.h", @"CGRectZero", @"geometry");
+
+        s7rebind_with_stage();
+        [repo commitWithMessage:@"up ReaddleLib"];
+
+        s7push_currentBranch(repo);
+    }];
+
+    [self checkoutInNikRd2];
+
+    [self.env.nikRd2Repo run:^(GitRepository * _Nonnull repo) {
+        GitRepository *readdleLibSubrepo = [GitRepository repoAtPath:@"Dependencies/ReaddleLib"];
+
+        NSString *actualReaddleLibRevision = nil;
+        [readdleLibSubrepo getCurrentRevision:&actualReaddleLibRevision];
+        XCTAssertEqualObjects(newReaddleLibRevision, actualReaddleLibRevision);
+    }];
+}
+
+- (void)testCloneFallsBackToOriginIfMirrorIsUnavailable {
+    NSString *readdleLibRevision = [self addReaddleLibInPasteyRd2];
+
+    // rule is there, but the mirror has never been created
+    [self setUpMirrorOfGithub];
+
+    [self checkoutInNikRd2];
+
+    [self.env.nikRd2Repo run:^(GitRepository * _Nonnull repo) {
+        GitRepository *readdleLibSubrepo = [GitRepository repoAtPath:@"Dependencies/ReaddleLib"];
+        XCTAssertNotNil(readdleLibSubrepo);
+
+        NSString *actualReaddleLibRevision = nil;
+        [readdleLibSubrepo getCurrentRevision:&actualReaddleLibRevision];
+        XCTAssertEqualObjects(readdleLibRevision, actualReaddleLibRevision);
+    }];
+}
+
+@end
@@ -0,0 +1,215 @@
+//
+//  parallelExecutorTests.m
+//  system7-tests
+//
+//  Copyright © 2026 Readdle. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "S7ParallelExecutor.h"
+#import "S7Logging.h"
+
+@interface parallelExecutorTests : XCTestCase
+
+@end
+
+@implementation parallelExecutorTests
+
+- (void)testAllTasksSucceed {
+    NSMutableIndexSet *executedTasks = [NSMutableIndexSet new];
+    const int exitCode = [S7ParallelExecutor
+                          runTasks:20
+                          errorPolicy:S7ParallelExecutionErrorPolicyFirstError
+                          task:^int(NSUInteger i) {
+        @synchronized (executedTasks) {
+            [executedTasks addIndex:i];
+        }
+        return S7ExitCodeSuccess;
+    }];
+
+    XCTAssertEqual(S7ExitCodeSuccess, exitCode);
+    XCTAssertEqualObjects(executedTasks, [NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, 20)]);
+}
+
+- (void)testAllErrorsPolicyRunsEveryTaskAndReportsLowestIndexFailure {
+    NSMutableIndexSet *executedTasks = [NSMutableIndexSet new];
+    const int exitCode = [S7ParallelExecutor
+                          runTasks:10
+                          errorPolicy:S7ParallelExecutionErrorPolicyAllErrors
+                          task:^int(NSUInteger i) {
+        @synchronized (executedTasks) {
+            [executedTasks addIndex:i];
+        }
+
+        if (3 == i) {
+            return S7ExitCodeGitOperationFailed;
+        }
+
+        if (7 == i) {
+            return S7ExitCodeFileOperationFailed;
+        }
+
+        return S7ExitCodeSuccess;
+    }];
+
+    XCTAssertEqual(S7ExitCodeGitOperationFailed, exitCode);
+    XCTAssertEqual(10, executedTasks.count);
+}
+
+- (void)testFirstErrorPolicySkipsNotStartedTasks {
+    __block NSUInteger numberOfExecutedTasks = 0;
+    const int exitCode = [S7ParallelExecutor
+                          runTasks:10
+                          errorPolicy:S7ParallelExecutionErrorPolicyFirstError
+                          maxConcurrentTasks:1
+                          task:^int(NSUInteger i) {
+        @synchronized (self) {
+            ++numberOfExecutedTasks;
+        }
+
+        return S7ExitCodeDetachedHEAD;
+    }];
+
+    XCTAssertEqual(S7ExitCodeDetachedHEAD, exitCode);
+    XCTAssertEqual(1, numberOfExecutedTasks);
+}
+
+- (void)testWidthIsBounded {
+    __block NSInteger numberOfRunningTasks = 0;
+    __block NSInteger maxNumberOfRunningTasks = 0;
+    [S7ParallelExecutor
+     runTasks:16
+     errorPolicy:S7ParallelExecutionErrorPolicyAllErrors
+     maxConcurrentTasks:2
+     task:^int(NSUInteger i) {
+        @synchronized (self) {
+            ++numberOfRunningTasks;
+            maxNumberOfRunningTasks = MAX(maxNumberOfRunningTasks, numberOfRunningTasks);
+        }
+
+        usleep(10000);
+
+        @synchronized (self) {
+            --numberOfRunningTasks;
+        }
+
+        return S7ExitCodeSuccess;
+    }];
+
+    XCTAssertLessThanOrEqual(maxNumberOfRunningTasks, 2);
+}
+
+- (void)testWidthIsNotLimitedByNumberOfCores {
+    const NSUInteger width = NSProcessInfo.processInfo.activeProcessorCount + 4;
+
+    __block NSUInteger numberOfRunningTasks = 0;
+    __block NSUInteger maxNumberOfRunningTasks = 0;
+    [S7ParallelExecutor
+     runTasks:width
+     errorPolicy:S7ParallelExecutionErrorPolicyAllErrors
+     maxConcurrentTasks:width
+     task:^int(NSUInteger i) {
+        @synchronized (self) {
+            ++numberOfRunningTasks;
+            maxNumberOfRunningTasks = MAX(maxNumberOfRunningTasks, numberOfRunningTasks);
+        }
+
+        // like a fetch waiting for the network – wait for everybody else to start
+        NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:5];
+        while (deadline.timeIntervalSinceNow > 0) {
+            @synchronized (self) {
+                if (numberOfRunningTasks == width) {
+                    break;
+                }
+            }
+
+            usleep(1000);
+        }
+
+        return S7ExitCodeSuccess;
+    }];
+
+    XCTAssertEqual(width, maxNumberOfRunningTasks);
+}
+
+- (void)testNestedExecutorGetsItsFullWidth {
+    __block NSUInteger numberOfRunningInnerTasks = 0;
+    __block NSUInteger maxNumberOfRunningInnerTasks = 0;
+    [S7ParallelExecutor
+     runTasks:2
+     errorPolicy:S7ParallelExecutionErrorPolicyAllErrors
+     maxConcurrentTasks:2
+     task:^int(NSUInteger i) {
+        return [S7ParallelExecutor
+                runTasks:4
+                errorPolicy:S7ParallelExecutionErrorPolicyAllErrors
+                maxConcurrentTasks:4
+                task:^int(NSUInteger j) {
+            @synchronized (self) {
+                ++numberOfRunningInnerTasks;
+                maxNumberOfRunningInnerTasks = MAX(maxNumberOfRunningInnerTasks, numberOfRunningInnerTasks);
+            }
+
+            NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:5];
+            while (deadline.timeIntervalSinceNow > 0) {
+                @synchronized (self) {
+                    if (numberOfRunningInnerTasks == 8) {
+                        break;
+                    }
+                }
+
+                usleep(1000);
+            }
+
+            return S7ExitCodeSuccess;
+        }];
+    }];
+
+    XCTAssertEqual(8, maxNumberOfRunningInnerTasks);
+}
+
+- (void)testNestedTasksLogIntoOuterTaskContext {
+    NSMutableSet<NSString *> *innerTaskPrefixes = [NSMutableSet new];
+    NSArray<NSString *> *outerLabels = @[ @"a", @"b", @"c", @"d" ];
+    NSArray<NSString *> *innerLabels = @[ @"x", @"y", @"z" ];
+
+    const int exitCode = [S7ParallelExecutor
+                          runTasksWithLabels:outerLabels
+                          errorPolicy:S7ParallelExecutionErrorPolicyAllErrors
+                          task:^int(NSUInteger i) {
+        S7LogContext *outerTaskContext = currentLogContext();
+
+        return [S7ParallelExecutor
+                runTasksWithLabels:innerLabels
+                errorPolicy:S7ParallelExecutionErrorPolicyAllErrors
+                task:^int(NSUInteger j) {
+            S7LogContext *innerTaskContext = currentLogContext();
+            XCTAssertNotEqual(innerTaskContext, outerTaskContext);
+            // buffered till the outer task is done, never goes to the console on its own
+            if (NO == outerTaskContext.isStreaming) {
+                XCTAssertFalse(innerTaskContext.isStreaming);
+            }
+
+            @synchronized (innerTaskPrefixes) {
+                [innerTaskPrefixes addObject:innerTaskContext.prefix];
+            }
+
+            return S7ExitCodeSuccess;
+        }];
+    }];
+
+    XCTAssertEqual(S7ExitCodeSuccess, exitCode);
+
+    NSMutableSet<NSString *> *expectedPrefixes = [NSMutableSet new];
+    for (NSString *outerLabel in outerLabels) {
+        for (NSString *innerLabel in innerLabels) {
+            [expectedPrefixes addObject:[NSString stringWithFormat:@"%@/%@", outerLabel, innerLabel]];
+        }
+    }
+    XCTAssertEqualObjects(innerTaskPrefixes, expectedPrefixes);
+
+    XCTAssertNil(currentLogContext());
+}
+
+@end
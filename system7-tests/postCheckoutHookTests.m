@@ -14,6 +14,8 @@
 #import "S7InitCommand.h"
 #import "S7PostMergeHook.h"
 
+#import "Git+Statistics.h"
+
 @interface postCheckoutHookTests : XCTestCase
 @property (nonatomic, strong) TestReposEnvironment *env;
 @end
@@ -950,6 +952,66 @@
     }];
 }
 
+- (void)testRemovedSubrepoIsMovedToTrashAndDeletedInBackground {
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        s7init_deactivateHooks();
+
+        s7add_stage(@"Dependencies/ReaddleLib", self.env.githubReaddleLibRepo.absolutePath);
+        [repo commitWithMessage:@"add ReaddleLib subrepo"];
+
+        s7push_currentBranch(repo);
+    }];
+
+    [self.env.nikRd2Repo run:^(GitRepository * _Nonnull repo) {
+        [repo pull];
+
+        NSString *currentRevision = nil;
+        [repo getCurrentRevision:&currentRevision];
+
+        XCTAssertEqual(S7ExitCodeSuccess, s7checkout([GitRepository nullRevision], currentRevision));
+    }];
+
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        s7remove(@"Dependencies/ReaddleLib");
+
+        [repo add:@[S7ConfigFileName, @".gitignore"]];
+        [repo commitWithMessage:@"drop ReaddleLib"];
+
+        s7push_currentBranch(repo);
+    }];
+
+    [self.env.nikRd2Repo run:^(GitRepository * _Nonnull repo) {
+        NSString *trashDirectoryPath = [S7PostCheckoutHook trashDirectoryPathInRepoAtPath:repo.absolutePath];
+
+        // a leftover of some reaper that has never finished its job
+        XCTAssertTrue([NSFileManager.defaultManager createDirectoryAtPath:[trashDirectoryPath stringByAppendingPathComponent:@"leftover/.git"]
+                                              withIntermediateDirectories:YES
+                                                               attributes:nil
+                                                                    error:nil]);
+
+        NSString *prevRevision = nil;
+        [repo getCurrentRevision:&prevRevision];
+
+        [repo pull];
+
+        NSString *currentRevision = nil;
+        [repo getCurrentRevision:&currentRevision];
+
+        XCTAssertEqual(S7ExitCodeSuccess, s7checkout(prevRevision, currentRevision));
+
+        XCTAssertFalse([NSFileManager.defaultManager fileExistsAtPath:@"Dependencies/ReaddleLib"]);
+
+        NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:10];
+        while ([NSFileManager.defaultManager contentsOfDirectoryAtPath:trashDirectoryPath error:nil].count > 0
+               && [deadline timeIntervalSinceNow] > 0)
+        {
+            [NSThread sleepForTimeInterval:0.05];
+        }
+
+        XCTAssertEqual(0, [NSFileManager.defaultManager contentsOfDirectoryAtPath:trashDirectoryPath error:nil].count);
+    }];
+}
+
 - (void)testBranchSwitchDoesNotRemoveSubrepoDirIfInContainsUncommittedLocalChanges {
     __block NSString *readdleLib_initialRevision = nil;
 
@@ -1314,8 +1376,13 @@
         NSString *currentRevision = nil;
         [repo getCurrentRevision:&currentRevision];
 
+        [GitRepository resetSpawnStatistics];
+
         XCTAssertEqual(S7ExitCodeSuccess, s7checkout([GitRepository nullRevision], currentRevision));
 
+        // fork shares history with the original repo – origin is re-pointed, nothing is re-cloned
+        XCTAssertNil([GitRepository numberOfSpawnedCommandsByVerb][@"clone"]);
+
         GitRepository *lottieSubrepo = [GitRepository repoAtPath:@"Dependencies/Thirdparty/lottie-ios"];
         XCTAssertNotNil(lottieSubrepo);
         NSString *remoteUrl = nil;
@@ -1328,6 +1395,139 @@
     }];
 }
 
+- (void)testSubrepoMigrationToUnrelatedRepoReclonesIt {
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        s7init_deactivateHooks();
+
+        s7add_stage(@"Dependencies/ReaddleLib", self.env.githubReaddleLibRepo.absolutePath);
+        [repo commitWithMessage:@"add ReaddleLib subrepo"];
+
+        s7push_currentBranch(repo);
+    }];
+
+    [self.env.nikRd2Repo run:^(GitRepository * _Nonnull repo) {
+        [repo pull];
+
+        NSString *currentRevision = nil;
+        [repo getCurrentRevision:&currentRevision];
+
+        XCTAssertEqual(S7ExitCodeSuccess, s7checkout([GitRepository nullRevision], currentRevision));
+    }];
+
+    // all test remotes are made from the same template, thus share the first commit.
+    // This one has a history of its own
+    int exitStatus = 0;
+    GitRepository *unrelatedRepo = [GitRepository initializeRepositoryAtPath:[self.env.root stringByAppendingPathComponent:@"gitlab/ReaddleLib"]
+                                                                        bare:NO
+                                                           defaultBranchName:@"main"
+                                                                  exitStatus:&exitStatus];
+    XCTAssertNotNil(unrelatedRepo);
+    XCTAssertEqual(0, exitStatus);
+    NSString *unrelatedRevision = commit(unrelatedRepo, @"README.md", @"rewritten from scratch", @"initial commit");
+
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        s7remove(@"Dependencies/ReaddleLib");
+
+        GitRepository *readdleLibSubrepo = s7add_stage(@"Dependencies/ReaddleLib", unrelatedRepo.absolutePath);
+        XCTAssertNotNil(readdleLibSubrepo);
+        [repo commitWithMessage:@"move ReaddleLib to a repo with a different history"];
+
+        s7push_currentBranch(repo);
+    }];
+
+    [self.env.nikRd2Repo run:^(GitRepository * _Nonnull repo) {
+        [repo pull];
+
+        NSString *currentRevision = nil;
+        [repo getCurrentRevision:&currentRevision];
+
+        [GitRepository resetSpawnStatistics];
+
+        XCTAssertEqual(S7ExitCodeSuccess, s7checkout([GitRepository nullRevision], currentRevision));
+
+        XCTAssertEqualObjects(@1, [GitRepository numberOfSpawnedCommandsByVerb][@"clone"]);
+
+        GitRepository *readdleLibSubrepo = [GitRepository repoAtPath:@"Dependencies/ReaddleLib"];
+        XCTAssertNotNil(readdleLibSubrepo);
+
+        NSString *remoteUrl = nil;
+        [readdleLibSubrepo getUrl:&remoteUrl];
+        XCTAssertEqualObjects(remoteUrl, unrelatedRepo.absolutePath);
+
+        NSString *readdleLibRevision = nil;
+        [readdleLibSubrepo getCurrentRevision:&readdleLibRevision];
+        XCTAssertEqualObjects(readdleLibRevision, unrelatedRevision);
+    }];
+}
+
+- (void)testSubrepoMigrationIsRefusedIfSubrepoHasUnpushedCommits {
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        s7init_deactivateHooks();
+
+        s7add_stage(@"Dependencies/ReaddleLib", self.env.githubReaddleLibRepo.absolutePath);
+        [repo commitWithMessage:@"add ReaddleLib subrepo"];
+
+        s7push_currentBranch(repo);
+    }];
+
+    __block NSString *unpushedRevision = nil;
+    [self.env.nikRd2Repo run:^(GitRepository * _Nonnull repo) {
+        [repo pull];
+
+        NSString *currentRevision = nil;
+        [repo getCurrentRevision:&currentRevision];
+
+        XCTAssertEqual(S7ExitCodeSuccess, s7checkout([GitRepository nullRevision], currentRevision));
+
+        GitRepository *readdleLibSubrepo = [GitRepository repoAtPath:@"Dependencies/ReaddleLib"];
+        XCTAssertNotNil(readdleLibSubrepo);
+        unpushedRevision = commit(readdleLibSubrepo, @"RDGeometry.h", @"work in progress", @"not pushed yet");
+    }];
+
+    int exitStatus = 0;
+    GitRepository *unrelatedRepo = [GitRepository initializeRepositoryAtPath:[self.env.root stringByAppendingPathComponent:@"gitlab/ReaddleLib"]
+                                                                        bare:NO
+                                                           defaultBranchName:@"main"
+                                                                  exitStatus:&exitStatus];
+    XCTAssertNotNil(unrelatedRepo);
+    XCTAssertEqual(0, exitStatus);
+    commit(unrelatedRepo, @"README.md", @"rewritten from scratch", @"initial commit");
+
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        s7remove(@"Dependencies/ReaddleLib");
+
+        GitRepository *readdleLibSubrepo = s7add_stage(@"Dependencies/ReaddleLib", unrelatedRepo.absolutePath);
+        XCTAssertNotNil(readdleLibSubrepo);
+        [repo commitWithMessage:@"move ReaddleLib to a repo with a different history"];
+
+        s7push_currentBranch(repo);
+    }];
+
+    [self.env.nikRd2Repo run:^(GitRepository * _Nonnull repo) {
+        NSString *revisionBeforePull = nil;
+        [repo getCurrentRevision:&revisionBeforePull];
+
+        [repo pull];
+
+        NSString *currentRevision = nil;
+        [repo getCurrentRevision:&currentRevision];
+
+        XCTAssertEqual(S7ExitCodeSubrepoHasLocalChanges, s7checkout(revisionBeforePull, currentRevision));
+
+        // nothing is lost – the subrepo stays as it was
+        GitRepository *readdleLibSubrepo = [GitRepository repoAtPath:@"Dependencies/ReaddleLib"];
+        XCTAssertNotNil(readdleLibSubrepo);
+
+        NSString *remoteUrl = nil;
+        [readdleLibSubrepo getUrl:&remoteUrl];
+        XCTAssertEqualObjects(remoteUrl, self.env.githubReaddleLibRepo.absolutePath);
+
+        NSString *readdleLibRevision = nil;
+        [readdleLibSubrepo getCurrentRevision:&readdleLibRevision];
+        XCTAssertEqualObjects(readdleLibRevision, unpushedRevision);
+    }];
+}
+
 - (void)testCheckoutSameBrachAfterDeinit {
     [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
         // s7 init
@@ -0,0 +1,167 @@
+//
+//  prefetchTests.m
+//  system7-tests
+//
+//  Copyright © 2026 Readdle. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "S7PrefetchCommand.h"
+
+@interface prefetchTests : XCTestCase
+@property (nonatomic, strong) TestReposEnvironment *env;
+@end
+
+@implementation prefetchTests
+
+- (void)setUp {
+    self.env = [[TestReposEnvironment alloc] initWithTestCaseName:self.className];
+}
+
+#pragma mark -
+
+- (NSString *)setUpReaddleLibInBothRd2Clones {
+    __block NSString *initialReaddleLibRevision = nil;
+
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        s7init_deactivateHooks();
+
+        GitRepository *readdleLibSubrepo = s7add_stage(@"Dependencies/ReaddleLib", self.env.githubReaddleLibRepo.absolutePath);
+        [repo commitWithMessage:@"add ReaddleLib subrepo"];
+
+        [readdleLibSubrepo getCurrentRevision:&initialReaddleLibRevision];
+
+        s7push_currentBranch(repo);
+    }];
+
+    [self.env.nikRd2Repo run:^(GitRepository * _Nonnull repo) {
+        [repo pull];
+
+        NSString *currentRevision = nil;
+        [repo getCurrentRevision:&currentRevision];
+
+        XCTAssertEqual(S7ExitCodeSuccess, s7checkout([GitRepository nullRevision], currentRevision));
+    }];
+
+    return initialReaddleLibRevision;
+}
+
+- (NSString *)pushNewReaddleLibRevisionFromPastey {
+    __block NSString *newReaddleLibRevision = nil;
+
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        GitRepository *readdleLibSubrepo = [GitRepository repoAtPath:@"Dependencies/ReaddleLib"];
+        newReaddleLibRevision = commit(readdleLibSubrepo, @"RDGeometry.h", @"CGRectZero", @"geometry");
+        XCTAssertEqual(0, [readdleLibSubrepo pushAll]);
+    }];
+
+    return newReaddleLibRevision;
+}
+
+#pragma mark -
+
+- (void)testPrefetchDoesntTouchRemoteBranchesAndWorkingTree {
+    NSString *initialReaddleLibRevision = [self setUpReaddleLibInBothRd2Clones];
+    NSString *newReaddleLibRevision = [self pushNewReaddleLibRevisionFromPastey];
+
+    [self.env.nikRd2Repo run:^(GitRepository * _Nonnull repo) {
+        GitRepository *readdleLibSubrepo = [GitRepository repoAtPath:@"Dependencies/ReaddleLib"];
+        XCTAssertFalse([readdleLibSubrepo isRevisionAvailableLocally:newReaddleLibRevision]);
+
+        S7PrefetchCommand *command = [S7PrefetchCommand new];
+        XCTAssertEqual(S7ExitCodeSuccess, [command runWithArguments:@[]]);
+
+        XCTAssertTrue([readdleLibSubrepo isRevisionAvailableLocally:newReaddleLibRevision]);
+
+        NSString *remoteRevision = nil;
+        [readdleLibSubrepo getLatestRemoteRevision:&remoteRevision atBranch:@"main"];
+        XCTAssertEqualObjects(initialReaddleLibRevision, remoteRevision);
+
+        NSString *currentRevision = nil;
+        [readdleLibSubrepo getCurrentRevision:&currentRevision];
+        XCTAssertEqualObjects(initialReaddleLibRevision, currentRevision);
+
+        XCTAssertFalse([readdleLibSubrepo hasUncommitedChanges]);
+    }];
+}
+
+- (void)testPrefetchKeepsShallowSubrepoShallow {
+    // Git ignores --depth in clones by plain local path
+    NSString *readdleLibFileURL = [@"file://" stringByAppendingString:self.env.githubReaddleLibRepo.absolutePath];
+
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        s7init_deactivateHooks();
+
+        s7add_stage(@"Dependencies/ReaddleLib", readdleLibFileURL);
+        [repo commitWithMessage:@"add ReaddleLib subrepo"];
+
+        s7push_currentBranch(repo);
+    }];
+
+    [self.env.nikRd2Repo run:^(GitRepository * _Nonnull repo) {
+        NSString *optionsFilePath = [repo.absolutePath stringByAppendingPathComponent:S7OptionsFileName];
+        XCTAssertTrue([@"[git]\n    depth = 1\n" writeToFile:optionsFilePath atomically:YES encoding:NSUTF8StringEncoding error:nil]);
+
+        [repo pull];
+
+        NSString *currentRevision = nil;
+        [repo getCurrentRevision:&currentRevision];
+
+        XCTAssertEqual(S7ExitCodeSuccess, s7checkout([GitRepository nullRevision], currentRevision));
+
+        XCTAssertTrue([GitRepository repoAtPath:@"Dependencies/ReaddleLib"].isShallowRepo);
+    }];
+
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        GitRepository *readdleLibSubrepo = [GitRepository repoAtPath:@"Dependencies/ReaddleLib"];
+        XCTAssertEqual(0, [readdleLibSubrepo checkoutNewLocalBranch:@"feature"]);
+        commit(readdleLibSubrepo, @"RDMath.h", @"sqrt", @"math");
+        commit(readdleLibSubrepo, @"RDGeometry.h", @"CGRectZero", @"geometry");
+        commit(readdleLibSubrepo, @"RDColor.h", @"UIColor", @"color");
+        XCTAssertEqual(0, [readdleLibSubrepo pushAll]);
+    }];
+
+    [self.env.nikRd2Repo run:^(GitRepository * _Nonnull repo) {
+        S7PrefetchCommand *command = [S7PrefetchCommand new];
+        XCTAssertEqual(S7ExitCodeSuccess, [command runWithArguments:@[]]);
+
+        GitRepository *readdleLibSubrepo = [GitRepository repoAtPath:@"Dependencies/ReaddleLib"];
+        XCTAssertTrue(readdleLibSubrepo.isShallowRepo);
+
+        // the new branch has come without its history
+        NSString *numberOfCommits = nil;
+        XCTAssertEqual(0, [readdleLibSubrepo runGitWithArguments:@[ @"rev-list", @"--count", @"refs/s7-prefetch/origin/feature" ]
+                                                    stdOutOutput:&numberOfCommits
+                                                    stdErrOutput:NULL]);
+        XCTAssertEqualObjects(@"1", [numberOfCommits stringByTrimmingCharactersInSet:NSCharacterSet.whitespaceAndNewlineCharacterSet]);
+    }];
+}
+
+- (void)testPrefetchBacksOffWhileCheckoutIsInProgress {
+    [self setUpReaddleLibInBothRd2Clones];
+    NSString *newReaddleLibRevision = [self pushNewReaddleLibRevisionFromPastey];
+
+    [self.env.nikRd2Repo run:^(GitRepository * _Nonnull repo) {
+        const int hookLock = [S7PrefetchCommand tryLockPrefetchInRepo:repo exclusive:NO];
+        XCTAssertGreaterThanOrEqual(hookLock, 0);
+
+        // hooks share the lock with each other
+        const int nestedHookLock = [S7PrefetchCommand tryLockPrefetchInRepo:repo exclusive:NO];
+        XCTAssertGreaterThanOrEqual(nestedHookLock, 0);
+        [S7PrefetchCommand unlockPrefetch:nestedHookLock];
+
+        S7PrefetchCommand *command = [S7PrefetchCommand new];
+        XCTAssertEqual(S7ExitCodeSuccess, [command runWithArguments:@[]]);
+
+        GitRepository *readdleLibSubrepo = [GitRepository repoAtPath:@"Dependencies/ReaddleLib"];
+        XCTAssertFalse([readdleLibSubrepo isRevisionAvailableLocally:newReaddleLibRevision]);
+
+        [S7PrefetchCommand unlockPrefetch:hookLock];
+
+        XCTAssertEqual(S7ExitCodeSuccess, [command runWithArguments:@[]]);
+        XCTAssertTrue([readdleLibSubrepo isRevisionAvailableLocally:newReaddleLibRevision]);
+    }];
+}
+
+@end
@@ -0,0 +1,140 @@
+//
+//  pullTests.m
+//  system7-tests
+//
+//  Copyright © 2026 Readdle. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "S7PullCommand.h"
+#import "S7PostMergeHook.h"
+
+#import "Git+Statistics.h"
+
+@interface pullTests : XCTestCase
+@property (nonatomic, strong) TestReposEnvironment *env;
+@end
+
+@implementation pullTests
+
+- (void)setUp {
+    self.env = [[TestReposEnvironment alloc] initWithTestCaseName:self.className];
+}
+
+- (void)tearDown {
+    [GitRepository setEnvironmentOverrideValue:nil forKey:S7PullFetchedSubreposOfRepoEnvironmentVariable];
+    [GitRepository resetSpawnStatistics];
+}
+
+#pragma mark -
+
+- (void)testPullFetchesSubreposAndPostMergeDoesntFetchThemAgain {
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        s7init_deactivateHooks();
+
+        s7add_stage(@"Dependencies/ReaddleLib", self.env.githubReaddleLibRepo.absolutePath);
+        [repo commitWithMessage:@"add ReaddleLib subrepo"];
+
+        s7push_currentBranch(repo);
+    }];
+
+    [self.env.nikRd2Repo run:^(GitRepository * _Nonnull repo) {
+        [repo pull];
+
+        NSString *currentRevision = nil;
+        [repo getCurrentRevision:&currentRevision];
+
+        XCTAssertEqual(S7ExitCodeSuccess, s7checkout([GitRepository nullRevision], currentRevision));
+    }];
+
+    __block NSString *pasteyRd2Revision = nil;
+    __block NSString *newReaddleLibRevision = nil;
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        GitRepository *readdleLibSubrepo = [GitRepository repoAtPath:@"Dependencies/ReaddleLib"];
+        newReaddleLibRevision = commit(readdleLibSubrepo, @"RDGeometry.h", @"CGRectZero", @"geometry");
+
+        s7rebind_with_stage();
+        [repo commitWithMessage:@"up ReaddleLib"];
+
+        s7push_currentBranch(repo);
+
+        [repo getCurrentRevision:&pasteyRd2Revision];
+    }];
+
+    [self.env.nikRd2Repo run:^(GitRepository * _Nonnull repo) {
+        S7PullCommand *command = [S7PullCommand new];
+        XCTAssertEqual(S7ExitCodeSuccess, [command runWithArguments:@[]]);
+
+        NSString *currentRevision = nil;
+        [repo getCurrentRevision:&currentRevision];
+        XCTAssertEqualObjects(pasteyRd2Revision, currentRevision);
+
+        GitRepository *readdleLibSubrepo = [GitRepository repoAtPath:@"Dependencies/ReaddleLib"];
+        XCTAssertTrue([readdleLibSubrepo isRevisionAvailableLocally:newReaddleLibRevision]);
+
+        NSString *remoteRevision = nil;
+        [readdleLibSubrepo getLatestRemoteRevision:&remoteRevision atBranch:@"main"];
+        XCTAssertEqualObjects(newReaddleLibRevision, remoteRevision);
+
+        // hooks are fake in tests, thus we run post-merge the way `git merge` would run it
+        [GitRepository setEnvironmentOverrideValue:repo.absolutePath.stringByResolvingSymlinksInPath
+                                            forKey:S7PullFetchedSubreposOfRepoEnvironmentVariable];
+        [GitRepository resetSpawnStatistics];
+
+        S7PostMergeHook *postMergeHook = [S7PostMergeHook new];
+        XCTAssertEqual(S7ExitCodeSuccess, [postMergeHook runWithArguments:@[]]);
+
+        XCTAssertNil([GitRepository numberOfSpawnedCommandsByVerb][@"fetch"]);
+
+        NSString *actualReaddleLibRevision = nil;
+        [readdleLibSubrepo getCurrentRevision:&actualReaddleLibRevision];
+        XCTAssertEqualObjects(newReaddleLibRevision, actualReaddleLibRevision);
+    }];
+}
+
+- (void)testPostMergeFetchesAsUsualWithoutPull {
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        s7init_deactivateHooks();
+
+        s7add_stage(@"Dependencies/ReaddleLib", self.env.githubReaddleLibRepo.absolutePath);
+        [repo commitWithMessage:@"add ReaddleLib subrepo"];
+
+        s7push_currentBranch(repo);
+    }];
+
+    [self.env.nikRd2Repo run:^(GitRepository * _Nonnull repo) {
+        [repo pull];
+
+        NSString *currentRevision = nil;
+        [repo getCurrentRevision:&currentRevision];
+
+        XCTAssertEqual(S7ExitCodeSuccess, s7checkout([GitRepository nullRevision], currentRevision));
+    }];
+
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        GitRepository *readdleLibSubrepo = [GitRepository repoAtPath:@"Dependencies/ReaddleLib"];
+        commit(readdleLibSubrepo, @"RDGeometry.h", @"CGRectZero", @"geometry");
+
+        s7rebind_with_stage();
+        [repo commitWithMessage:@"up ReaddleLib"];
+
+        s7push_currentBranch(repo);
+    }];
+
+    [self.env.nikRd2Repo run:^(GitRepository * _Nonnull repo) {
+        [repo pull];
+
+        // variable set for another repo must not affect this one
+        [GitRepository setEnvironmentOverrideValue:self.env.pasteyRd2Repo.absolutePath.stringByResolvingSymlinksInPath
+                                            forKey:S7PullFetchedSubreposOfRepoEnvironmentVariable];
+        [GitRepository resetSpawnStatistics];
+
+        S7PostMergeHook *postMergeHook = [S7PostMergeHook new];
+        XCTAssertEqual(S7ExitCodeSuccess, [postMergeHook runWithArguments:@[]]);
+
+        XCTAssertEqualObjects(@1, [GitRepository numberOfSpawnedCommandsByVerb][@"fetch"]);
+    }];
+}
+
+@end
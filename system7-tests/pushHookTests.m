@@ -226,6 +226,53 @@
     }];
 }
 
+- (void)testPushOfNestedS7SubreposIsPlannedByTopLevelHook {
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        s7init_deactivateHooks();
+
+        GitRepository *pdfKitSubrepoGit = s7add_stage(@"Dependencies/RDPDFKit", self.env.githubRDPDFKitRepo.absolutePath);
+        [repo commitWithMessage:@"add RDPDFKit subrepo"];
+        s7push_currentBranch(repo);
+
+        NSString *rd2RemoteRevision = nil;
+        [repo getLatestRemoteRevision:&rd2RemoteRevision atBranch:@"main"];
+
+        __block NSString *formCalcRevision = nil;
+        __block NSString *pdfKitRevision = nil;
+        [pdfKitSubrepoGit run:^(GitRepository * _Nonnull pdfKitRepo) {
+            s7init_deactivateHooks();
+
+            [pdfKitRepo add:@[ @".gitattributes" ]];
+
+            GitRepository *formCalcSubrepoGit = s7add_stage(@"Dependencies/FormCalc", self.env.githubFormCalcRepo.absolutePath);
+            [pdfKitRepo commitWithMessage:@"add FormCalc subrepo"];
+
+            formCalcRevision = commit(formCalcSubrepoGit, @"Parser.c", @"AST", @"ast");
+
+            s7rebind_with_stage();
+            [pdfKitRepo commitWithMessage:@"up FormCalc"];
+
+            [pdfKitRepo getCurrentRevision:&pdfKitRevision];
+        }];
+
+        s7rebind_with_stage();
+        [repo commitWithMessage:@"up RDPDFKit"];
+
+        NSString *rd2Revision = nil;
+        [repo getCurrentRevision:&rd2Revision];
+
+        // hooks in subrepos are fake, so nobody but the top-level hook could push FormCalc
+        S7PrePushHook *command = [S7PrePushHook new];
+        command.testStdinContents = [NSString stringWithFormat:@"refs/heads/main %@ refs/heads/main %@",
+                                     rd2Revision,
+                                     rd2RemoteRevision];
+        XCTAssertEqual(0, [command runWithArguments:@[]]);
+
+        XCTAssertTrue([self.env.githubFormCalcRepo isRevisionAvailableLocally:formCalcRevision]);
+        XCTAssertTrue([self.env.githubRDPDFKitRepo isRevisionAvailableLocally:pdfKitRevision]);
+    }];
+}
+
 - (void)testPushSubrepoWithCustomBranch {
     [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
         s7init_deactivateHooks();
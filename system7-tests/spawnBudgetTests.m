@@ -0,0 +1,234 @@
+//
+//  spawnBudgetTests.m
+//  system7-tests
+//
+//  Copyright © 2026 Readdle. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "S7StatusCommand.h"
+#import "S7PostCommitHook.h"
+#import "S7PrepareCommitMsgHook.h"
+
+#import "Git+Statistics.h"
+
+// Every scenario here has a budget of git processes it may spawn.
+// If a test fails, then most probably someone has put a git call inside
+// a per-subrepo loop, or has added one more call on a hot path. Please, think twice
+// before raising a budget – it's exactly what makes s7 slow on big projects.
+//
+@interface spawnBudgetTests : XCTestCase
+@property (nonatomic, strong) TestReposEnvironment *env;
+@end
+
+@implementation spawnBudgetTests
+
+- (void)setUp {
+    self.env = [[TestReposEnvironment alloc] initWithTestCaseName:self.className];
+}
+
+- (void)tearDown {
+    [GitRepository resetSpawnStatistics];
+}
+
+#pragma mark -
+
+- (NSArray<GitRepository *> *)addFourSubreposToRepo:(GitRepository *)repo {
+    NSArray<GitRepository *> *subrepos = @[
+        s7add(@"Dependencies/ReaddleLib", self.env.githubReaddleLibRepo.absolutePath),
+        s7add(@"Dependencies/RDSFTP", self.env.githubRDSFTPRepo.absolutePath),
+        s7add(@"Dependencies/RDPDFKit", self.env.githubRDPDFKitRepo.absolutePath),
+        s7add(@"Dependencies/FormCalc", self.env.githubFormCalcRepo.absolutePath),
+    ];
+
+    [repo add:@[S7ConfigFileName, @".gitignore"]];
+    [repo commitWithMessage:@"add subrepos"];
+
+    return subrepos;
+}
+
+#pragma mark - statistics -
+
+- (void)testSpawnsAreCountedByVerbAndByRepository {
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        [GitRepository resetSpawnStatistics];
+        XCTAssertEqual(0, [GitRepository numberOfSpawnedCommands]);
+
+        commit(repo, @"file", @"asdf", @"test");
+
+        // `add` and `commit`. Revision is read without spawning git
+        XCTAssertEqual(2, [GitRepository numberOfSpawnedCommands]);
+        XCTAssertEqual(2, repo.numberOfSpawnedCommands);
+        XCTAssertEqual(0, self.env.githubRd2Repo.numberOfSpawnedCommands);
+
+        NSDictionary<NSString *, NSNumber *> *verbToCount = [GitRepository numberOfSpawnedCommandsByVerb];
+        XCTAssertEqualObjects(@1, verbToCount[@"add"]);
+        XCTAssertEqualObjects(@1, verbToCount[@"commit"]);
+
+        NSDictionary<NSString *, NSNumber *> *repoVerbToCount = [GitRepository numberOfSpawnedCommandsByRepository][repo.absolutePath];
+        XCTAssertEqualObjects(verbToCount, repoVerbToCount);
+
+        [GitRepository resetSpawnStatistics];
+        XCTAssertEqual(0, [GitRepository numberOfSpawnedCommands]);
+        XCTAssertEqual(0, [GitRepository numberOfSpawnedCommandsByRepository].count);
+    }];
+}
+
+#pragma mark - budgets -
+
+- (void)testPostCheckoutWithUnchangedSubstate {
+    __block NSString *revisionWithSubrepos = nil;
+    __block NSString *unrelatedRevision = nil;
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        s7init_deactivateHooks();
+
+        NSArray<GitRepository *> *subrepos = [self addFourSubreposToRepo:repo];
+        XCTAssertEqual(4, subrepos.count);
+
+        [repo getCurrentRevision:&revisionWithSubrepos];
+        unrelatedRevision = commit(repo, @"file", @"uno", @"unrelated change");
+
+        [GitRepository resetSpawnStatistics];
+
+        XCTAssertEqual(0, s7checkout(revisionWithSubrepos, unrelatedRevision));
+
+        [GitRepository printSpawnStatistics];
+
+        // main repo: availability of both revisions, lfs check, two configs.
+        // subrepos: uncommitted changes check only. Nothing is fetched or checked out.
+        XCTAssertLessThanOrEqual([GitRepository numberOfSpawnedCommands], 8 + 2 * subrepos.count);
+        for (GitRepository *subrepoGit in subrepos) {
+            XCTAssertLessThanOrEqual(subrepoGit.numberOfSpawnedCommands, 2);
+        }
+
+        NSDictionary<NSString *, NSNumber *> *verbToCount = [GitRepository numberOfSpawnedCommandsByVerb];
+        XCTAssertNil(verbToCount[@"fetch"]);
+        XCTAssertNil(verbToCount[@"clone"]);
+        XCTAssertNil(verbToCount[@"checkout"]);
+        XCTAssertNil(verbToCount[@"reset"]);
+    }];
+}
+
+- (void)testCloneOfSubrepoWithDeletedBranchDownloadsOnce {
+    __block NSString *readdleLibRevision = nil;
+
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        s7init_deactivateHooks();
+
+        GitRepository *readdleLibSubrepo = s7add_stage(@"Dependencies/ReaddleLib", self.env.githubReaddleLibRepo.absolutePath);
+        [repo commitWithMessage:@"add ReaddleLib subrepo"];
+
+        [readdleLibSubrepo checkoutNewLocalBranch:@"feature/short-lived"];
+        readdleLibRevision = commit(readdleLibSubrepo, @"File.c", @"feature", @"feature");
+
+        s7rebind_with_stage();
+        [repo commitWithMessage:@"switch ReaddleLib to feature/short-lived"];
+
+        s7push_currentBranch(repo);
+
+        [readdleLibSubrepo checkoutExistingLocalBranch:@"main"];
+        [readdleLibSubrepo mergeWith:@"feature/short-lived"];
+        [readdleLibSubrepo pushAll];
+        [readdleLibSubrepo deleteRemoteBranch:@"feature/short-lived"];
+    }];
+
+    [self.env.nikRd2Repo run:^(GitRepository * _Nonnull repo) {
+        [repo pull];
+
+        NSString *currentRevision = nil;
+        [repo getCurrentRevision:&currentRevision];
+
+        [GitRepository resetSpawnStatistics];
+
+        XCTAssertEqual(S7ExitCodeSuccess, s7checkout([GitRepository nullRevision], currentRevision));
+
+        [GitRepository printSpawnStatistics];
+
+        GitRepository *readdleLibSubrepo = [GitRepository repoAtPath:@"Dependencies/ReaddleLib"];
+        NSString *actualReaddleLibRevision = nil;
+        [readdleLibSubrepo getCurrentRevision:&actualReaddleLibRevision];
+        XCTAssertEqualObjects(readdleLibRevision, actualReaddleLibRevision);
+
+        // one download, and the working tree is written once
+        NSDictionary<NSString *, NSNumber *> *verbToCount = [GitRepository numberOfSpawnedCommandsByVerb];
+        XCTAssertEqualObjects(@1, verbToCount[@"clone"]);
+        XCTAssertNil(verbToCount[@"fetch"]);
+        XCTAssertEqualObjects(@1, verbToCount[@"checkout"]);
+    }];
+}
+
+- (void)testStatusOnCleanSubrepos {
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        s7init_deactivateHooks();
+
+        NSArray<GitRepository *> *subrepos = [self addFourSubreposToRepo:repo];
+
+        [GitRepository resetSpawnStatistics];
+
+        NSDictionary<NSString *, NSNumber * /* S7Status */> *status = nil;
+        XCTAssertEqual(0, [S7StatusCommand repo:repo calculateStatus:&status]);
+        XCTAssertEqual(subrepos.count, status.count);
+
+        [GitRepository printSpawnStatistics];
+
+        // one `git status` per subrepo is the price we pay to detect uncommitted changes.
+        // Branch and revision must be read without spawning git.
+        XCTAssertLessThanOrEqual([GitRepository numberOfSpawnedCommands], 4 + subrepos.count);
+        for (GitRepository *subrepoGit in subrepos) {
+            XCTAssertLessThanOrEqual(subrepoGit.numberOfSpawnedCommands, 1);
+        }
+    }];
+}
+
+- (void)testRepeatedStatusDoesntReadCommittedConfigFromGit {
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        s7init_deactivateHooks();
+
+        NSArray<GitRepository *> *subrepos = [self addFourSubreposToRepo:repo];
+
+        NSDictionary<NSString *, NSNumber * /* S7Status */> *status = nil;
+        XCTAssertEqual(0, [S7StatusCommand repo:repo calculateStatus:&status]);
+
+        [GitRepository resetSpawnStatistics];
+
+        NSDictionary<NSString *, NSNumber * /* S7Status */> *repeatedStatus = nil;
+        XCTAssertEqual(0, [S7StatusCommand repo:repo calculateStatus:&repeatedStatus]);
+        XCTAssertEqualObjects(status, repeatedStatus);
+
+        [GitRepository printSpawnStatistics];
+
+        // config at HEAD comes from the journal. What's left is `git status` in subrepos
+        XCTAssertNil([GitRepository numberOfSpawnedCommandsByVerb][@"show"]);
+        XCTAssertEqual(0, repo.numberOfSpawnedCommands);
+        XCTAssertLessThanOrEqual([GitRepository numberOfSpawnedCommands], subrepos.count);
+    }];
+}
+
+- (void)testPostCommitOnNonMergeCommit {
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        s7init_deactivateHooks();
+
+        NSArray<GitRepository *> *subrepos = [self addFourSubreposToRepo:repo];
+
+        commit(repo, @"file", @"asdf", @"test");
+
+        [GitRepository resetSpawnStatistics];
+
+        S7PrepareCommitMsgHook *prepareCommitHook = [S7PrepareCommitMsgHook new];
+        XCTAssertEqual(0, [prepareCommitHook runWithArguments:@[]]);
+
+        S7PostCommitHook *postCommitHook = [S7PostCommitHook new];
+        XCTAssertEqual(0, [postCommitHook runWithArguments:@[]]);
+
+        [GitRepository printSpawnStatistics];
+
+        // a simple commit must not touch subrepos at all
+        XCTAssertLessThanOrEqual([GitRepository numberOfSpawnedCommands], 3);
+        for (GitRepository *subrepoGit in subrepos) {
+            XCTAssertEqual(0, subrepoGit.numberOfSpawnedCommands);
+        }
+    }];
+}
+
+@end
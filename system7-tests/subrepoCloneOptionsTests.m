@@ -0,0 +1,221 @@
+//
+//  subrepoCloneOptionsTests.m
+//  system7-tests
+//
+//  Copyright © 2026 Readdle. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+
+@interface subrepoCloneOptionsTests : XCTestCase
+@property (nonatomic, strong) TestReposEnvironment *env;
+@end
+
+@implementation subrepoCloneOptionsTests
+
+- (void)setUp {
+    self.env = [[TestReposEnvironment alloc] initWithTestCaseName:self.className];
+}
+
+#pragma mark - utils -
+
+// Git ignores --depth and --filter in clones by plain local path – file:// is a real transport
+- (NSString *)readdleLibFileURL {
+    return [@"file://" stringByAppendingString:self.env.githubReaddleLibRepo.absolutePath];
+}
+
+- (void)writeOptions:(NSString *)options toRepo:(GitRepository *)repo {
+    NSString *optionsFilePath = [repo.absolutePath stringByAppendingPathComponent:S7OptionsFileName];
+    XCTAssertTrue([options writeToFile:optionsFilePath atomically:YES encoding:NSUTF8StringEncoding error:nil]);
+}
+
+- (NSString *)commitToReaddleLibInPasteyRd2:(NSString *)fileName message:(NSString *)message {
+    __block NSString *mainRepoRevision = nil;
+
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        GitRepository *readdleLibSubrepo = [GitRepository repoAtPath:@"Dependencies/ReaddleLib"];
+        XCTAssertNotNil(readdleLibSubrepo);
+
+        NSString *directory = [readdleLibSubrepo.absolutePath stringByAppendingPathComponent:fileName.stringByDeletingLastPathComponent];
+        [NSFileManager.defaultManager createDirectoryAtPath:directory withIntermediateDirectories:YES attributes:nil error:nil];
+
+        commit(readdleLibSubrepo, fileName, message, message);
+
+        s7rebind_with_stage();
+        [repo commitWithMessage:[NSString stringWithFormat:@"up ReaddleLib: %@", message]];
+
+        s7push_currentBranch(repo);
+
+        [repo getCurrentRevision:&mainRepoRevision];
+    }];
+
+    return mainRepoRevision;
+}
+
+- (void)addReaddleLibInPasteyRd2 {
+    [self.env.pasteyRd2Repo run:^(GitRepository * _Nonnull repo) {
+        s7init_deactivateHooks();
+
+        s7add_stage(@"Dependencies/ReaddleLib", [self readdleLibFileURL]);
+        [repo commitWithMessage:@"add ReaddleLib subrepo"];
+
+        s7push_currentBranch(repo);
+    }];
+}
+
+- (void)pullAndCheckoutInRepo:(GitRepository *)repo {
+    NSString *revisionBeforePull = nil;
+    [repo getCurrentRevision:&revisionBeforePull];
+
+    [repo pull];
+
+    NSString *currentRevision = nil;
+    [repo getCurrentRevision:&currentRevision];
+
+    XCTAssertEqual(S7ExitCodeSuccess, s7checkout(revisionBeforePull, currentRevision));
+}
+
+- (NSString *)stdOutOfGitCommand:(NSArray<NSString *> *)arguments inRepo:(GitRepository *)repo {
+    NSString *stdOutOutput = nil;
+    XCTAssertEqual(0, [repo runGitWithArguments:arguments stdOutOutput:&stdOutOutput stdErrOutput:NULL]);
+    return [stdOutOutput stringByTrimmingCharactersInSet:NSCharacterSet.whitespaceAndNewlineCharacterSet];
+}
+
+#pragma mark - shallow -
+
+- (void)testShallowCloneOfSubrepo {
+    [self addReaddleLibInPasteyRd2];
+    [self commitToReaddleLibInPasteyRd2:@"RDMath.h" message:@"add RDMath.h"];
+    [self commitToReaddleLibInPasteyRd2:@"RDGeometry.h" message:@"add RDGeometry.h"];
+
+    [self.env.nikRd2Repo run:^(GitRepository * _Nonnull repo) {
+        [self writeOptions:@"[git]\n    depth = 1\n" toRepo:repo];
+
+        [self pullAndCheckoutInRepo:repo];
+
+        GitRepository *readdleLibSubrepo = [GitRepository repoAtPath:@"Dependencies/ReaddleLib"];
+        XCTAssertNotNil(readdleLibSubrepo);
+        XCTAssertTrue(readdleLibSubrepo.isShallowRepo);
+        XCTAssertEqualObjects(@"1", [self stdOutOfGitCommand:@[ @"rev-list", @"--count", @"HEAD" ] inRepo:readdleLibSubrepo]);
+    }];
+}
+
+- (void)testShallowSinceCloneOfSubrepo {
+    [self addReaddleLibInPasteyRd2];
+
+    [GitRepository setEnvironmentOverrideValue:@"2020-01-01T00:00:00" forKey:@"GIT_COMMITTER_DATE"];
+    [self commitToReaddleLibInPasteyRd2:@"RDMath.h" message:@"add RDMath.h"];
+    [GitRepository setEnvironmentOverrideValue:@"2024-01-01T00:00:00" forKey:@"GIT_COMMITTER_DATE"];
+    [self commitToReaddleLibInPasteyRd2:@"RDGeometry.h" message:@"add RDGeometry.h"];
+    [GitRepository setEnvironmentOverrideValue:nil forKey:@"GIT_COMMITTER_DATE"];
+
+    [self.env.nikRd2Repo run:^(GitRepository * _Nonnull repo) {
+        [self writeOptions:@"[git]\n    shallow-since = 2023-01-01\n" toRepo:repo];
+
+        [self pullAndCheckoutInRepo:repo];
+
+        GitRepository *readdleLibSubrepo = [GitRepository repoAtPath:@"Dependencies/ReaddleLib"];
+        XCTAssertNotNil(readdleLibSubrepo);
+        XCTAssertTrue(readdleLibSubrepo.isShallowRepo);
+        XCTAssertEqualObjects(@"1", [self stdOutOfGitCommand:@[ @"rev-list", @"--count", @"HEAD" ] inRepo:readdleLibSubrepo]);
+    }];
+}
+
+- (void)testCheckoutOfRevisionBeyondShallowBoundaryDeepensSubrepo {
+    [self addReaddleLibInPasteyRd2];
+    NSString *oldMainRepoRevision = [self commitToReaddleLibInPasteyRd2:@"RDMath.h" message:@"add RDMath.h"];
+    [self commitToReaddleLibInPasteyRd2:@"RDGeometry.h" message:@"add RDGeometry.h"];
+    NSString *newMainRepoRevision = [self commitToReaddleLibInPasteyRd2:@"RDColor.h" message:@"add RDColor.h"];
+
+    [self.env.nikRd2Repo run:^(GitRepository * _Nonnull repo) {
+        [self writeOptions:@"[git]\n    depth = 1\n" toRepo:repo];
+
+        [self pullAndCheckoutInRepo:repo];
+
+        GitRepository *readdleLibSubrepo = [GitRepository repoAtPath:@"Dependencies/ReaddleLib"];
+        XCTAssertNotNil(readdleLibSubrepo);
+        XCTAssertTrue(readdleLibSubrepo.isShallowRepo);
+
+        S7Config *oldConfig = nil;
+        XCTAssertEqual(S7ExitCodeSuccess, getConfig(repo, oldMainRepoRevision, &oldConfig));
+        NSString *oldReaddleLibRevision = oldConfig.pathToDescriptionMap[@"Dependencies/ReaddleLib"].revision;
+        XCTAssertFalse([readdleLibSubrepo isRevisionAvailableLocally:oldReaddleLibRevision]);
+
+        XCTAssertEqual(0, [repo checkoutRevision:oldMainRepoRevision]);
+        XCTAssertEqual(S7ExitCodeSuccess, s7checkout(newMainRepoRevision, oldMainRepoRevision));
+
+        NSString *readdleLibRevision = nil;
+        [readdleLibSubrepo getCurrentRevision:&readdleLibRevision];
+        XCTAssertEqualObjects(readdleLibRevision, oldReaddleLibRevision);
+    }];
+}
+
+- (void)testFetchDoesntCutHistoryOfFullClone {
+    [self addReaddleLibInPasteyRd2];
+    [self commitToReaddleLibInPasteyRd2:@"RDMath.h" message:@"add RDMath.h"];
+
+    [self.env.nikRd2Repo run:^(GitRepository * _Nonnull repo) {
+        [self pullAndCheckoutInRepo:repo];
+
+        GitRepository *readdleLibSubrepo = [GitRepository repoAtPath:@"Dependencies/ReaddleLib"];
+        XCTAssertNotNil(readdleLibSubrepo);
+        XCTAssertFalse(readdleLibSubrepo.isShallowRepo);
+    }];
+
+    [self commitToReaddleLibInPasteyRd2:@"RDGeometry.h" message:@"add RDGeometry.h"];
+
+    [self.env.nikRd2Repo run:^(GitRepository * _Nonnull repo) {
+        // options changed after the subrepo has been cloned in full
+        [self writeOptions:@"[git]\n    depth = 1\n" toRepo:repo];
+
+        [self pullAndCheckoutInRepo:repo];
+
+        GitRepository *readdleLibSubrepo = [GitRepository repoAtPath:@"Dependencies/ReaddleLib"];
+        XCTAssertFalse(readdleLibSubrepo.isShallowRepo);
+    }];
+}
+
+#pragma mark - filter -
+
+- (void)testTreeLessCloneOfSubrepo {
+    // local upload-pack ignores filters unless asked
+    XCTAssertEqual(0, [self.env.githubReaddleLibRepo runGitWithArguments:@[ @"config", @"uploadpack.allowFilter", @"true" ]
+                                                            stdOutOutput:NULL
+                                                            stdErrOutput:NULL]);
+
+    [self addReaddleLibInPasteyRd2];
+
+    [self.env.nikRd2Repo run:^(GitRepository * _Nonnull repo) {
+        [self writeOptions:@"[git]\n    filter = tree:0\n" toRepo:repo];
+
+        [self pullAndCheckoutInRepo:repo];
+
+        GitRepository *readdleLibSubrepo = [GitRepository repoAtPath:@"Dependencies/ReaddleLib"];
+        XCTAssertNotNil(readdleLibSubrepo);
+        XCTAssertEqualObjects(@"tree:0",
+                              [self stdOutOfGitCommand:@[ @"config", @"remote.origin.partialclonefilter" ] inRepo:readdleLibSubrepo]);
+    }];
+}
+
+#pragma mark - sparse -
+
+- (void)testSparseCheckoutOfSubrepo {
+    [self addReaddleLibInPasteyRd2];
+    [self commitToReaddleLibInPasteyRd2:@"Sources/RDMath.h" message:@"add RDMath.h"];
+    [self commitToReaddleLibInPasteyRd2:@"Docs/RDMath.md" message:@"document RDMath.h"];
+
+    [self.env.nikRd2Repo run:^(GitRepository * _Nonnull repo) {
+        [self writeOptions:@"[subrepo \"Dependencies/ReaddleLib\"]\n    sparse-checkout = Sources\n" toRepo:repo];
+
+        [self pullAndCheckoutInRepo:repo];
+
+        GitRepository *readdleLibSubrepo = [GitRepository repoAtPath:@"Dependencies/ReaddleLib"];
+        XCTAssertNotNil(readdleLibSubrepo);
+        XCTAssertEqualObjects(@"Sources", [self stdOutOfGitCommand:@[ @"sparse-checkout", @"list" ] inRepo:readdleLibSubrepo]);
+
+        XCTAssertTrue([NSFileManager.defaultManager fileExistsAtPath:@"Dependencies/ReaddleLib/Sources/RDMath.h"]);
+        XCTAssertFalse([NSFileManager.defaultManager fileExistsAtPath:@"Dependencies/ReaddleLib/Docs/RDMath.md"]);
+    }];
+}
+
+@end
@@ -125,7 +125,7 @@ NS_ASSUME_NONNULL_BEGIN
         }
     }
 
-    S7Options *options = [S7Options new];
+    S7Options *options = [S7Options optionsForRepoAtPath:@"."];
     GitRepository *gitSubrepo = nil;
 
     BOOL isDirectory = NO;
@@ -145,8 +145,12 @@ NS_ASSUME_NONNULL_BEGIN
 
         int cloneResult = 0;
         gitSubrepo = [GitRepository cloneRepoAtURL:url
+                                            branch:nil
+                                              bare:NO
                                    destinationPath:path
-                                            filter:options.filter
+                                      cloneOptions:[[options optionsForSubrepoAtPath:path] cloneOptions]
+                                      stdOutOutput:NULL
+                                      stdErrOutput:NULL
                                         exitStatus:&cloneResult];
         
         if (0 != cloneResult) {
@@ -0,0 +1,24 @@
+//
+//  S7BundleCommand.h
+//  system7
+//
+//  Copyright © 2026 Readdle. All rights reserved.
+//
+
+#import "S7Command.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+extern NSString * const S7BundleManifestFileName;
+
+@interface S7BundleCommand : NSObject <S7Command>
+
+// Absolute path to the bundle of a subrepo with the given url if bundle directory
+// contains one. nil if there's no such bundle or bundle directory is not specified.
+//
++ (nullable NSString *)bundlePathForSubrepoURL:(NSString *)url
+                             inBundleDirectory:(nullable NSString *)bundleDirectory;
+
+@end
+
+NS_ASSUME_NONNULL_END
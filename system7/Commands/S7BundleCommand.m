@@ -0,0 +1,323 @@
+//
+//  S7BundleCommand.m
+//  system7
+//
+//  Copyright © 2026 Readdle. All rights reserved.
+//
+
+#import "S7BundleCommand.h"
+
+#import "S7Utils.h"
+#import "S7HelpPager.h"
+#import "S7IniConfig.h"
+#import "S7Options.h"
+#import "S7ParallelExecutor.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+NSString * const S7BundleManifestFileName = @"s7bundles.manifest";
+
+static NSString * const S7BundleManifestSectionNameFormat = @"bundle \"%@\"";
+static NSString * const S7BundleManifestFileKey = @"file";
+
+@implementation S7BundleCommand
+
++ (NSString *)commandName {
+    return @"bundle";
+}
+
++ (NSArray<NSString *> *)aliases {
+    return @[];
+}
+
++ (void)printCommandHelp {
+    help_puts("s7 bundle create DIR");
+    printCommandAliases(self);
+    help_puts("");
+    help_puts("create a git bundle for every subrepo (including nested subrepos)");
+    help_puts("");
+    help_puts("    Each bundle contains remote branches, tags and the revisions");
+    help_puts("    saved in %s. Bundles are described by %s file", S7ConfigFileName.fileSystemRepresentation, S7BundleManifestFileName.fileSystemRepresentation);
+    help_puts("    in DIR, keyed by subrepo URL. Subrepos that share the same URL");
+    help_puts("    share one bundle.");
+    help_puts("");
+    help_puts("    Point `bundle-dir` option in [git] section of .s7options to DIR,");
+    help_puts("    and s7 will seed subrepo clones and fetches from bundles, going to");
+    help_puts("    the network only if necessary revision is missing in a bundle.");
+    help_puts("    Designed for CI, where every job starts with an empty workspace.");
+}
+
+- (int)runWithArguments:(NSArray<NSString *> *)arguments {
+    S7_REPO_PRECONDITION_CHECK();
+
+    if (arguments.count < 1 || NO == [arguments.firstObject isEqualToString:@"create"]) {
+        [[self class] printCommandHelp];
+        return S7ExitCodeUnknownCommand;
+    }
+
+    if (arguments.count < 2) {
+        logError("please specify the directory to save bundles to.\n");
+        return S7ExitCodeMissingRequiredArgument;
+    }
+
+    if (arguments.count > 2) {
+        logError("unexpected arguments.\n");
+        [[self class] printCommandHelp];
+        return S7ExitCodeInvalidArgument;
+    }
+
+    GitRepository *repo = [GitRepository repoAtPath:@"."];
+    if (nil == repo) {
+        return S7ExitCodeNotGitRepository;
+    }
+
+    NSString *bundleDirectory = [arguments[1] stringByStandardizingPath];
+    if (NO == bundleDirectory.isAbsolutePath) {
+        bundleDirectory = [[NSFileManager.defaultManager currentDirectoryPath] stringByAppendingPathComponent:bundleDirectory];
+    }
+
+    return [self createBundlesForRepo:repo inDirectory:bundleDirectory];
+}
+
+- (int)createBundlesForRepo:(GitRepository *)repo inDirectory:(NSString *)bundleDirectory {
+    NSMutableDictionary<NSString *, NSMutableOrderedSet<NSString *> *> *urlToSubrepoAbsolutePaths = [NSMutableDictionary new];
+    NSMutableDictionary<NSString *, NSMutableOrderedSet<NSString *> *> *urlToRevisions = [NSMutableDictionary new];
+
+    const int collectExitStatus = [self collectSubreposOfRepoAtPath:repo.absolutePath
+                                          urlToSubrepoAbsolutePaths:urlToSubrepoAbsolutePaths
+                                                     urlToRevisions:urlToRevisions];
+    if (S7ExitCodeSuccess != collectExitStatus) {
+        return collectExitStatus;
+    }
+
+    NSError *error = nil;
+    if (NO == [NSFileManager.defaultManager createDirectoryAtPath:bundleDirectory
+                                      withIntermediateDirectories:YES
+                                                       attributes:nil
+                                                            error:&error])
+    {
+        logError("failed to create directory '%s'. Error: %s\n",
+                 bundleDirectory.fileSystemRepresentation,
+                 [error.description cStringUsingEncoding:NSUTF8StringEncoding]);
+        return S7ExitCodeFileOperationFailed;
+    }
+
+    NSArray<NSString *> *urls = [urlToSubrepoAbsolutePaths.allKeys sortedArrayUsingSelector:@selector(compare:)];
+
+    // bundle file names are assigned in advance, so that two subrepos with the same
+    // name, but different URLs, do not fight for the same file
+    NSMutableDictionary<NSString *, NSString *> *urlToBundleFileName = [NSMutableDictionary new];
+    NSMutableSet<NSString *> *usedBundleFileNames = [NSMutableSet new];
+    for (NSString *url in urls) {
+        NSString *baseName = [[url lastPathComponent] stringByDeletingPathExtension];
+        if (0 == baseName.length) {
+            baseName = @"subrepo";
+        }
+
+        NSString *bundleFileName = [baseName stringByAppendingPathExtension:@"bundle"];
+        for (NSUInteger i = 2; [usedBundleFileNames containsObject:bundleFileName]; ++i) {
+            bundleFileName = [[NSString stringWithFormat:@"%@-%lu", baseName, (unsigned long)i] stringByAppendingPathExtension:@"bundle"];
+        }
+
+        [usedBundleFileNames addObject:bundleFileName];
+        urlToBundleFileName[url] = bundleFileName;
+    }
+
+    NSMutableArray<NSString *> *labels = [NSMutableArray arrayWithCapacity:urls.count];
+    for (NSString *url in urls) {
+        [labels addObject:urlToBundleFileName[url]];
+    }
+
+    S7Options *options = [S7Options optionsForRepoAtPath:repo.absolutePath];
+
+    const int exitCode =
+    [S7ParallelExecutor
+     runTasksWithLabels:labels
+     errorPolicy:S7ParallelExecutionErrorPolicyAllErrors
+     maxConcurrentTasks:options.maxConcurrentJobs
+     task:^int(NSUInteger i) {
+        NSString *url = urls[i];
+        NSArray<NSString *> *revisions = urlToRevisions[url].array;
+        NSString *bundlePath = [bundleDirectory stringByAppendingPathComponent:urlToBundleFileName[url]];
+
+        GitRepository *subrepoGit = nil;
+        const int findExitCode = [self findCloneOfURL:url
+                                        withRevisions:revisions
+                                           amongPaths:urlToSubrepoAbsolutePaths[url].array
+                                           subrepoGit:&subrepoGit];
+        if (S7ExitCodeSuccess != findExitCode) {
+            return findExitCode;
+        }
+
+        subrepoGit.redirectOutputToMemory = YES;
+
+        if (0 != [subrepoGit createBundleAtPath:bundlePath revisions:revisions]) {
+            logError("  failed to create bundle for '%s':\n%s\n",
+                     [url cStringUsingEncoding:NSUTF8StringEncoding],
+                     [subrepoGit.lastCommandStdErrOutput cStringUsingEncoding:NSUTF8StringEncoding]);
+            return S7ExitCodeGitOperationFailed;
+        }
+
+        logInfo("  bundled '%s'\n", [url cStringUsingEncoding:NSUTF8StringEncoding]);
+        return S7ExitCodeSuccess;
+    }];
+
+    if (S7ExitCodeSuccess != exitCode) {
+        return exitCode;
+    }
+
+    NSMutableString *manifest = [NSMutableString new];
+    for (NSString *url in urls) {
+        [manifest appendFormat:@"[%@]\n", [NSString stringWithFormat:S7BundleManifestSectionNameFormat, url]];
+        [manifest appendFormat:@"    %@ = %@\n", S7BundleManifestFileKey, urlToBundleFileName[url]];
+    }
+
+    NSString *manifestPath = [bundleDirectory stringByAppendingPathComponent:S7BundleManifestFileName];
+    if (NO == [manifest writeToFile:manifestPath atomically:YES encoding:NSUTF8StringEncoding error:&error]) {
+        logError("failed to save %s. Error: %s\n",
+                 manifestPath.fileSystemRepresentation,
+                 [error.description cStringUsingEncoding:NSUTF8StringEncoding]);
+        return S7ExitCodeFileOperationFailed;
+    }
+
+    logInfo("created %lu bundle(s) in '%s'\n", (unsigned long)urls.count, bundleDirectory.fileSystemRepresentation);
+
+    return S7ExitCodeSuccess;
+}
+
+// The same URL can be cloned at several paths (by nested s7 repos, for example), each
+// pinned to its own revision. A clone that was not fetched lately may lack revisions
+// other clones are pinned to, so we look for the one that has them all.
+//
+- (int)findCloneOfURL:(NSString *)url
+        withRevisions:(NSArray<NSString *> *)revisions
+           amongPaths:(NSArray<NSString *> *)subrepoAbsolutePaths
+           subrepoGit:(GitRepository * _Nullable __autoreleasing * _Nonnull)ppSubrepoGit
+{
+    NSString *firstMissingRevision = nil;
+    for (NSString *subrepoAbsolutePath in subrepoAbsolutePaths) {
+        GitRepository *subrepoGit = [GitRepository repoAtPath:subrepoAbsolutePath];
+        if (nil == subrepoGit) {
+            logError("  subrepo at '%s' is not a git repo\n", subrepoAbsolutePath.fileSystemRepresentation);
+            return S7ExitCodeSubrepoIsNotGitRepository;
+        }
+
+        NSString *missingRevision = nil;
+        for (NSString *revision in revisions) {
+            if (NO == [subrepoGit isRevisionAvailableLocally:revision]) {
+                missingRevision = revision;
+                break;
+            }
+        }
+
+        if (nil == missingRevision) {
+            *ppSubrepoGit = subrepoGit;
+            return S7ExitCodeSuccess;
+        }
+
+        if (nil == firstMissingRevision) {
+            firstMissingRevision = missingRevision;
+        }
+    }
+
+    logError("  none of the clones of '%s' has all the revisions to bundle (for example, '%s').\n"
+             "  Please, fetch subrepos first.\n",
+             [url cStringUsingEncoding:NSUTF8StringEncoding],
+             [firstMissingRevision cStringUsingEncoding:NSUTF8StringEncoding]);
+    return S7ExitCodeInvalidSubrepoRevision;
+}
+
+- (int)collectSubreposOfRepoAtPath:(NSString *)repoAbsolutePath
+         urlToSubrepoAbsolutePaths:(NSMutableDictionary<NSString *, NSMutableOrderedSet<NSString *> *> *)urlToSubrepoAbsolutePaths
+                    urlToRevisions:(NSMutableDictionary<NSString *, NSMutableOrderedSet<NSString *> *> *)urlToRevisions
+{
+    NSString *configPath = [repoAbsolutePath stringByAppendingPathComponent:S7ConfigFileName];
+    if (NO == [NSFileManager.defaultManager fileExistsAtPath:configPath]) {
+        return S7ExitCodeSuccess;
+    }
+
+    S7Config *config = [[S7Config alloc] initWithContentsOfFile:configPath];
+    if (nil == config) {
+        return S7ExitCodeFailedToParseConfig;
+    }
+
+    for (S7SubrepoDescription *subrepoDesc in config.subrepoDescriptions) {
+        NSString *subrepoAbsolutePath = [repoAbsolutePath stringByAppendingPathComponent:subrepoDesc.path];
+
+        BOOL isDirectory = NO;
+        if (NO == [NSFileManager.defaultManager fileExistsAtPath:subrepoAbsolutePath isDirectory:&isDirectory] || NO == isDirectory) {
+            logError("  subrepo '%s' is not cloned. Please, run `s7 checkout` first.\n",
+                     subrepoDesc.path.fileSystemRepresentation);
+            return S7ExitCodeSubrepoIsNotGitRepository;
+        }
+
+        if (nil == urlToSubrepoAbsolutePaths[subrepoDesc.url]) {
+            urlToSubrepoAbsolutePaths[subrepoDesc.url] = [NSMutableOrderedSet new];
+            urlToRevisions[subrepoDesc.url] = [NSMutableOrderedSet new];
+        }
+
+        [urlToSubrepoAbsolutePaths[subrepoDesc.url] addObject:subrepoAbsolutePath];
+        [urlToRevisions[subrepoDesc.url] addObject:subrepoDesc.revision];
+
+        const int exitStatus = [self collectSubreposOfRepoAtPath:subrepoAbsolutePath
+                                       urlToSubrepoAbsolutePaths:urlToSubrepoAbsolutePaths
+                                                  urlToRevisions:urlToRevisions];
+        if (S7ExitCodeSuccess != exitStatus) {
+            return exitStatus;
+        }
+    }
+
+    return S7ExitCodeSuccess;
+}
+
+#pragma mark - manifest -
+
++ (nullable NSString *)bundlePathForSubrepoURL:(NSString *)url
+                             inBundleDirectory:(nullable NSString *)bundleDirectory
+{
+    if (0 == bundleDirectory.length) {
+        return nil;
+    }
+
+    // checkout reads manifest for every subrepo from multiple threads
+    static NSMutableDictionary<NSString *, S7IniConfig *> *bundleDirectoryToManifest = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        bundleDirectoryToManifest = [NSMutableDictionary new];
+    });
+
+    S7IniConfig *manifest = nil;
+    @synchronized (bundleDirectoryToManifest) {
+        manifest = bundleDirectoryToManifest[bundleDirectory];
+        if (nil == manifest) {
+            NSString *manifestPath = [bundleDirectory stringByAppendingPathComponent:S7BundleManifestFileName];
+            if (NO == [NSFileManager.defaultManager fileExistsAtPath:manifestPath]) {
+                return nil;
+            }
+
+            manifest = [S7IniConfig configWithContentsOfFile:manifestPath];
+            if (nil == manifest) {
+                return nil;
+            }
+
+            bundleDirectoryToManifest[bundleDirectory] = manifest;
+        }
+    }
+
+    NSString *sectionName = [NSString stringWithFormat:S7BundleManifestSectionNameFormat, url];
+    NSString *bundleFileName = manifest.dictionaryRepresentation[sectionName][S7BundleManifestFileKey];
+    if (0 == bundleFileName.length) {
+        return nil;
+    }
+
+    NSString *bundlePath = [bundleDirectory stringByAppendingPathComponent:bundleFileName];
+    if (NO == [NSFileManager.defaultManager fileExistsAtPath:bundlePath]) {
+        return nil;
+    }
+
+    return bundlePath;
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
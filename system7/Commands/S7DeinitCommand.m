@@ -9,6 +9,9 @@
 #import "S7DeinitCommand.h"
 
 #import "S7HelpPager.h"
+#import "S7ConfigJournal.h"
+#import "S7PrefetchCommand.h"
+#import "S7PostCheckoutHook.h"
 
 // I considered if deinit should remove all actual subrepo directories
 // and decided not to do that. I don't know what will the user do next:
@@ -71,7 +74,17 @@
         [linesToRemoveFromGitIgnore addObject:subrepoDesc.path];
     }
 
-    for (NSString *fileName in @[ S7BakFileName, S7BootstrapFileName, S7ControlFileName, S7ConfigFileName ]) {
+    NSArray<NSString *> *filesToRemove = @[
+        S7BakFileName,
+        S7BootstrapFileName,
+        S7ControlFileName,
+        S7ConfigFileName,
+        [S7ConfigJournal journalPathInRepo:repo],
+        [S7PrefetchCommand lockFilePathInRepo:repo],
+        [S7PostCheckoutHook trashDirectoryPathInRepoAtPath:repo.absolutePath],
+    ];
+
+    for (NSString *fileName in filesToRemove) {
         if (NO == [NSFileManager.defaultManager fileExistsAtPath:fileName]) {
             continue;
         }
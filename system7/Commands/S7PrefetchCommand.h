@@ -0,0 +1,27 @@
+//
+//  S7PrefetchCommand.h
+//  system7
+//
+//  Copyright © 2026 Readdle. All rights reserved.
+//
+
+#import "S7Command.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface S7PrefetchCommand : NSObject <S7Command>
+
+// Hooks hold a shared lock on <git dir>/s7-prefetch.lock while they check out subrepos.
+// Prefetch takes it exclusively, and if it can't, it backs off and leaves the network to hooks.
+// Neither side ever waits for the other.
+//
+// Returns a descriptor to pass to +unlockPrefetch:, or -1 if the lock is busy.
+//
++ (int)tryLockPrefetchInRepo:(GitRepository *)repo exclusive:(BOOL)exclusive;
++ (void)unlockPrefetch:(int)lockFileDescriptor;
+
++ (NSString *)lockFilePathInRepo:(GitRepository *)repo;
+
+@end
+
+NS_ASSUME_NONNULL_END
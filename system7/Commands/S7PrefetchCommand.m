@@ -0,0 +1,212 @@
+//
+//  S7PrefetchCommand.m
+//  system7
+//
+//  Copyright © 2026 Readdle. All rights reserved.
+//
+
+#import "S7PrefetchCommand.h"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#import "S7Utils.h"
+#import "S7HelpPager.h"
+#import "S7Options.h"
+#import "S7ConfigJournal.h"
+#import "S7ParallelExecutor.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+static NSString * const S7PrefetchLockFileName = @"s7-prefetch.lock";
+
+@implementation S7PrefetchCommand
+
++ (NSString *)commandName {
+    return @"prefetch";
+}
+
++ (NSArray<NSString *> *)aliases {
+    return @[];
+}
+
++ (void)printCommandHelp {
+    help_puts("s7 prefetch");
+    printCommandAliases(self);
+    help_puts("");
+    help_puts("fetch subrepos in background, so that checkout and pull don't have to");
+    help_puts("");
+    help_puts("    Fetches every subrepo mentioned in the current %s, and in", S7ConfigFileName.fileSystemRepresentation);
+    help_puts("    configs s7 has lately checked out, all at once. Nested subrepos are");
+    help_puts("    prefetched too. Branches are fetched into refs/s7-prefetch/origin/*,");
+    help_puts("    remote branches and working trees stay as they are.");
+    help_puts("");
+    help_puts("    Designed to be run from cron, launchd, systemd timer or an idle hook.");
+    help_puts("    If checkout is in progress, prefetch does nothing and exits with 0.");
+}
+
+- (int)runWithArguments:(NSArray<NSString *> *)arguments {
+    S7_REPO_PRECONDITION_CHECK();
+
+    if (arguments.count > 0) {
+        logError("unexpected arguments.\n");
+        [[self class] printCommandHelp];
+        return S7ExitCodeInvalidArgument;
+    }
+
+    GitRepository *repo = [GitRepository repoAtPath:@"."];
+    if (nil == repo) {
+        return S7ExitCodeNotGitRepository;
+    }
+
+    const int lockFileDescriptor = [[self class] tryLockPrefetchInRepo:repo exclusive:YES];
+    if (lockFileDescriptor < 0) {
+        logInfo("s7: checkout or another prefetch is in progress. Skipping prefetch.\n");
+        return S7ExitCodeSuccess;
+    }
+
+    const int exitCode = [self prefetchSubreposOfRepo:repo];
+
+    [[self class] unlockPrefetch:lockFileDescriptor];
+
+    return exitCode;
+}
+
+- (int)prefetchSubreposOfRepo:(GitRepository *)repo {
+    NSMutableOrderedSet<NSString *> *subrepoAbsolutePaths = [NSMutableOrderedSet new];
+    NSMutableArray<NSString *> *labels = [NSMutableArray new];
+    NSMutableArray<GitCloneOptions *> *cloneOptions = [NSMutableArray new];
+    [self collectSubreposOfRepo:repo
+                     pathPrefix:@""
+           subrepoAbsolutePaths:subrepoAbsolutePaths
+                  subrepoLabels:labels
+            subrepoCloneOptions:cloneOptions];
+
+    NSArray<NSString *> *paths = subrepoAbsolutePaths.array;
+
+    S7Options *options = [S7Options optionsForRepoAtPath:repo.absolutePath];
+
+    const int exitCode =
+    [S7ParallelExecutor
+     runTasksWithLabels:labels
+     errorPolicy:S7ParallelExecutionErrorPolicyAllErrors
+     maxConcurrentTasks:options.maxConcurrentJobs
+     task:^int(NSUInteger i) {
+        GitRepository *subrepoGit = [GitRepository repoAtPath:paths[i]];
+        if (nil == subrepoGit) {
+            return S7ExitCodeSubrepoIsNotGitRepository;
+        }
+
+        subrepoGit.redirectOutputToMemory = YES;
+
+        if (0 != [subrepoGit prefetchFromOriginWithCloneOptions:cloneOptions[i]]) {
+            logError("  failed to prefetch '%s':\n%s\n",
+                     labels[i].fileSystemRepresentation,
+                     [subrepoGit.lastCommandStdErrOutput cStringUsingEncoding:NSUTF8StringEncoding]);
+            return S7ExitCodeGitOperationFailed;
+        }
+
+        logInfo("  prefetched '%s'\n", labels[i].fileSystemRepresentation);
+        return S7ExitCodeSuccess;
+    }];
+
+    return exitCode;
+}
+
+// labels are paths relative to the main repo – nested subrepos included.
+// Clone options come from the repo a subrepo belongs to, as in checkout
+- (void)collectSubreposOfRepo:(GitRepository *)repo
+                   pathPrefix:(NSString *)pathPrefix
+         subrepoAbsolutePaths:(NSMutableOrderedSet<NSString *> *)subrepoAbsolutePaths
+                subrepoLabels:(NSMutableArray<NSString *> *)subrepoLabels
+          subrepoCloneOptions:(NSMutableArray<GitCloneOptions *> *)subrepoCloneOptions
+{
+    S7Options *options = [S7Options optionsForRepoAtPath:repo.absolutePath];
+
+    NSMutableArray<S7Config *> *configs = [NSMutableArray new];
+
+    // what is checked out now, and what has been checked out lately – the most probable
+    // targets of the next branch switch or pull
+    for (NSString *fileName in @[ S7ConfigFileName, S7ControlFileName ]) {
+        S7Config *config = [[S7Config alloc] initWithContentsOfFile:[repo.absolutePath stringByAppendingPathComponent:fileName]];
+        if (config) {
+            [configs addObject:config];
+        }
+    }
+
+    for (NSString *configContents in [S7ConfigJournal recentConfigContentsInRepo:repo]) {
+        S7Config *config = [S7Config configWithString:configContents];
+        if (config) {
+            [configs addObject:config];
+        }
+    }
+
+    for (S7Config *config in configs) {
+        for (S7SubrepoDescription *subrepoDesc in config.subrepoDescriptions) {
+            NSString *subrepoAbsolutePath = [repo.absolutePath stringByAppendingPathComponent:subrepoDesc.path];
+            if ([subrepoAbsolutePaths containsObject:subrepoAbsolutePath]) {
+                continue;
+            }
+
+            // subrepos that are not cloned yet have nowhere to prefetch to
+            GitRepository *subrepoGit = [GitRepository repoAtPath:subrepoAbsolutePath];
+            if (nil == subrepoGit) {
+                continue;
+            }
+
+            NSString *label = [pathPrefix stringByAppendingPathComponent:subrepoDesc.path];
+
+            [subrepoAbsolutePaths addObject:subrepoAbsolutePath];
+            [subrepoLabels addObject:label];
+            [subrepoCloneOptions addObject:[options optionsForSubrepoAtPath:subrepoDesc.path].cloneOptions];
+
+            if (isS7Repo(subrepoGit)) {
+                [self collectSubreposOfRepo:subrepoGit
+                                 pathPrefix:label
+                       subrepoAbsolutePaths:subrepoAbsolutePaths
+                              subrepoLabels:subrepoLabels
+                        subrepoCloneOptions:subrepoCloneOptions];
+            }
+        }
+    }
+}
+
+#pragma mark - lock -
+
++ (NSString *)lockFilePathInRepo:(GitRepository *)repo {
+    NSString *gitDirPath = repo.isBareRepo
+    ? repo.absolutePath
+    : [repo.absolutePath stringByAppendingPathComponent:@".git"];
+    return [gitDirPath stringByAppendingPathComponent:S7PrefetchLockFileName];
+}
+
++ (int)tryLockPrefetchInRepo:(GitRepository *)repo exclusive:(BOOL)exclusive {
+    NSString *lockFilePath = [self lockFilePathInRepo:repo];
+
+    // flock is released by the system if the process dies, so there's no stale lock to clean up
+    const int fd = open(lockFilePath.fileSystemRepresentation, O_RDONLY | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return -1;
+    }
+
+    if (0 != flock(fd, (exclusive ? LOCK_EX : LOCK_SH) | LOCK_NB)) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
++ (void)unlockPrefetch:(int)lockFileDescriptor {
+    if (lockFileDescriptor < 0) {
+        return;
+    }
+
+    flock(lockFileDescriptor, LOCK_UN);
+    close(lockFileDescriptor);
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,21 @@
+//
+//  S7PullCommand.h
+//  system7
+//
+//  Copyright © 2026 Readdle. All rights reserved.
+//
+
+#import "S7Command.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+// set for `git merge` (and thus for post-merge hook) to the resolved path of the repo whose
+// subrepos `s7 pull` has just fetched. Hook doesn't fetch them once again, if the revision
+// is there already – remote branches are as fresh as they can be.
+extern NSString * const S7PullFetchedSubreposOfRepoEnvironmentVariable;
+
+@interface S7PullCommand : NSObject <S7Command>
+
+@end
+
+NS_ASSUME_NONNULL_END
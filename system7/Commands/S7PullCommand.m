@@ -0,0 +1,204 @@
+//
+//  S7PullCommand.m
+//  system7
+//
+//  Copyright © 2026 Readdle. All rights reserved.
+//
+
+#import "S7PullCommand.h"
+
+#import "S7Utils.h"
+#import "S7HelpPager.h"
+#import "S7Options.h"
+#import "S7ParallelExecutor.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+NSString * const S7PullFetchedSubreposOfRepoEnvironmentVariable = @"S7_PULL_FETCHED_SUBREPOS_OF";
+
+@implementation S7PullCommand
+
++ (NSString *)commandName {
+    return @"pull";
+}
+
++ (NSArray<NSString *> *)aliases {
+    return @[];
+}
+
++ (void)printCommandHelp {
+    help_puts("s7 pull");
+    printCommandAliases(self);
+    help_puts("");
+    help_puts("`git pull` that fetches the main repo and subrepos at the same time");
+    help_puts("");
+    help_puts("    `git pull` fetches the main repo, merges, and only then post-merge");
+    help_puts("    hook starts fetching subrepos. `s7 pull` fetches the main repo");
+    help_puts("    together with all subrepos, then fetches subrepos that have got");
+    help_puts("    new revisions in the incoming %s, and merges the upstream", S7ConfigFileName.fileSystemRepresentation);
+    help_puts("    branch. Subrepos are then checked out without going to the network");
+    help_puts("    again (unless a new subrepo has to be cloned).");
+}
+
+- (int)runWithArguments:(NSArray<NSString *> *)arguments {
+    S7_REPO_PRECONDITION_CHECK();
+
+    if (arguments.count > 0) {
+        logError("unexpected arguments.\n");
+        [[self class] printCommandHelp];
+        return S7ExitCodeInvalidArgument;
+    }
+
+    GitRepository *repo = [GitRepository repoAtPath:@"."];
+    if (nil == repo) {
+        return S7ExitCodeNotGitRepository;
+    }
+
+    BOOL isDetachedHEAD = NO;
+    BOOL isEmptyRepo = NO;
+    NSString *currentBranch = nil;
+    if (0 != [repo getCurrentBranch:&currentBranch isDetachedHEAD:&isDetachedHEAD isEmptyRepo:&isEmptyRepo]) {
+        return S7ExitCodeGitOperationFailed;
+    }
+
+    if (isDetachedHEAD) {
+        logError("s7: cannot pull in detached HEAD state.\n");
+        return S7ExitCodeDetachedHEAD;
+    }
+
+    S7Options *options = [S7Options optionsForRepoAtPath:repo.absolutePath];
+
+    // the main repo and subrepos of what is checked out now – most of them
+    // are going to be in the incoming .s7substate as well
+    S7Config *currentConfig = [[S7Config alloc] initWithContentsOfFile:[repo.absolutePath stringByAppendingPathComponent:S7ControlFileName]];
+    if (nil == currentConfig) {
+        return S7ExitCodeFailedToParseConfig;
+    }
+
+    BOOL allSubreposFetched = YES;
+    const int fetchExitCode = [self fetchSubrepos:currentConfig.subrepoDescriptions
+                                           ofRepo:repo
+                                includingMainRepo:YES
+                                          options:options
+                               allSubreposFetched:&allSubreposFetched];
+    if (S7ExitCodeSuccess != fetchExitCode) {
+        return fetchExitCode;
+    }
+
+    S7Config *incomingConfig = nil;
+    const int getConfigExitCode = getConfig(repo, @"FETCH_HEAD", &incomingConfig);
+    if (S7ExitCodeSuccess != getConfigExitCode) {
+        return getConfigExitCode;
+    }
+
+    // subrepos that have got new revisions while we were fetching the main repo
+    NSMutableArray<S7SubrepoDescription *> *subreposToCatchUp = [NSMutableArray new];
+    for (S7SubrepoDescription *subrepoDesc in incomingConfig.subrepoDescriptions) {
+        GitRepository *subrepoGit = [GitRepository repoAtPath:[repo.absolutePath stringByAppendingPathComponent:subrepoDesc.path]];
+        if (subrepoGit && NO == [subrepoGit isRevisionAvailableLocally:subrepoDesc.revision]) {
+            [subreposToCatchUp addObject:subrepoDesc];
+        }
+    }
+
+    if (subreposToCatchUp.count > 0) {
+        BOOL allCaughtUp = YES;
+        [self fetchSubrepos:subreposToCatchUp
+                     ofRepo:repo
+          includingMainRepo:NO
+                    options:options
+         allSubreposFetched:&allCaughtUp];
+
+        allSubreposFetched = allSubreposFetched && allCaughtUp;
+    }
+
+    // if anything has failed, post-merge hook will fetch as usual
+    if (allSubreposFetched) {
+        [GitRepository setEnvironmentOverrideValue:repo.absolutePath.stringByResolvingSymlinksInPath
+                                            forKey:S7PullFetchedSubreposOfRepoEnvironmentVariable];
+    }
+
+    // merge of the upstream branch, the one that FETCH_HEAD points to
+    const int mergeExitStatus = [repo merge];
+
+    [GitRepository setEnvironmentOverrideValue:nil forKey:S7PullFetchedSubreposOfRepoEnvironmentVariable];
+
+    if (0 != mergeExitStatus) {
+        return S7ExitCodeMergeFailed;
+    }
+
+    return S7ExitCodeSuccess;
+}
+
+// failure to fetch the main repo is fatal, failure to fetch a subrepo is not – checkout will retry it
+- (int)fetchSubrepos:(NSArray<S7SubrepoDescription *> *)subrepos
+              ofRepo:(GitRepository *)repo
+   includingMainRepo:(BOOL)includingMainRepo
+             options:(S7Options *)options
+  allSubreposFetched:(BOOL *)allSubreposFetched
+{
+    NSString *repoAbsolutePath = repo.absolutePath;
+
+    NSMutableArray<NSString *> *labels = [NSMutableArray new];
+    if (includingMainRepo) {
+        [labels addObject:repoAbsolutePath.lastPathComponent];
+    }
+    const NSUInteger firstSubrepoTaskIndex = labels.count;
+    [labels addObjectsFromArray:[subrepos valueForKey:@"path"]];
+
+    __block BOOL failedToFetchSubrepo = NO;
+
+    const int exitCode =
+    [S7ParallelExecutor
+     runTasksWithLabels:labels
+     errorPolicy:S7ParallelExecutionErrorPolicyAllErrors
+     maxConcurrentTasks:options.maxConcurrentJobs
+     task:^int(NSUInteger i) {
+        if (i < firstSubrepoTaskIndex) {
+            // a separate instance, so that fetch output doesn't mix with output of other tasks
+            GitRepository *fetchGit = [GitRepository repoAtPath:repoAbsolutePath];
+            fetchGit.redirectOutputToMemory = YES;
+
+            logInfo("  fetching main repo\n");
+
+            if (0 != [fetchGit fetch]) {
+                logError("  failed to fetch main repo:\n%s\n",
+                         [fetchGit.lastCommandStdErrOutput cStringUsingEncoding:NSUTF8StringEncoding]);
+                return S7ExitCodeGitOperationFailed;
+            }
+
+            return S7ExitCodeSuccess;
+        }
+
+        S7SubrepoDescription *subrepoDesc = subrepos[i - firstSubrepoTaskIndex];
+
+        // not cloned yet – post-merge hook will clone it
+        GitRepository *subrepoGit = [GitRepository repoAtPath:[repoAbsolutePath stringByAppendingPathComponent:subrepoDesc.path]];
+        if (nil == subrepoGit) {
+            return S7ExitCodeSuccess;
+        }
+
+        subrepoGit.redirectOutputToMemory = YES;
+
+        logInfo("  fetching '%s'\n", subrepoDesc.path.fileSystemRepresentation);
+
+        GitCloneOptions *cloneOptions = [options optionsForSubrepoAtPath:subrepoDesc.path].cloneOptions;
+        if (0 != [subrepoGit fetchWithCloneOptions:cloneOptions]) {
+            logError("  failed to fetch '%s':\n%s\n",
+                     subrepoDesc.path.fileSystemRepresentation,
+                     [subrepoGit.lastCommandStdErrOutput cStringUsingEncoding:NSUTF8StringEncoding]);
+            @synchronized (self) {
+                failedToFetchSubrepo = YES;
+            }
+        }
+
+        return S7ExitCodeSuccess;
+    }];
+
+    *allSubreposFetched = (NO == failedToFetchSubrepo);
+
+    return exitCode;
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -10,6 +10,7 @@
 #import "S7Config.h"
 #import "Git.h"
 #import "S7HelpPager.h"
+#import "S7ParallelExecutor.h"
 
 @implementation S7RebindCommand
 
@@ -78,16 +79,23 @@
         subreposToRebindPaths = [parsedConfig.subrepoPathsSet mutableCopy];
     }
 
-    NSMutableArray<S7SubrepoDescription *> *newConfigSubrepoDescriptions = [[NSMutableArray alloc] initWithCapacity:parsedConfig.subrepoDescriptions.count];
-
-    NSMutableArray<NSString *> *reboundSubrepoPaths = [NSMutableArray arrayWithCapacity:subreposToRebindPaths.count];
-
-    for (S7SubrepoDescription *subrepoDescription in parsedConfig.subrepoDescriptions) {
+    NSArray<S7SubrepoDescription *> *subrepoDescriptions = parsedConfig.subrepoDescriptions;
+    NSMutableArray<S7SubrepoDescription *> *newConfigSubrepoDescriptions = [subrepoDescriptions mutableCopy];
+    NSMutableIndexSet *reboundSubrepoIndices = [NSMutableIndexSet new];
+
+    // reading HEAD and resolving branch is a couple of git calls per subrepo.
+    // With several dozens of subrepos, doing this one by one takes noticeable time.
+    //
+    const int rebindExitCode =
+    [S7ParallelExecutor
+     runTasks:subrepoDescriptions.count
+     errorPolicy:S7ParallelExecutionErrorPolicyFirstError
+     task:^int(NSUInteger i) {
+        S7SubrepoDescription *subrepoDescription = subrepoDescriptions[i];
         NSString *const subrepoPath = subrepoDescription.path;
 
         if (NO == [subreposToRebindPaths containsObject:subrepoPath]) {
-            [newConfigSubrepoDescriptions addObject:subrepoDescription];
-            continue;
+            return S7ExitCodeSuccess;
         }
 
         logInfo("checking subrepo '%s'... ", [subrepoPath fileSystemRepresentation]);
@@ -138,18 +146,27 @@
 
         if ([updatedSubrepoDescription isEqual:subrepoDescription]) {
             logInfo("up to date.\n");
-            [newConfigSubrepoDescriptions addObject:subrepoDescription];
-            continue;
+            return S7ExitCodeSuccess;
         }
 
         logInfo("detected an update:\n");
         logInfo(" old state %s\n", [subrepoDescription.humanReadableRevisionAndBranchState cStringUsingEncoding:NSUTF8StringEncoding]);
         logInfo(" new state %s\n", [updatedSubrepoDescription.humanReadableRevisionAndBranchState cStringUsingEncoding:NSUTF8StringEncoding]);
 
-        [reboundSubrepoPaths addObject:updatedSubrepoDescription.path];
-        [newConfigSubrepoDescriptions addObject:updatedSubrepoDescription];
+        @synchronized (newConfigSubrepoDescriptions) {
+            newConfigSubrepoDescriptions[i] = updatedSubrepoDescription;
+            [reboundSubrepoIndices addIndex:i];
+        }
+
+        return S7ExitCodeSuccess;
+    }];
+
+    if (S7ExitCodeSuccess != rebindExitCode) {
+        return rebindExitCode;
     }
 
+    NSArray<NSString *> *reboundSubrepoPaths = [[newConfigSubrepoDescriptions objectsAtIndexes:reboundSubrepoIndices] valueForKey:@"path"];
+
     if ([newConfigSubrepoDescriptions isEqual:parsedConfig.subrepoDescriptions]) {
         logInfo("(seems like there's nothing to rebind)\n");
         return S7ExitCodeSuccess;
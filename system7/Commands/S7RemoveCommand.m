@@ -8,6 +8,7 @@
 
 #import "S7RemoveCommand.h"
 #import "S7HelpPager.h"
+#import "S7ParallelExecutor.h"
 
 @implementation S7RemoveCommand
 
@@ -42,10 +43,9 @@
     S7Config *parsedConfig = [[S7Config alloc] initWithContentsOfFile:S7ConfigFileName];
 
     NSMutableArray<S7SubrepoDescription *> *newDescriptionsArray = [parsedConfig.subrepoDescriptions mutableCopy];
-    NSMutableSet<NSString *> *pathsToRemoveFromGitignore = [NSMutableSet new];
+    NSMutableArray<NSString *> *pathsToRemove = [NSMutableArray new];
 
     BOOL force = NO;
-    BOOL anySubrepoHadLocalChanges = NO;
     for (NSString *argument in arguments) {
         if ([argument isEqualToString:@"-f"] || [argument isEqualToString:@"--force"]) {
             force = YES;
@@ -60,52 +60,73 @@
         }
 
         [newDescriptionsArray removeObject:subrepoDesc];
+        [pathsToRemove addObject:path];
+    }
 
-        if ([NSFileManager.defaultManager fileExistsAtPath:path]) {
-            BOOL canRemoveSubrepoDirectory = YES;
-            GitRepository *subrepoGit = [GitRepository repoAtPath:path];
-            if (subrepoGit && NO == force) {
-                const BOOL hasUnpushedCommits = [subrepoGit hasUnpushedCommits];
-                const BOOL hasUncommitedChanges = [subrepoGit hasUncommitedChanges];
-                if (hasUncommitedChanges || hasUnpushedCommits) {
-                    anySubrepoHadLocalChanges = YES;
-
-                    const char *reason = NULL;
-                    if (hasUncommitedChanges && hasUnpushedCommits) {
-                        reason = "uncommitted and not pushed changes";
-                    }
-                    else if (hasUncommitedChanges) {
-                        reason = "uncommitted changes";
-                    }
-                    else {
-                        reason = "not pushed changes";
-                    }
+    __block BOOL anySubrepoHadLocalChanges = NO;
 
-                    NSAssert(reason, @"");
+    // checking for unpushed commits and uncommitted changes is a couple of
+    // relatively heavy git calls per subrepo, so we do that for all subrepos at once
+    //
+    const int removeExitCode =
+    [S7ParallelExecutor
+     runTasks:pathsToRemove.count
+     errorPolicy:S7ParallelExecutionErrorPolicyAllErrors
+     task:^int(NSUInteger i) {
+        NSString *path = pathsToRemove[i];
 
-                    logError("⚠️  not removing repo '%s' directory because it has %s.\n",
-                             path.fileSystemRepresentation,
-                             reason);
+        if (NO == [NSFileManager.defaultManager fileExistsAtPath:path]) {
+            return S7ExitCodeSuccess;
+        }
 
-                    canRemoveSubrepoDirectory = NO;
+        GitRepository *subrepoGit = [GitRepository repoAtPath:path];
+        if (subrepoGit && NO == force) {
+            const BOOL hasUnpushedCommits = [subrepoGit hasUnpushedCommits];
+            const BOOL hasUncommitedChanges = [subrepoGit hasUncommitedChanges];
+            if (hasUncommitedChanges || hasUnpushedCommits) {
+                @synchronized (pathsToRemove) {
+                    anySubrepoHadLocalChanges = YES;
                 }
-            }
 
-            if (canRemoveSubrepoDirectory) {
-                NSError *error = nil;
-                if (NO == [NSFileManager.defaultManager removeItemAtPath:path error:&error]) {
-                    logError("failed to remove subrepo '%s' directory\n"
-                             "error: %s\n",
-                            [path fileSystemRepresentation],
-                            [error.description cStringUsingEncoding:NSUTF8StringEncoding]);
-                    return S7ExitCodeFileOperationFailed;
+                const char *reason = NULL;
+                if (hasUncommitedChanges && hasUnpushedCommits) {
+                    reason = "uncommitted and not pushed changes";
+                }
+                else if (hasUncommitedChanges) {
+                    reason = "uncommitted changes";
+                }
+                else {
+                    reason = "not pushed changes";
                 }
+
+                NSAssert(reason, @"");
+
+                logError("⚠️  not removing repo '%s' directory because it has %s.\n",
+                         path.fileSystemRepresentation,
+                         reason);
+
+                return S7ExitCodeSuccess;
             }
         }
 
-        [pathsToRemoveFromGitignore addObject:path];
+        NSError *error = nil;
+        if (NO == [NSFileManager.defaultManager removeItemAtPath:path error:&error]) {
+            logError("failed to remove subrepo '%s' directory\n"
+                     "error: %s\n",
+                    [path fileSystemRepresentation],
+                    [error.description cStringUsingEncoding:NSUTF8StringEncoding]);
+            return S7ExitCodeFileOperationFailed;
+        }
+
+        return S7ExitCodeSuccess;
+    }];
+
+    if (S7ExitCodeSuccess != removeExitCode) {
+        return removeExitCode;
     }
 
+    NSSet<NSString *> *pathsToRemoveFromGitignore = [NSSet setWithArray:pathsToRemove];
+
     S7Config *newConfig = [[S7Config alloc] initWithSubrepoDescriptions:newDescriptionsArray];
 
     SAVE_UPDATED_CONFIG_TO_MAIN_AND_CONTROL_FILE(newConfig);
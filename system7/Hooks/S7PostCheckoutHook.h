@@ -27,6 +27,9 @@ NS_ASSUME_NONNULL_BEGIN
                       toConfig:(S7Config *)toConfig
                          clean:(BOOL)clean;
 
+// removed subrepos are renamed into this dir and deleted by a background process
++ (NSString *)trashDirectoryPathInRepoAtPath:(NSString *)repoAbsolutePath;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -13,12 +13,44 @@
 #import "S7InitCommand.h"
 #import "S7DeinitCommand.h"
 #import "S7BootstrapCommand.h"
+#import "S7BundleCommand.h"
+#import "S7PrefetchCommand.h"
+#import "S7PullCommand.h"
 #import "S7SubrepoDescriptionConflict.h"
 #import "S7Options.h"
 #import "S7Logging.h"
+#import "S7ParallelExecutor.h"
+
+typedef NS_ENUM(NSUInteger, S7SubrepoMigrationResult) {
+    // origin points to the new url, and the pinned revision is available locally
+    S7SubrepoMigrationResultMigrated,
+    // nothing of value is in the subrepo, but it can't be reused – remove and clone anew
+    S7SubrepoMigrationResultNeedsReclone,
+    // subrepo has work that would be lost with it – leave it alone
+    S7SubrepoMigrationResultRefused,
+};
 
 static void (^_warnAboutDetachingCommitsHook)(NSString *topRevision, int numberOfCommits) = nil;
 
+// set for every git command (and thus for nested s7 hooks) while subrepos are being checked out
+// with `lfs = deferred`. Whoever checks out subrepos under this variable must fetch their LFS content.
+static NSString * const S7LFSDeferredEnvironmentVariable = @"S7_LFS_DEFERRED";
+static NSString * const GitLFSSkipSmudgeEnvironmentVariable = @"GIT_LFS_SKIP_SMUDGE";
+
+static NSString * _Nullable environmentVariableValue(NSString *name) {
+    NSString *value = [GitRepository environmentOverrideValueForKey:name];
+    if (nil == value) {
+        value = NSProcessInfo.processInfo.environment[name];
+    }
+
+    return value;
+}
+
+static BOOL isEnvironmentVariableSet(NSString *name) {
+    NSString *value = environmentVariableValue(name);
+    return value.length > 0 && NO == [value isEqualToString:@"0"];
+}
+
 @implementation S7PostCheckoutHook
 
 + (NSString *)gitHookName {
@@ -169,6 +201,10 @@ static void (^_warnAboutDetachingCommitsHook)(NSString *topRevision, int numberO
                       toConfig:(S7Config *)toConfig
                          clean:(BOOL)clean
 {
+    // tells `s7 prefetch` to stay away while we work with subrepos. If prefetch is running
+    // already, we don't wait for it – it only touches its own refs
+    const int prefetchLockFileDescriptor = [S7PrefetchCommand tryLockPrefetchInRepo:repo exclusive:NO];
+
     NSDictionary<NSString *, S7SubrepoDescription *> *subreposToDelete = nil;
     NSDictionary<NSString *, S7SubrepoDescription *> *dummy = nil;
     diffConfigs(fromConfig,
@@ -273,23 +309,56 @@ static void (^_warnAboutDetachingCommitsHook)(NSString *topRevision, int numberO
         }
     }
 
-    __auto_type recordFailingExitCode = ^(int operationExitCode) {
-        NSCAssert(S7ExitCodeSuccess != operationExitCode, @"please, send only failures here!");
-        if (S7ExitCodeSuccess != operationExitCode) {
-            @synchronized (self) {
-                exitCode = operationExitCode;
-            }
-        }
-    };
-
     NSMutableArray<GitRepository *> *subreposToInit = [NSMutableArray new];
 
-    dispatch_apply(subreposToCheckout.count, DISPATCH_APPLY_AUTO, ^(size_t i) {
+    // options are resolved once per repo – not in every task. Nested s7 subrepos
+    // get their own options, when we recurse into them.
+    S7Options *options = [S7Options optionsForRepoAtPath:repo.absolutePath];
+
+    // With `lfs = deferred`, subrepos are checked out with LFS smudge skipped – Git leaves
+    // pointer files instead of downloading every LFS file one by one, subrepo after subrepo.
+    // Once all subrepos are in place, we download LFS content of those that have changed
+    // in one parallel pass.
+    //
+    // If user has set GIT_LFS_SKIP_SMUDGE themselves, they don't want LFS content at all.
+    //
+    BOOL deferLFS = isEnvironmentVariableSet(S7LFSDeferredEnvironmentVariable);
+    BOOL shouldStopDeferringLFS = NO;
+    if (NO == deferLFS
+        && options.lfsDeferred.boolValue
+        && NO == isEnvironmentVariableSet(GitLFSSkipSmudgeEnvironmentVariable))
+    {
+        [GitRepository setEnvironmentOverrideValue:@"1" forKey:GitLFSSkipSmudgeEnvironmentVariable];
+        [GitRepository setEnvironmentOverrideValue:@"1" forKey:S7LFSDeferredEnvironmentVariable];
+        deferLFS = YES;
+        shouldStopDeferringLFS = YES;
+    }
+
+    NSMutableArray<S7SubrepoDescription *> *subreposWithDeferredLFS = [NSMutableArray new];
 
+    // `s7 pull` has fetched subrepos of this very repo right before the merge. Nested
+    // s7 subrepos were not fetched, so they go the usual way
+    NSString *pullFetchedRepoPath = environmentVariableValue(S7PullFetchedSubreposOfRepoEnvironmentVariable);
+    const BOOL subreposFetchedByPull = [pullFetchedRepoPath isEqualToString:repo.absolutePath.stringByResolvingSymlinksInPath];
+
+    // subrepo paths are used as labels – if user watches a long checkout in Terminal,
+    // then every line tells which subrepo it's about
+    NSArray<NSString *> *subrepoPathsToCheckout = [subreposToCheckout valueForKey:@"path"];
+
+    const int subreposCheckoutExitCode =
+    [S7ParallelExecutor
+     runTasksWithLabels:subrepoPathsToCheckout
+     errorPolicy:S7ParallelExecutionErrorPolicyAllErrors
+     maxConcurrentTasks:options.maxConcurrentJobs
+     task:^int(NSUInteger i) {
         S7SubrepoDescription *subrepoDesc = subreposToCheckout[i];
         NSString *subrepoAbsolutePath = [repo.absolutePath stringByAppendingPathComponent:subrepoDesc.path];
 
-        GitRepository *subrepoGit = subrepoDescToGit[subrepoDesc];
+        // tasks run in parallel, so subrepoDescToGit is guarded by the same lock as subreposToInit
+        GitRepository *subrepoGit = nil;
+        @synchronized (self) {
+            subrepoGit = subrepoDescToGit[subrepoDesc];
+        }
 
         logInfo("\033[34m>\033[0m \033[1mchecking out subrepo '%s'\033[0m\n",
                 [subrepoDesc.path fileSystemRepresentation]);
@@ -302,9 +371,7 @@ static void (^_warnAboutDetachingCommitsHook)(NSString *topRevision, int numberO
                                                         urlChanged:&subrepoUrlChanged
                                                             oldUrl:&oldUrl];
             if (S7ExitCodeSuccess != checkExitCode) {
-                recordFailingExitCode(checkExitCode);
-
-                return;
+                return checkExitCode;
             }
 
             if (subrepoUrlChanged) {
@@ -315,46 +382,64 @@ static void (^_warnAboutDetachingCommitsHook)(NSString *topRevision, int numberO
                 //
                 logInfo("  detected that subrepo '%s' has migrated:\n"
                         "   from '%s'\n"
-                        "   to '%s'\n"
-                        "   removing an old version...\n",
+                        "   to '%s'\n",
                         [subrepoDesc.path fileSystemRepresentation],
                         [oldUrl cStringUsingEncoding:NSUTF8StringEncoding],
                         [subrepoDesc.url cStringUsingEncoding:NSUTF8StringEncoding]);
 
-                NSError *error = nil;
-                if (NO == [NSFileManager.defaultManager removeItemAtPath:subrepoAbsolutePath
-                                                                   error:&error])
-                {
-                    logError("failed to remove old version of '%s' from disk. Error: %s\n",
-                             subrepoDesc.path.fileSystemRepresentation,
-                             [[error description] cStringUsingEncoding:NSUTF8StringEncoding]);
+                const S7SubrepoMigrationResult migrationResult = [self tryMigratingSubrepo:subrepoDesc
+                                                                                subrepoGit:subrepoGit
+                                                                                    oldUrl:oldUrl
+                                                                                   options:options
+                                                                                     clean:clean];
+                if (S7SubrepoMigrationResultRefused == migrationResult) {
+                    return S7ExitCodeSubrepoHasLocalChanges;
+                }
 
-                    recordFailingExitCode(S7ExitCodeFileOperationFailed);
+                if (S7SubrepoMigrationResultNeedsReclone == migrationResult) {
+                    logInfo("   removing an old version...\n");
 
-                    return;
-                }
+                    NSError *error = nil;
+                    if (NO == [NSFileManager.defaultManager removeItemAtPath:subrepoAbsolutePath
+                                                                       error:&error])
+                    {
+                        logError("failed to remove old version of '%s' from disk. Error: %s\n",
+                                 subrepoDesc.path.fileSystemRepresentation,
+                                 [[error description] cStringUsingEncoding:NSUTF8StringEncoding]);
 
-                subrepoGit = nil;
-                subrepoDescToGit[subrepoDesc] = nil;
+                        return S7ExitCodeFileOperationFailed;
+                    }
+
+                    subrepoGit = nil;
+                    @synchronized (self) {
+                        subrepoDescToGit[subrepoDesc] = nil;
+                    }
+                }
             }
         }
 
+        NSString *revisionBeforeCheckout = nil;
+        if (subrepoGit) {
+            [subrepoGit getCurrentRevision:&revisionBeforeCheckout];
+        }
+
         if (nil == subrepoGit) {
             const int cloneExitCode = [self cloneSubrepo:subrepoDesc
                                   parentRepoAbsolutePath:repo.absolutePath
+                                                 options:options
                                               subrepoGit:&subrepoGit];
             if (S7ExitCodeSuccess != cloneExitCode) {
-                recordFailingExitCode(cloneExitCode);
-
-                return;
+                return cloneExitCode;
             }
 
             NSAssert(subrepoGit, @"");
 
-            subrepoDescToGit[subrepoDesc] = subrepoGit;
+            const BOOL hasS7Config = [NSFileManager.defaultManager fileExistsAtPath:[subrepoAbsolutePath stringByAppendingPathComponent:S7ConfigFileName]];
 
-            if ([NSFileManager.defaultManager fileExistsAtPath:[subrepoAbsolutePath stringByAppendingPathComponent:S7ConfigFileName]]) {
-                @synchronized (self) {
+            @synchronized (self) {
+                subrepoDescToGit[subrepoDesc] = subrepoGit;
+
+                if (hasS7Config) {
                     [subreposToInit addObject:subrepoGit];
                 }
             }
@@ -363,12 +448,12 @@ static void (^_warnAboutDetachingCommitsHook)(NSString *topRevision, int numberO
         BOOL shouldInitSubrepo = NO;
         const S7ExitCode checkoutExitCode = [self ensureSubrepoInTheRightState:subrepoDesc
                                                                     subrepoGit:subrepoGit
+                                                                       options:options
                                                                          clean:clean
+                                                         subrepoFetchedByPull:subreposFetchedByPull
                                                              shouldInitSubrepo:&shouldInitSubrepo];
         if (S7ExitCodeSuccess != checkoutExitCode) {
-            recordFailingExitCode(checkoutExitCode);
-
-            return;
+            return checkoutExitCode;
         }
 
         if (shouldInitSubrepo) {
@@ -376,7 +461,37 @@ static void (^_warnAboutDetachingCommitsHook)(NSString *topRevision, int numberO
                 [subreposToInit addObject:subrepoGit];
             }
         }
-    });
+
+        if (deferLFS) {
+            NSString *revisionAfterCheckout = nil;
+            [subrepoGit getCurrentRevision:&revisionAfterCheckout];
+            if (NO == [revisionAfterCheckout isEqualToString:revisionBeforeCheckout]) {
+                @synchronized (self) {
+                    [subreposWithDeferredLFS addObject:subrepoDesc];
+                }
+            }
+        }
+
+        return S7ExitCodeSuccess;
+    }];
+
+    if (S7ExitCodeSuccess != subreposCheckoutExitCode) {
+        exitCode = subreposCheckoutExitCode;
+    }
+
+    if (shouldStopDeferringLFS) {
+        [GitRepository setEnvironmentOverrideValue:nil forKey:GitLFSSkipSmudgeEnvironmentVariable];
+        [GitRepository setEnvironmentOverrideValue:nil forKey:S7LFSDeferredEnvironmentVariable];
+    }
+
+    if (subreposWithDeferredLFS.count > 0) {
+        const int lfsExitCode = [self checkoutDeferredLFSContentOfSubrepos:subreposWithDeferredLFS
+                                                          subrepoDescToGit:subrepoDescToGit
+                                                        maxConcurrentTasks:options.maxConcurrentJobs];
+        if (S7ExitCodeSuccess != lfsExitCode) {
+            exitCode = lfsExitCode;
+        }
+    }
 
     const S7ExitCode initExitCode = [self initS7InSubrepos:subreposToInit];
     if (S7ExitCodeSuccess != initExitCode) {
@@ -414,6 +529,94 @@ static void (^_warnAboutDetachingCommitsHook)(NSString *topRevision, int numberO
         }
     }
 
+    [S7PrefetchCommand unlockPrefetch:prefetchLockFileDescriptor];
+
+    return exitCode;
+}
+
++ (int)checkoutDeferredLFSContentOfSubrepos:(NSArray<S7SubrepoDescription *> *)subrepos
+                            subrepoDescToGit:(NSDictionary<S7SubrepoDescription *, GitRepository *> *)subrepoDescToGit
+                          maxConcurrentTasks:(NSUInteger)maxConcurrentTasks
+{
+    NSMutableArray<S7SubrepoDescription *> *lfsSubrepos = [NSMutableArray new];
+    for (S7SubrepoDescription *subrepoDesc in subrepos) {
+        if ([subrepoDescToGit[subrepoDesc] isGitLFSRepo]) {
+            [lfsSubrepos addObject:subrepoDesc];
+        }
+    }
+
+    if (0 == lfsSubrepos.count) {
+        return S7ExitCodeSuccess;
+    }
+
+    logInfo("\033[34m>\033[0m \033[1mfetching LFS content of %lu subrepo(s)\033[0m\n",
+            (unsigned long)lfsSubrepos.count);
+
+    __block unsigned long long totalBytesFetched = 0;
+    __block NSUInteger numberOfCompletedSubrepos = 0;
+    NSMutableArray<S7SubrepoDescription *> *failedSubrepos = [NSMutableArray new];
+
+    const int exitCode =
+    [S7ParallelExecutor
+     runTasksWithLabels:[lfsSubrepos valueForKey:@"path"]
+     errorPolicy:S7ParallelExecutionErrorPolicyAllErrors
+     maxConcurrentTasks:maxConcurrentTasks
+     task:^int(NSUInteger i) {
+        S7SubrepoDescription *subrepoDesc = lfsSubrepos[i];
+        GitRepository *subrepoGit = subrepoDescToGit[subrepoDesc];
+
+        const unsigned long long sizeBeforeFetch = [subrepoGit sizeOfLocalGitLFSObjects];
+
+        if (0 != [subrepoGit fetchGitLFSObjects] || 0 != [subrepoGit checkoutGitLFSFiles]) {
+            logError("  failed to fetch LFS content of '%s':\n%s\n\n",
+                     [subrepoDesc.path fileSystemRepresentation],
+                     [subrepoGit.lastCommandStdErrOutput cStringUsingEncoding:NSUTF8StringEncoding]);
+
+            @synchronized (self) {
+                [failedSubrepos addObject:subrepoDesc];
+            }
+
+            return S7ExitCodeGitOperationFailed;
+        }
+
+        const unsigned long long sizeAfterFetch = [subrepoGit sizeOfLocalGitLFSObjects];
+        const unsigned long long bytesFetched = sizeAfterFetch > sizeBeforeFetch ? sizeAfterFetch - sizeBeforeFetch : 0;
+
+        NSUInteger completedSubrepoNumber = 0;
+        @synchronized (self) {
+            totalBytesFetched += bytesFetched;
+            completedSubrepoNumber = ++numberOfCompletedSubrepos;
+        }
+
+        logInfo("  [%lu/%lu] checked out LFS content of '%s' (%s fetched)\n",
+                (unsigned long)completedSubrepoNumber,
+                (unsigned long)lfsSubrepos.count,
+                [subrepoDesc.path fileSystemRepresentation],
+                [[NSByteCountFormatter stringFromByteCount:(long long)bytesFetched
+                                                countStyle:NSByteCountFormatterCountStyleFile]
+                 cStringUsingEncoding:NSUTF8StringEncoding]);
+
+        return S7ExitCodeSuccess;
+    }];
+
+    logInfo("  fetched %s of LFS content\n",
+            [[NSByteCountFormatter stringFromByteCount:(long long)totalBytesFetched
+                                            countStyle:NSByteCountFormatterCountStyleFile]
+             cStringUsingEncoding:NSUTF8StringEncoding]);
+
+    if (failedSubrepos.count > 0) {
+        logError("\n"
+                 "  Subrepos left with LFS pointer files instead of content:\n\n");
+
+        for (S7SubrepoDescription *subrepoDesc in failedSubrepos) {
+            logError("    %s\n", [subrepoDesc.path fileSystemRepresentation]);
+        }
+
+        logError("\n"
+                 "  Run `git lfs pull` in each of them once the problem is fixed.\n"
+                 "\n");
+    }
+
     return exitCode;
 }
 
@@ -459,57 +662,136 @@ static void (^_warnAboutDetachingCommitsHook)(NSString *topRevision, int numberO
     return exitCode;
 }
 
++ (NSString *)trashDirectoryPathInRepoAtPath:(NSString *)repoAbsolutePath {
+    return [repoAbsolutePath stringByAppendingPathComponent:@".git/s7-trash"];
+}
+
 + (int)deleteSubrepos:(NSArray<S7SubrepoDescription *> *)subreposToDelete
     parentRepoAbsolutePath:(NSString *)parentRepoAbsolutePath
 {
-    int exitCode = S7ExitCodeSuccess;
-    for (S7SubrepoDescription *subrepoToDelete in subreposToDelete) {
-        NSString *subrepoRelativePath = subrepoToDelete.path;
+    // checks spawn a couple of git processes per subrepo – that's what took the time
+    // when someone switched to a branch without a dozen of subrepos
+    NSMutableIndexSet *indicesOfSubreposToRemove = [NSMutableIndexSet new];
+    [S7ParallelExecutor
+     runTasksWithLabels:[subreposToDelete valueForKey:@"path"]
+     errorPolicy:S7ParallelExecutionErrorPolicyAllErrors
+     maxConcurrentTasks:[S7Options optionsForRepoAtPath:parentRepoAbsolutePath].maxConcurrentJobs
+     task:^int(NSUInteger i) {
+        NSString *subrepoRelativePath = subreposToDelete[i].path;
         NSString *subrepoAbsolutePath = [parentRepoAbsolutePath stringByAppendingPathComponent:subrepoRelativePath];
 
         BOOL isDirectory = NO;
-        if ([NSFileManager.defaultManager fileExistsAtPath:subrepoAbsolutePath isDirectory:&isDirectory] && isDirectory) {
-            GitRepository *subrepoGit = [GitRepository repoAtPath:subrepoAbsolutePath];
-            if (subrepoGit) {
-                const BOOL hasUnpushedCommits = [subrepoGit hasUnpushedCommits];
-                const BOOL hasUncommitedChanges = [subrepoGit hasUncommitedChanges];
-                if (hasUncommitedChanges || hasUnpushedCommits) {
-                    const char *reason = NULL;
-                    if (hasUncommitedChanges && hasUnpushedCommits) {
-                        reason = "uncommitted and not pushed changes";
-                    }
-                    else if (hasUncommitedChanges) {
-                        reason = "uncommitted changes";
-                    }
-                    else {
-                        reason = "not pushed changes";
-                    }
-
-                    NSAssert(reason, @"");
+        if (NO == [NSFileManager.defaultManager fileExistsAtPath:subrepoAbsolutePath isDirectory:&isDirectory] || NO == isDirectory) {
+            return S7ExitCodeSuccess;
+        }
 
-                    logError("  not removing repo '%s' because it has %s.\n",
-                             subrepoRelativePath.fileSystemRepresentation,
-                             reason);
-                    continue;
+        GitRepository *subrepoGit = [GitRepository repoAtPath:subrepoAbsolutePath];
+        if (subrepoGit) {
+            const BOOL hasUnpushedCommits = [subrepoGit hasUnpushedCommits];
+            const BOOL hasUncommitedChanges = [subrepoGit hasUncommitedChanges];
+            if (hasUncommitedChanges || hasUnpushedCommits) {
+                const char *reason = NULL;
+                if (hasUncommitedChanges && hasUnpushedCommits) {
+                    reason = "uncommitted and not pushed changes";
+                }
+                else if (hasUncommitedChanges) {
+                    reason = "uncommitted changes";
+                }
+                else {
+                    reason = "not pushed changes";
                 }
+
+                NSAssert(reason, @"");
+
+                logError("  not removing repo '%s' because it has %s.\n",
+                         subrepoRelativePath.fileSystemRepresentation,
+                         reason);
+                return S7ExitCodeSuccess;
             }
+        }
+
+        @synchronized (indicesOfSubreposToRemove) {
+            [indicesOfSubreposToRemove addIndex:i];
+        }
+
+        return S7ExitCodeSuccess;
+    }];
 
-            logInfo("\033[31m>\033[0m \033[1mremoving subrepo '%s'\033[0m\n", subrepoRelativePath.fileSystemRepresentation);
+    // removal of a big subrepo may take longer than the whole checkout. We just move it
+    // out of the way (rename within one file system is instant) and let a background
+    // process finish the job
+    NSString *trashDirectoryPath = [self trashDirectoryPathInRepoAtPath:parentRepoAbsolutePath];
 
-            NSError *error = nil;
-            if (NO == [NSFileManager.defaultManager removeItemAtPath:subrepoAbsolutePath error:&error]) {
-                logError(" abort: failed to remove subrepo '%s' directory\n"
-                         " error: %s\n",
-                         [subrepoRelativePath fileSystemRepresentation],
-                         [error.description cStringUsingEncoding:NSUTF8StringEncoding]);
-                exitCode = S7ExitCodeFileOperationFailed;
+    __block int exitCode = S7ExitCodeSuccess;
+    [indicesOfSubreposToRemove enumerateIndexesUsingBlock:^(NSUInteger i, BOOL * _Nonnull stop) {
+        NSString *subrepoRelativePath = subreposToDelete[i].path;
+        NSString *subrepoAbsolutePath = [parentRepoAbsolutePath stringByAppendingPathComponent:subrepoRelativePath];
+
+        logInfo("\033[31m>\033[0m \033[1mremoving subrepo '%s'\033[0m\n", subrepoRelativePath.fileSystemRepresentation);
+
+        NSString *trashedSubrepoPath = [trashDirectoryPath stringByAppendingPathComponent:
+                                        [NSString stringWithFormat:@"%@-%@",
+                                         NSUUID.UUID.UUIDString,
+                                         subrepoRelativePath.lastPathComponent]];
+
+        // .git may be a file (worktree) or the subrepo may live on another volume.
+        // Remove it the old way then
+        if ([NSFileManager.defaultManager createDirectoryAtPath:trashDirectoryPath withIntermediateDirectories:NO attributes:nil error:nil]
+            || [NSFileManager.defaultManager fileExistsAtPath:trashDirectoryPath])
+        {
+            if (0 == rename(subrepoAbsolutePath.fileSystemRepresentation, trashedSubrepoPath.fileSystemRepresentation)) {
+                return;
             }
         }
-    }
+
+        NSError *error = nil;
+        if (NO == [NSFileManager.defaultManager removeItemAtPath:subrepoAbsolutePath error:&error]) {
+            logError(" abort: failed to remove subrepo '%s' directory\n"
+                     " error: %s\n",
+                     [subrepoRelativePath fileSystemRepresentation],
+                     [error.description cStringUsingEncoding:NSUTF8StringEncoding]);
+            exitCode = S7ExitCodeFileOperationFailed;
+        }
+    }];
+
+    // also picks up whatever previous reaper has not finished (if it was killed, or machine rebooted)
+    [self reapTrashInRepoAtPath:parentRepoAbsolutePath];
 
     return exitCode;
 }
 
++ (void)reapTrashInRepoAtPath:(NSString *)repoAbsolutePath {
+    NSString *trashDirectoryPath = [self trashDirectoryPathInRepoAtPath:repoAbsolutePath];
+
+    // not the trash dir itself – another checkout may be moving something into it right now
+    NSArray<NSString *> *trashedItems = [NSFileManager.defaultManager contentsOfDirectoryAtPath:trashDirectoryPath error:nil];
+    if (0 == trashedItems.count) {
+        return;
+    }
+
+    NSMutableArray<NSString *> *arguments = [NSMutableArray arrayWithObjects:@"-rf", @"--", nil];
+    for (NSString *item in trashedItems) {
+        [arguments addObject:[trashDirectoryPath stringByAppendingPathComponent:item]];
+    }
+
+    // we don't wait for it. Nobody is waiting for the output either, thus /dev/null –
+    // git (or a GUI client) would otherwise wait till the pipe we've inherited gets closed
+    NSTask *task = [NSTask new];
+    task.launchPath = @"/bin/rm";
+    task.arguments = arguments;
+    task.qualityOfService = NSQualityOfServiceBackground;
+    task.standardInput = NSFileHandle.fileHandleWithNullDevice;
+    task.standardOutput = NSFileHandle.fileHandleWithNullDevice;
+    task.standardError = NSFileHandle.fileHandleWithNullDevice;
+
+    NSError *error = nil;
+    if (NO == [task launchAndReturnError:&error]) {
+        logError("failed to start removal of old subrepos in '%s'. Error: %s\n",
+                 trashDirectoryPath.fileSystemRepresentation,
+                 [error.description cStringUsingEncoding:NSUTF8StringEncoding]);
+    }
+}
+
 + (int)getGitRepositoriesForSubrepoDescriptions:(NSArray<S7SubrepoDescription *> *)subrepoDescriptions
                                subrepoDescToGit:(NSMutableDictionary<S7SubrepoDescription *, GitRepository *> **)ppSubrepoDescToGit
               corruptedSubrepoRepositoryIndices:(NSIndexSet **)ppCorruptedSubrepoRepositoryIndices
@@ -626,9 +908,80 @@ static void (^_warnAboutDetachingCommitsHook)(NSString *topRevision, int numberO
     return S7ExitCodeSuccess;
 }
 
+// A fork shares almost all history with the repo it was forked from, so instead of
+// throwing away gigabytes of objects and cloning them again, we re-point origin to the new
+// url and fetch only what's missing. ensureSubrepoInTheRightState: then creates the branch
+// at the pinned revision as usual.
+//
+// Refuses to touch the subrepo if it has work that is not in the old remote – neither
+// re-pointing, nor re-cloning must lose it. Otherwise, asks for a re-clone if the new
+// remote doesn't have the pinned revision, or it's a different repo altogether.
+//
++ (S7SubrepoMigrationResult)tryMigratingSubrepo:(S7SubrepoDescription *)subrepoDesc
+                                     subrepoGit:(GitRepository *)subrepoGit
+                                         oldUrl:(NSString *)oldUrl
+                                        options:(S7Options *)parentRepoOptions
+                                          clean:(BOOL)clean
+{
+    // uncommitted changes have been checked for every subrepo before we got here,
+    // so we can meet them only on `clean` checkout, which discards them anyway
+    if (NO == clean && [subrepoGit hasUncommitedChanges]) {
+        logError("subrepo '%s' has migrated to a different url, but it has uncommitted changes.\n"
+                 "Please commit and push them to the old remote, or discard them, and then run checkout again.\n",
+                 subrepoDesc.path.fileSystemRepresentation);
+        return S7SubrepoMigrationResultRefused;
+    }
+
+    if ([subrepoGit hasUnpushedCommits]) {
+        logError("subrepo '%s' has migrated to a different url, but it has commits not pushed to the old remote '%s'.\n"
+                 "Please push or remove them, and then run checkout again.\n",
+                 subrepoDesc.path.fileSystemRepresentation,
+                 [oldUrl cStringUsingEncoding:NSUTF8StringEncoding]);
+        return S7SubrepoMigrationResultRefused;
+    }
+
+    NSString *currentRevision = nil;
+    if (0 != [subrepoGit getCurrentRevision:&currentRevision]) {
+        return S7SubrepoMigrationResultNeedsReclone;
+    }
+
+    if (0 != [subrepoGit setUrl:subrepoDesc.url]) {
+        return S7SubrepoMigrationResultNeedsReclone;
+    }
+
+    logInfo("   re-pointed origin, fetching from the new url...\n");
+
+    // objects we've got from the old remote stay in place and serve as 'haves',
+    // so only the difference between two remotes goes over the wire
+    GitCloneOptions *cloneOptions = [parentRepoOptions optionsForSubrepoAtPath:subrepoDesc.path].cloneOptions;
+    if (0 != [subrepoGit fetchWithCloneOptions:cloneOptions ensuringRevision:subrepoDesc.revision]) {
+        logError("   failed to fetch from the new url:\n%s\n",
+                 [subrepoGit.lastCommandStdErrOutput cStringUsingEncoding:NSUTF8StringEncoding]);
+        [subrepoGit setUrl:oldUrl];
+        return S7SubrepoMigrationResultNeedsReclone;
+    }
+
+    if (NO == [subrepoGit isRevisionAvailableLocally:subrepoDesc.revision]) {
+        logInfo("   the new remote doesn't have revision '%s'\n",
+                [subrepoDesc.revision cStringUsingEncoding:NSUTF8StringEncoding]);
+        return S7SubrepoMigrationResultNeedsReclone;
+    }
+
+    if (NO == [currentRevision isEqualToString:[GitRepository nullRevision]]
+        && NO == [subrepoGit isRevision:currentRevision relatedToRevision:subrepoDesc.revision])
+    {
+        logInfo("   the new remote has unrelated history\n");
+        return S7SubrepoMigrationResultNeedsReclone;
+    }
+
+    return S7SubrepoMigrationResultMigrated;
+}
+
 + (int)ensureSubrepoInTheRightState:(S7SubrepoDescription *)expectedSubrepoStateDesc
                          subrepoGit:(GitRepository *)subrepoGit
+                            options:(S7Options *)parentRepoOptions
                               clean:(BOOL)clean
+               subrepoFetchedByPull:(BOOL)subrepoFetchedByPull
                   shouldInitSubrepo:(BOOL *)shouldInitSubrepo
 {
     NSAssert(subrepoGit.redirectOutputToMemory,
@@ -711,6 +1064,19 @@ static void (^_warnAboutDetachingCommitsHook)(NSString *topRevision, int numberO
         return S7ExitCodeSuccess;
     }
 
+    S7Options *options = [parentRepoOptions optionsForSubrepoAtPath:expectedSubrepoStateDesc.path];
+    GitCloneOptions *cloneOptions = options.cloneOptions;
+
+    // bundles are used on CI, where nobody is going to push anything,
+    // thus stale remote branches are not a problem there, and we can skip fetch from origin
+    // if the bundle has brought us the necessary revision
+    BOOL revisionSeededFromBundle = NO;
+    NSString *bundlePath = [S7BundleCommand bundlePathForSubrepoURL:expectedSubrepoStateDesc.url
+                                                  inBundleDirectory:options.bundleDirectory];
+    if (bundlePath && 0 == [subrepoGit fetchFromBundleAtPath:bundlePath]) {
+        revisionSeededFromBundle = [subrepoGit isRevisionAvailableLocally:expectedSubrepoStateDesc.revision];
+    }
+
     // pastey:
     // we used to fetch subrepo only if the necessary revision was not available locally.
     // This turned to lead to a bug described in case-pushOfNewBranchDoesntPushUnnecessarySubrepos.sh
@@ -727,12 +1093,16 @@ static void (^_warnAboutDetachingCommitsHook)(NSString *topRevision, int numberO
     // If we notice that additional fetches become a problem, we will try to find a way to skip
     // fetch when possible. One option is to perform fetch only if local branch is ahead of remote.
     //
-//    if (NO == [subrepoGit isRevisionAvailableLocally:expectedSubrepoStateDesc.revision]) {
+    // the fetch below is exactly what `s7 pull` has just done
+    const BOOL revisionFetchedByPull = subrepoFetchedByPull
+                                       && NO == revisionSeededFromBundle
+                                       && [subrepoGit isRevisionAvailableLocally:expectedSubrepoStateDesc.revision];
+
+    if (NO == revisionSeededFromBundle && NO == revisionFetchedByPull) {
         logInfo("  fetching '%s'\n",
                 [expectedSubrepoStateDesc.path fileSystemRepresentation]);
 
-        S7Options *options = [S7Options new];
-        if (0 != [subrepoGit fetchWithFilter:options.filter]) {
+        if (0 != [subrepoGit fetchWithCloneOptions:cloneOptions ensuringRevision:expectedSubrepoStateDesc.revision]) {
             logError("  failed to fetch '%s':\n%s\n\n",
                      [expectedSubrepoStateDesc.path fileSystemRepresentation],
                      [subrepoGit.lastCommandStdErrOutput cStringUsingEncoding:NSUTF8StringEncoding]);
@@ -743,6 +1113,20 @@ static void (^_warnAboutDetachingCommitsHook)(NSString *topRevision, int numberO
         logInfo("  fetched '%s'\n",
                 [expectedSubrepoStateDesc.path fileSystemRepresentation]);
 
+        if (NO == [subrepoGit isRevisionAvailableLocally:expectedSubrepoStateDesc.revision] && subrepoGit.isShallowRepo) {
+            // shallow subrepo can be switched to a revision older than its shallow boundary
+            logInfo("  deepening '%s'\n",
+                    [expectedSubrepoStateDesc.path fileSystemRepresentation]);
+
+            if (0 != [subrepoGit deepenToRevision:expectedSubrepoStateDesc.revision cloneOptions:cloneOptions]) {
+                logError("  failed to deepen '%s':\n%s\n\n",
+                         [expectedSubrepoStateDesc.path fileSystemRepresentation],
+                         [subrepoGit.lastCommandStdErrOutput cStringUsingEncoding:NSUTF8StringEncoding]);
+
+                return S7ExitCodeGitOperationFailed;
+            }
+        }
+
         if (NO == [subrepoGit isRevisionAvailableLocally:expectedSubrepoStateDesc.revision]) {
             logError("  revision '%s' does not exist in '%s'\n",
                      [expectedSubrepoStateDesc.revision cStringUsingEncoding:NSUTF8StringEncoding],
@@ -750,7 +1134,7 @@ static void (^_warnAboutDetachingCommitsHook)(NSString *topRevision, int numberO
 
             return S7ExitCodeInvalidSubrepoRevision;
         }
-//    }
+    }
 
     logInfo("  switching '%s' to %s\n",
             [expectedSubrepoStateDesc.path fileSystemRepresentation],
@@ -780,6 +1164,7 @@ static void (^_warnAboutDetachingCommitsHook)(NSString *topRevision, int numberO
 
 + (int)cloneSubrepo:(S7SubrepoDescription *)subrepoDesc
 parentRepoAbsolutePath:(NSString *)parentRepoAbsolutePath
+            options:(S7Options *)parentRepoOptions
          subrepoGit:(GitRepository **)ppSubrepoGit
 {
     logInfo("  cloning from '%s'\n",
@@ -789,49 +1174,177 @@ parentRepoAbsolutePath:(NSString *)parentRepoAbsolutePath
 
     NSString *subrepoAbsolutePath = [parentRepoAbsolutePath stringByAppendingPathComponent:subrepoDesc.path];
 
+    S7Options *options = [parentRepoOptions optionsForSubrepoAtPath:subrepoDesc.path];
+    GitCloneOptions *cloneOptions = options.cloneOptions;
+
+    NSString *bundlePath = [S7BundleCommand bundlePathForSubrepoURL:subrepoDesc.url
+                                                  inBundleDirectory:options.bundleDirectory];
+    if (bundlePath) {
+        GitRepository *subrepoGit = nil;
+        const int seedExitStatus = [self seedSubrepo:subrepoDesc
+                                      fromBundleAtPath:bundlePath
+                                          cloneOptions:cloneOptions
+                                   subrepoAbsolutePath:subrepoAbsolutePath
+                                            subrepoGit:&subrepoGit];
+        if (S7ExitCodeSuccess == seedExitStatus) {
+            logInfo("  cloned subrepo '%s' from bundle\n", [subrepoDesc.path fileSystemRepresentation]);
+
+            *ppSubrepoGit = subrepoGit;
+            return S7ExitCodeSuccess;
+        }
+
+        logError("  failed to clone '%s' from bundle '%s'. Will clone from origin.\n",
+                 [subrepoDesc.path fileSystemRepresentation],
+                 bundlePath.fileSystemRepresentation);
+
+        NSError *error = nil;
+        if ([NSFileManager.defaultManager fileExistsAtPath:subrepoAbsolutePath]
+            && NO == [NSFileManager.defaultManager removeItemAtPath:subrepoAbsolutePath error:&error])
+        {
+            logError("failed to remove '%s'. Error: %s\n",
+                     subrepoDesc.path.fileSystemRepresentation,
+                     [[error description] cStringUsingEncoding:NSUTF8StringEncoding]);
+            return S7ExitCodeFileOperationFailed;
+        }
+    }
+
+    // pastey:
+    // we used to clone with `-b branch`, and if the branch had been deleted at origin,
+    // re-cloned the default branch from scratch. Either way the working tree was written twice –
+    // once by clone, and once more by the switch to the pinned revision in ensureSubrepoInTheRightState.
+    // Now we clone without checkout (nothing to fail if the branch is gone), and create the local branch
+    // right at the pinned revision. Everything is downloaded once, and the working tree is written once.
+    //
     // in case of clone, Git sends all output to stderr
     NSString *gitOutput = nil;
 
-    S7Options *options = [S7Options new];
     GitRepository *subrepoGit = [GitRepository
-                                 cloneRepoAtURL:subrepoDesc.url
-                                 branch:subrepoDesc.branch
-                                 bare:NO
+                                 cloneRepoWithoutCheckoutAtURL:subrepoDesc.url
                                  destinationPath:subrepoAbsolutePath
-                                 filter:options.filter
+                                 cloneOptions:cloneOptions
                                  stdOutOutput:&gitOutput
                                  stdErrOutput:&gitOutput
                                  exitStatus:&cloneExitStatus];
     if (nil == subrepoGit || 0 != cloneExitStatus) {
-        logError("  failed to clone '%s' with exact branch '%s'. Will retry to clone default branch and switch to the revision\n",
+        logError("  failed to clone subrepo '%s':\n%s\n\n",
                  [subrepoDesc.path fileSystemRepresentation],
-                 [subrepoDesc.branch cStringUsingEncoding:NSUTF8StringEncoding]);
-
-        cloneExitStatus = 0;
-        subrepoGit = [GitRepository
-                      cloneRepoAtURL:subrepoDesc.url
-                      branch:nil
-                      bare:NO
-                      destinationPath:subrepoAbsolutePath
-                      filter:options.filter
-                      stdOutOutput:&gitOutput
-                      stdErrOutput:&gitOutput
-                      exitStatus:&cloneExitStatus];
-
-        if (nil == subrepoGit || 0 != cloneExitStatus) {
-            logError("  failed to clone subrepo '%s':\n%s\n\n",
+                 [gitOutput cStringUsingEncoding:NSUTF8StringEncoding]);
+        return S7ExitCodeGitOperationFailed;
+    }
+
+    subrepoGit.redirectOutputToMemory = YES;
+
+    if (NO == [subrepoGit isRevisionAvailableLocally:subrepoDesc.revision]
+        && nil != [GitRepository urlMirrorForURL:subrepoDesc.url push:NO])
+    {
+        // cloned from a mirror that lags behind
+        if (0 != [subrepoGit fetchWithCloneOptions:cloneOptions ensuringRevision:subrepoDesc.revision]) {
+            logError("  failed to fetch '%s':\n%s\n\n",
+                     [subrepoDesc.path fileSystemRepresentation],
+                     [subrepoGit.lastCommandStdErrOutput cStringUsingEncoding:NSUTF8StringEncoding]);
+            return S7ExitCodeGitOperationFailed;
+        }
+    }
+
+    if (NO == [subrepoGit isRevisionAvailableLocally:subrepoDesc.revision] && subrepoGit.isShallowRepo) {
+        // pinned revision is older than the shallow boundary
+        logInfo("  deepening '%s'\n", [subrepoDesc.path fileSystemRepresentation]);
+
+        if (0 != [subrepoGit deepenToRevision:subrepoDesc.revision cloneOptions:cloneOptions]) {
+            logError("  failed to deepen '%s':\n%s\n\n",
                      [subrepoDesc.path fileSystemRepresentation],
-                     [gitOutput cStringUsingEncoding:NSUTF8StringEncoding]);
+                     [subrepoGit.lastCommandStdErrOutput cStringUsingEncoding:NSUTF8StringEncoding]);
             return S7ExitCodeGitOperationFailed;
         }
     }
 
+    if (NO == [subrepoGit isRevisionAvailableLocally:subrepoDesc.revision]) {
+        logError("  revision '%s' does not exist in '%s'\n",
+                 [subrepoDesc.revision cStringUsingEncoding:NSUTF8StringEncoding],
+                 [subrepoDesc.path fileSystemRepresentation]);
+        return S7ExitCodeInvalidSubrepoRevision;
+    }
+
+    const int checkoutExitStatus = [self checkoutEmptySubrepo:subrepoDesc
+                                                   subrepoGit:subrepoGit
+                                                 cloneOptions:cloneOptions];
+    if (S7ExitCodeSuccess != checkoutExitStatus) {
+        logError("  failed to checkout '%s' in subrepo '%s':\n%s\n\n",
+                 [subrepoDesc.humanReadableRevisionAndBranchState cStringUsingEncoding:NSUTF8StringEncoding],
+                 [subrepoDesc.path fileSystemRepresentation],
+                 [subrepoGit.lastCommandStdErrOutput cStringUsingEncoding:NSUTF8StringEncoding]);
+        return checkoutExitStatus;
+    }
+
     logInfo("  cloned subrepo '%s'\n", [subrepoDesc.path fileSystemRepresentation]);
 
-    NSAssert(subrepoGit, @"");
     *ppSubrepoGit = subrepoGit;
+
+    return S7ExitCodeSuccess;
+}
+
++ (int)seedSubrepo:(S7SubrepoDescription *)subrepoDesc
+  fromBundleAtPath:(NSString *)bundlePath
+      cloneOptions:(GitCloneOptions *)cloneOptions
+subrepoAbsolutePath:(NSString *)subrepoAbsolutePath
+        subrepoGit:(GitRepository **)ppSubrepoGit
+{
+    int exitStatus = 0;
+    GitRepository *subrepoGit = [GitRepository initializeRepositoryAtPath:subrepoAbsolutePath
+                                                         fromBundleAtPath:bundlePath
+                                                                      url:subrepoDesc.url
+                                                               exitStatus:&exitStatus];
+    if (nil == subrepoGit || 0 != exitStatus) {
+        return S7ExitCodeGitOperationFailed;
+    }
+
     subrepoGit.redirectOutputToMemory = YES;
 
+    if (NO == [subrepoGit isRevisionAvailableLocally:subrepoDesc.revision]) {
+        // bundle is older than .s7substate – get the rest from origin
+        logInfo("  fetching '%s'\n", [subrepoDesc.path fileSystemRepresentation]);
+
+        if (0 != [subrepoGit fetchWithCloneOptions:cloneOptions ensuringRevision:subrepoDesc.revision]) {
+            return S7ExitCodeGitOperationFailed;
+        }
+
+        if (NO == [subrepoGit isRevisionAvailableLocally:subrepoDesc.revision]) {
+            return S7ExitCodeInvalidSubrepoRevision;
+        }
+    }
+
+    const int checkoutExitStatus = [self checkoutEmptySubrepo:subrepoDesc
+                                                   subrepoGit:subrepoGit
+                                                 cloneOptions:cloneOptions];
+    if (S7ExitCodeSuccess != checkoutExitStatus) {
+        return checkoutExitStatus;
+    }
+
+    *ppSubrepoGit = subrepoGit;
+    return S7ExitCodeSuccess;
+}
+
+// subrepo has just been cloned or seeded, and nothing has been checked out yet.
+// The pinned revision must be available locally.
++ (int)checkoutEmptySubrepo:(S7SubrepoDescription *)subrepoDesc
+                 subrepoGit:(GitRepository *)subrepoGit
+               cloneOptions:(GitCloneOptions *)cloneOptions
+{
+    if (cloneOptions.isSparse) {
+        if (0 != [subrepoGit setSparseCheckoutDirectories:cloneOptions.sparseCheckoutDirectories]) {
+            return S7ExitCodeGitOperationFailed;
+        }
+    }
+
+    // `git checkout -B branch revision` – the only time the working tree is written
+    if (0 != [subrepoGit forceCheckoutLocalBranch:subrepoDesc.branch revision:subrepoDesc.revision]) {
+        return S7ExitCodeGitOperationFailed;
+    }
+
+    if (0 != [subrepoGit ensureBranchIsTrackingCorrespondingRemoteBranchIfItExists:subrepoDesc.branch]) {
+        return S7ExitCodeGitOperationFailed;
+    }
+
     return S7ExitCodeSuccess;
 }
 
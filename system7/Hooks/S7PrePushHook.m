@@ -11,6 +11,26 @@
 #import "S7Utils.h"
 #import "S7Diff.h"
 #import "S7StatusCommand.h"
+#import "S7Options.h"
+#import "S7ParallelExecutor.h"
+
+// set for pushes of nested s7 repos. The top-level hook has planned the push of the whole tree,
+// so hooks in nested repos have nothing to do
+static NSString * const S7PushPlannedByParentEnvironmentVariable = @"S7_PUSH_PLANNED_BY_PARENT";
+
+// a subrepo to push, and the subrepos of it that must be pushed first
+@interface S7PushPlanNode : NSObject
+
+@property (nonatomic, strong) GitRepository *repo;
+// relative to the main repo
+@property (nonatomic, copy) NSString *path;
+@property (nonatomic, copy) NSArray<NSString *> *branches;
+@property (nonatomic, strong) NSMutableArray<S7PushPlanNode *> *children;
+
+@end
+
+@implementation S7PushPlanNode
+@end
 
 @implementation S7PrePushHook
 
@@ -79,6 +99,10 @@
 }
 
 - (int)runWithArguments:(NSArray<NSString *> *)arguments {
+    if (NSProcessInfo.processInfo.environment[S7PushPlannedByParentEnvironmentVariable].length > 0) {
+        return S7ExitCodeSuccess;
+    }
+
     logInfo("s7: pre-push hook start\n");
     const int result = [self doRunWithArguments:arguments];
     logInfo("s7: pre-push hook complete\n\n");
@@ -349,17 +373,58 @@
         return exitStatus;
     }
 
-    for (NSString *subrepoPath in subreposToPush) {
+    // pastey:
+    // we used to push subrepos one by one, and if a subrepo was an s7 repo itself, its own
+    // pre-push hook did the rest. Every nested level started one more s7 process, which read
+    // options, walked .s7substate history and checked revisions once again, strictly one after another.
+    // Now we plan the push of the whole tree right here, push leaves first, independent
+    // subtrees in parallel, and tell nested hooks that there's nothing left for them to do.
+    //
+    NSMutableArray<S7PushPlanNode *> *plan = [NSMutableArray new];
+    const int planExitStatus = [self planPushOfSubrepos:subreposToPush
+                                                 inRepo:repo
+                                             pathPrefix:@""
+                                                   plan:plan];
+    if (S7ExitCodeSuccess != planExitStatus) {
+        return planExitStatus;
+    }
+
+    if (0 == plan.count) {
+        return S7ExitCodeSuccess;
+    }
+
+    S7Options *options = [S7Options optionsForRepoAtPath:repo.absolutePath];
+
+    [GitRepository setEnvironmentOverrideValue:@"1" forKey:S7PushPlannedByParentEnvironmentVariable];
+
+    const int pushExitStatus = [self executePushPlan:plan maxConcurrentTasks:options.maxConcurrentJobs];
+
+    [GitRepository setEnvironmentOverrideValue:nil forKey:S7PushPlannedByParentEnvironmentVariable];
+
+    return pushExitStatus;
+}
+
+- (int)planPushOfSubrepos:(NSDictionary<NSString *, NSMutableArray<S7SubrepoDescription *> *> *)subreposToPush
+                   inRepo:(GitRepository *)repo
+               pathPrefix:(NSString *)pathPrefix
+                     plan:(NSMutableArray<S7PushPlanNode *> *)plan
+{
+    for (NSString *subrepoPath in [subreposToPush.allKeys sortedArrayUsingSelector:@selector(compare:)]) {
+        NSString *displayPath = [pathPrefix stringByAppendingPathComponent:subrepoPath];
+
         logInfo(" checking '%s' ... ",
-                subrepoPath.fileSystemRepresentation);
+                displayPath.fileSystemRepresentation);
 
-        GitRepository *subrepoGit = [GitRepository repoAtPath:subrepoPath];
+        GitRepository *subrepoGit = [GitRepository repoAtPath:[repo.absolutePath stringByAppendingPathComponent:subrepoPath]];
         if (nil == subrepoGit) {
-            logError("\nabort: '%s' is not a git repo\n", subrepoPath.fileSystemRepresentation);
+            logError("\nabort: '%s' is not a git repo\n", displayPath.fileSystemRepresentation);
             return S7ExitCodeSubrepoIsNotGitRepository;
         }
 
-        NSMutableSet<NSString *> *branchesToPush = [NSMutableSet new];
+        // pushes run in parallel – their output is dumped only if something goes wrong
+        subrepoGit.redirectOutputToMemory = YES;
+
+        NSMutableOrderedSet<NSString *> *branchesToPush = [NSMutableOrderedSet new];
 
         for (S7SubrepoDescription *subrepoDesc in subreposToPush[subrepoPath]) {
             NSString *branch = subrepoDesc.branch;
@@ -384,27 +449,112 @@
             [branchesToPush addObject:branch];
         }
 
-        if (branchesToPush.count > 0) {
-            logInfo("\n"); // close the 'checking...'
+        if (0 == branchesToPush.count) {
+            logInfo(" already pushed.\n");
+            continue;
+        }
+
+        logInfo("\n"); // close the 'checking...'
+
+        S7PushPlanNode *node = [S7PushPlanNode new];
+        node.repo = subrepoGit;
+        node.path = displayPath;
+        node.branches = branchesToPush.array;
+        node.children = [NSMutableArray new];
+
+        if (isS7Repo(subrepoGit)) {
+            // exactly what pre-push hook in the subrepo would do for every branch we are going to push
+            NSMutableDictionary<NSString *, NSMutableArray<S7SubrepoDescription *> *> *nestedSubreposToPush = [NSMutableDictionary new];
+
+            for (NSString *branch in node.branches) {
+                NSString *localRevision = nil;
+                if (0 != [subrepoGit getLocalRevision:&localRevision atBranch:branch]) {
+                    logError("abort: failed to get revision of branch '%s' in '%s'\n",
+                             [branch cStringUsingEncoding:NSUTF8StringEncoding],
+                             displayPath.fileSystemRepresentation);
+                    return S7ExitCodeGitOperationFailed;
+                }
 
-            for (NSString *branch in branchesToPush) {
-                logInfo("  pushing '%s'...\n", [branch cStringUsingEncoding:NSUTF8StringEncoding]);
+                NSString *remoteRevision = nil;
+                if (0 != [subrepoGit getLatestRemoteRevision:&remoteRevision atBranch:branch]) {
+                    // a new branch
+                    remoteRevision = [GitRepository nullRevision];
+                }
 
-                // if subrepo is a s7 repo itself, pre-push hook in it will do the rest for us
-                const int gitExitStatus = [subrepoGit pushBranch:branch];
-                if (0 != gitExitStatus) {
-                    return gitExitStatus;
+                NSMutableDictionary<NSString *, NSMutableArray<S7SubrepoDescription *> *> *branchSubreposToPush = nil;
+                const int exitStatus = [self calculateSubreposToPushFromMainRepo:subrepoGit
+                                                latestRemoteRevisionAtThisBranch:remoteRevision
+                                                                 localSha1ToPush:localRevision
+                                                                  subreposToPush:&branchSubreposToPush];
+                if (0 != exitStatus) {
+                    return exitStatus;
                 }
+
+                [branchSubreposToPush
+                 enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull nestedSubrepoPath,
+                                                     NSMutableArray<S7SubrepoDescription *> * _Nonnull descriptions,
+                                                     BOOL * _Nonnull _)
+                 {
+                    NSMutableArray<S7SubrepoDescription *> *existingDescriptions = nestedSubreposToPush[nestedSubrepoPath];
+                    if (existingDescriptions) {
+                        [existingDescriptions addObjectsFromArray:descriptions];
+                    }
+                    else {
+                        nestedSubreposToPush[nestedSubrepoPath] = descriptions;
+                    }
+                }];
             }
 
-            logInfo(" success\n");
-        }
-        else {
-            logInfo(" already pushed.\n");
+            const int nestedPlanExitStatus = [self planPushOfSubrepos:nestedSubreposToPush
+                                                               inRepo:subrepoGit
+                                                           pathPrefix:displayPath
+                                                                 plan:node.children];
+            if (S7ExitCodeSuccess != nestedPlanExitStatus) {
+                return nestedPlanExitStatus;
+            }
         }
+
+        [plan addObject:node];
     }
 
     return S7ExitCodeSuccess;
 }
 
+- (int)executePushPlan:(NSArray<S7PushPlanNode *> *)plan maxConcurrentTasks:(NSUInteger)maxConcurrentTasks {
+    return
+    [S7ParallelExecutor
+     runTasksWithLabels:[plan valueForKey:@"path"]
+     errorPolicy:S7ParallelExecutionErrorPolicyFirstError
+     maxConcurrentTasks:maxConcurrentTasks
+     task:^int(NSUInteger i) {
+        S7PushPlanNode *node = plan[i];
+
+        // leaves first – a pushed repo must never reference subrepo revisions that are not at the remote yet
+        if (node.children.count > 0) {
+            const int childrenExitStatus = [self executePushPlan:node.children maxConcurrentTasks:maxConcurrentTasks];
+            if (S7ExitCodeSuccess != childrenExitStatus) {
+                return childrenExitStatus;
+            }
+        }
+
+        for (NSString *branch in node.branches) {
+            logInfo("  pushing '%s' of '%s'...\n",
+                    [branch cStringUsingEncoding:NSUTF8StringEncoding],
+                    node.path.fileSystemRepresentation);
+
+            const int gitExitStatus = [node.repo pushBranch:branch];
+            if (0 != gitExitStatus) {
+                logError("  failed to push '%s':\n%s\n",
+                         node.path.fileSystemRepresentation,
+                         [node.repo.lastCommandStdErrOutput cStringUsingEncoding:NSUTF8StringEncoding]);
+                return gitExitStatus;
+            }
+        }
+
+        logInfo(" pushed '%s'\n", node.path.fileSystemRepresentation);
+
+        return S7ExitCodeSuccess;
+    }];
+}
+
 @end
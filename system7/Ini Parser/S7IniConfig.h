@@ -20,6 +20,17 @@ NS_ASSUME_NONNULL_BEGIN
 
 @property (nonatomic, readonly, strong) NSDictionary<NSString *, NSDictionary<NSString *, NSString *> *> *dictionaryRepresentation;
 
+// Lower level API for readers of ini dialects (see GitConfig) that need more
+// than a dictionary: entries come in the order they appear in the string,
+// a key repeated in a section is reported every time. The block is called with
+// nil key and value for every section header. Empty value (`key =`) is reported
+// as an empty string.
+// Lines parser failed to understand are reported to malformedLineBlock.
+//
++ (void)enumerateEntriesOfString:(NSString *)string
+                      usingBlock:(void (NS_NOESCAPE ^)(NSString *sectionTitle, NSString * _Nullable key, NSString * _Nullable value))block
+              malformedLineBlock:(void (NS_NOESCAPE ^ _Nullable)(NSString *trimmedLine, NSString *lineKind))malformedLineBlock;
+
 @end
 
 NS_ASSUME_NONNULL_END
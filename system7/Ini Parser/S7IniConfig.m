@@ -18,6 +18,9 @@
 //  - no quoted value containing escaped \\ and \"
 //  - no other sophisticated things
 //
+// GitConfig adds subsections, includes and multi-valued keys on top of this
+// parser for Git's own config files.
+//
 
 @implementation S7IniConfig
 
@@ -63,6 +66,44 @@
 + (NSDictionary<NSString *, NSDictionary<NSString *, NSString *> *> *)parseConfig:(NSString *)string {
     NSMutableDictionary<NSString *, NSMutableDictionary<NSString *, NSString *> *> *parsedConfig = [NSMutableDictionary new];
 
+    [self
+     enumerateEntriesOfString:string
+     usingBlock:^(NSString * _Nonnull sectionTitle, NSString * _Nullable key, NSString * _Nullable value) {
+        if (nil == parsedConfig[sectionTitle]) {
+            parsedConfig[sectionTitle] = [NSMutableDictionary new];
+        }
+
+        if (key) {
+            NSAssert(value, @"");
+
+            if (0 == value.length) {
+                // from https://git-scm.com/docs/git-config
+                //  "All the other lines (and the remainder of the line after the section header)
+                //   are recognized as setting variables, in the form name = value
+                //   (or just name, which is a short-hand to say that the variable is the boolean "true")"
+                //
+                // Git itself reads `name =` as an empty string, but that's what our own
+                // configs have always meant by it. Lower level readers get the value as is.
+                //
+                value = @"true";
+            }
+
+            parsedConfig[sectionTitle][key] = value;
+        }
+    }
+     malformedLineBlock:^(NSString * _Nonnull trimmedLine, NSString * _Nonnull lineKind) {
+        logError("skipped %s line '%s'\n",
+                 [lineKind cStringUsingEncoding:NSUTF8StringEncoding],
+                 [trimmedLine cStringUsingEncoding:NSUTF8StringEncoding]);
+    }];
+
+    return parsedConfig;
+}
+
++ (void)enumerateEntriesOfString:(NSString *)string
+                      usingBlock:(void (NS_NOESCAPE ^)(NSString *sectionTitle, NSString * _Nullable key, NSString * _Nullable value))block
+              malformedLineBlock:(void (NS_NOESCAPE ^ _Nullable)(NSString *trimmedLine, NSString *lineKind))malformedLineBlock
+{
     __block NSString *currentSectionTitle = nil;
 
     [string enumerateLinesUsingBlock:^(NSString * _Nonnull line, BOOL * _Nonnull stop) {
@@ -80,33 +121,26 @@
             NSString *sectionTitle = [self parseSectionHeaderLine:trimmedLine];
             if (sectionTitle) {
                 currentSectionTitle = sectionTitle;
-                if (nil == parsedConfig[currentSectionTitle]) {
-                    parsedConfig[currentSectionTitle] = [NSMutableDictionary new];
-                }
+                block(currentSectionTitle, nil, nil);
             }
-            else {
-                logError("skipped ill-formed section line '%s'\n",
-                         [trimmedLine cStringUsingEncoding:NSUTF8StringEncoding]);
+            else if (malformedLineBlock) {
+                malformedLineBlock(trimmedLine, @"ill-formed section");
             }
         }
         else if (currentSectionTitle) {
-            NSDictionary *kv = [self parseKeyValueLine:trimmedLine];
+            NSDictionary<NSString *, NSString *> *kv = [self parseKeyValueLine:trimmedLine];
             if (kv) {
-                NSAssert(parsedConfig[currentSectionTitle], @"");
-                [parsedConfig[currentSectionTitle] addEntriesFromDictionary:kv];
+                NSString *key = kv.allKeys.firstObject;
+                block(currentSectionTitle, key, kv[key]);
             }
-            else {
-                logError("skipped ill-formed key-value line '%s'\n",
-                         [trimmedLine cStringUsingEncoding:NSUTF8StringEncoding]);
+            else if (malformedLineBlock) {
+                malformedLineBlock(trimmedLine, @"ill-formed key-value");
             }
         }
-        else {
-            logError("skipped out of section line '%s'\n",
-                     [trimmedLine cStringUsingEncoding:NSUTF8StringEncoding]);
+        else if (malformedLineBlock) {
+            malformedLineBlock(trimmedLine, @"out of section");
         }
     }];
-
-    return parsedConfig;
 }
 
 + (NSString *)parseSectionHeaderLine:(NSString *)trimmedLine {
@@ -148,7 +182,7 @@
     return nil;
 }
 
-+ (NSDictionary<NSString *, NSObject *> *)parseKeyValueLine:(NSString *)trimmedLine {
++ (NSDictionary<NSString *, NSString *> *)parseKeyValueLine:(NSString *)trimmedLine {
     __block NSUInteger equalSignPosition = NSNotFound;
     __block NSUInteger commentStartPosition = trimmedLine.length;
     __block BOOL inQuotes = NO;
@@ -193,15 +227,6 @@
     NSString *value = [trimmedLine substringWithRange:NSMakeRange(equalSignPosition + 1, commentStartPosition - equalSignPosition - 1)];
     value = [value stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
 
-    if (0 == value.length) {
-        // from https://git-scm.com/docs/git-config
-        //  "All the other lines (and the remainder of the line after the section header)
-        //   are recognized as setting variables, in the form name = value
-        //   (or just name, which is a short-hand to say that the variable is the boolean "true")"
-        //
-        value = @"true";
-    }
-
     return @{ key : value };
 }
 
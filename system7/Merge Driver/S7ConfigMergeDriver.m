@@ -15,6 +15,8 @@
 #import "S7MergeStrategy.h"
 #import "S7DefaultMergeStrategy.h"
 #import "S7KeepTargetBranchMergeStrategy.h"
+#import "S7ParallelExecutor.h"
+#import "S7Options.h"
 
 @interface S7ConfigMergeDriver ()
 @property (nonatomic) NSObject<S7MergeStrategy> *mergeStrategy;
@@ -93,28 +95,80 @@
 }
 
 - (S7SubrepoDescription *)mergeSubrepoConflict:(S7SubrepoDescriptionConflict *)conflictToMerge exitStatus:(int *)exitStatus {
+    return [self mergeSubrepoConflict:conflictToMerge output:nil exitStatus:exitStatus];
+}
+
+- (S7SubrepoDescription *)mergeSubrepoConflict:(S7SubrepoDescriptionConflict *)conflictToMerge
+                                        output:(NSMutableString * _Nullable)output
+                                    exitStatus:(int *)exitStatus
+{
+    // if `output` is passed, then we are one of several concurrent merges. Everything
+    // we (and git) have to say goes to `output`, so that the caller could print it out
+    // in one piece, once this subrepo is done. Otherwise we talk directly to the console
+    // and run interactive (stdin-friendly) `git merge`.
+    //
+    const BOOL bufferOutput = (nil != output);
+
+    __auto_type report = ^(BOOL isError, NSString *message) {
+        if (bufferOutput) {
+            [output appendString:message];
+        }
+        else if (isError) {
+            logError("%s", [message cStringUsingEncoding:NSUTF8StringEncoding]);
+        }
+        else {
+            logInfo("%s", [message cStringUsingEncoding:NSUTF8StringEncoding]);
+        }
+    };
+
     GitRepository *subrepoGit = [GitRepository repoAtPath:conflictToMerge.path];
     if (nil == subrepoGit) {
         *exitStatus = S7ExitCodeSubrepoIsNotGitRepository;
         return conflictToMerge;
     }
 
+    subrepoGit.redirectOutputToMemory = bufferOutput;
+
+    __auto_type appendGitOutput = ^{
+        if (NO == bufferOutput) {
+            return;
+        }
+
+        if (subrepoGit.lastCommandStdOutOutput.length > 0) {
+            [output appendString:subrepoGit.lastCommandStdOutOutput];
+        }
+
+        if (subrepoGit.lastCommandStdErrOutput.length > 0) {
+            [output appendString:subrepoGit.lastCommandStdErrOutput];
+        }
+    };
+
     NSString *subrepoPath = conflictToMerge.path;
     NSString *theirRevision = conflictToMerge.theirVersion.revision;
 
     if (NO == [subrepoGit isRevisionAvailableLocally:theirRevision]) {
-        logInfo("fetching '%s'\n",
-                [subrepoPath fileSystemRepresentation]);
+        report(NO, [NSString stringWithFormat:@"fetching '%@'\n", subrepoPath]);
+
+        // merge driver is run by Git at the root of the main repo
+        S7Options *options = [S7Options optionsForRepoAtPath:NSFileManager.defaultManager.currentDirectoryPath];
+        GitCloneOptions *cloneOptions = [options optionsForSubrepoAtPath:subrepoPath].cloneOptions;
+
+        int fetchExitStatus = [subrepoGit fetchWithCloneOptions:cloneOptions ensuringRevision:theirRevision];
+        appendGitOutput();
+        if (0 == fetchExitStatus && NO == [subrepoGit isRevisionAvailableLocally:theirRevision] && subrepoGit.isShallowRepo) {
+            fetchExitStatus = [subrepoGit deepenToRevision:theirRevision cloneOptions:cloneOptions];
+            appendGitOutput();
+        }
 
-        if (0 != [subrepoGit fetch]) {
+        if (0 != fetchExitStatus) {
             *exitStatus = S7ExitCodeGitOperationFailed;
             return conflictToMerge;
         }
 
         if (NO == [subrepoGit isRevisionAvailableLocally:theirRevision]) {
-            logError("revision '%s' does not exist in '%s'\n",
-                     [theirRevision cStringUsingEncoding:NSUTF8StringEncoding],
-                     subrepoPath.fileSystemRepresentation);
+            report(YES, [NSString stringWithFormat:@"revision '%@' does not exist in '%@'\n",
+                         theirRevision,
+                         subrepoPath]);
 
             *exitStatus = S7ExitCodeInvalidSubrepoRevision;
             return conflictToMerge;
@@ -129,7 +183,9 @@
                                             initWithCString:intermediateBranchNameCString
                                             encoding:NSUTF8StringEncoding];
 
-        if (0 != [subrepoGit checkoutNewLocalBranch:intermediateBranchName]) {
+        const int checkoutExitStatus = [subrepoGit checkoutNewLocalBranch:intermediateBranchName];
+        appendGitOutput();
+        if (0 != checkoutExitStatus) {
             *exitStatus = S7ExitCodeGitOperationFailed;
             return conflictToMerge;
         }
@@ -137,7 +193,11 @@
         resultingBranchName = intermediateBranchName;
     }
 
-    if (0 != [subrepoGit mergeWith:theirRevision]) {
+    const int mergeExitStatus = bufferOutput
+        ? [subrepoGit nonInteractiveMergeWith:theirRevision]
+        : [subrepoGit mergeWith:theirRevision];
+    appendGitOutput();
+    if (0 != mergeExitStatus) {
         *exitStatus = S7ExitCodeGitOperationFailed;
         return conflictToMerge;
     }
@@ -154,6 +214,131 @@
                                                branch:resultingBranchName];
 }
 
+- (BOOL)canMergeSubreposConcurrently {
+    // interactive `git merge` in a subrepo may end up asking user about sub-subrepo conflicts
+    // (see -[GitRepository mergeWith:]). We cannot ask several questions at once, thus
+    // concurrent merge is possible only if nobody is going to ask anything.
+    //
+    if (nil != NSProcessInfo.processInfo.environment[@"S7_MERGE_DRIVER_RESPONSE"]) {
+        return YES;
+    }
+
+    return NO == self.isTerminalInteractive();
+}
+
+- (NSDictionary<NSString *, S7SubrepoDescription *> *)mergeSubrepoConflicts:(NSArray<S7SubrepoDescriptionConflict *> *)conflictsToMerge {
+    NSMutableDictionary<NSString *, S7SubrepoDescription *> *pathToMergeResult =
+        [NSMutableDictionary dictionaryWithCapacity:conflictsToMerge.count];
+
+    if (conflictsToMerge.count < 2 || NO == [self canMergeSubreposConcurrently]) {
+        for (S7SubrepoDescriptionConflict *conflict in conflictsToMerge) {
+            int subrepoMergeExitStatus = 0;
+            S7SubrepoDescription *subrepoMergeResult = [self mergeSubrepoConflict:conflict exitStatus:&subrepoMergeExitStatus];
+            NSAssert(subrepoMergeResult, @"");
+            pathToMergeResult[conflict.path] = subrepoMergeResult;
+        }
+
+        return pathToMergeResult;
+    }
+
+    [S7ParallelExecutor
+     runTasks:conflictsToMerge.count
+     errorPolicy:S7ParallelExecutionErrorPolicyAllErrors
+     task:^int(NSUInteger i) {
+        S7SubrepoDescriptionConflict *conflict = conflictsToMerge[i];
+
+        NSMutableString *output = [NSMutableString new];
+        int subrepoMergeExitStatus = 0;
+        S7SubrepoDescription *subrepoMergeResult = [self mergeSubrepoConflict:conflict
+                                                                       output:output
+                                                                   exitStatus:&subrepoMergeExitStatus];
+        NSAssert(subrepoMergeResult, @"");
+
+        if (0 == subrepoMergeExitStatus) {
+            logInfo("\033[34m>\033[0m \033[1mmerged subrepo '%s'\033[0m\n%s",
+                    conflict.path.fileSystemRepresentation,
+                    [output cStringUsingEncoding:NSUTF8StringEncoding]);
+        }
+        else {
+            logError("failed to merge subrepo '%s'\n%s",
+                     conflict.path.fileSystemRepresentation,
+                     [output cStringUsingEncoding:NSUTF8StringEncoding]);
+        }
+
+        @synchronized (pathToMergeResult) {
+            pathToMergeResult[conflict.path] = subrepoMergeResult;
+        }
+
+        return subrepoMergeExitStatus;
+    }];
+
+    return pathToMergeResult;
+}
+
+- (void)printConflictsOverview:(NSArray<S7SubrepoDescriptionConflict *> *)conflicts {
+    if (conflicts.count < 2 || nil != NSProcessInfo.processInfo.environment[@"S7_MERGE_DRIVER_RESPONSE"]) {
+        return;
+    }
+
+    if (NO == self.isTerminalInteractive()) {
+        return;
+    }
+
+    NSMutableString *overview = [NSMutableString new];
+    [overview appendFormat:@"\n %lu subrepos need your decision:\n", (unsigned long)conflicts.count];
+    for (S7SubrepoDescriptionConflict *conflict in conflicts) {
+        [overview appendFormat:@"    %@\n", conflict.path];
+    }
+    [overview appendString:@" all merges will run once you've answered all questions.\n"];
+
+    logInfo("%s", [overview cStringUsingEncoding:NSUTF8StringEncoding]);
+}
+
++ (void)getConfigsToCheckoutAfterMergeFromOurConfig:(S7Config *)ourConfig
+                                        mergeResult:(S7Config *)mergeResult
+                                 mergedSubrepoPaths:(NSSet<NSString *> *)mergedSubrepoPaths
+                                         fromConfig:(S7Config * _Nullable __autoreleasing * _Nonnull)ppFromConfig
+                                           toConfig:(S7Config * _Nullable __autoreleasing * _Nonnull)ppToConfig
+{
+    // subrepos that haven't changed relative to our version are already in the right state –
+    // we are merging into them. Subrepos that we've just merged are in the right state too.
+    // There's no need to make the checkout re-inspect them all once again. We still pass
+    // our version of removed/changed subrepos as `fromConfig`, so that checkout could
+    // remove what's gone.
+    //
+    NSDictionary<NSString *, S7SubrepoDescription *> *ourPathToDescription = ourConfig.pathToDescriptionMap;
+
+    NSMutableArray<S7SubrepoDescription *> *subreposToCheckout = [NSMutableArray new];
+    NSMutableArray<S7SubrepoDescription *> *ourChangedSubrepos = [NSMutableArray new];
+
+    for (S7SubrepoDescription *subrepoDesc in mergeResult.subrepoDescriptions) {
+        if ([mergedSubrepoPaths containsObject:subrepoDesc.path]) {
+            continue;
+        }
+
+        S7SubrepoDescription *ourSubrepoDesc = ourPathToDescription[subrepoDesc.path];
+        if ([subrepoDesc isEqual:ourSubrepoDesc]) {
+            continue;
+        }
+
+        [subreposToCheckout addObject:subrepoDesc];
+
+        if (ourSubrepoDesc) {
+            [ourChangedSubrepos addObject:ourSubrepoDesc];
+        }
+    }
+
+    NSSet<NSString *> *resultPaths = mergeResult.subrepoPathsSet;
+    for (S7SubrepoDescription *ourSubrepoDesc in ourConfig.subrepoDescriptions) {
+        if (NO == [resultPaths containsObject:ourSubrepoDesc.path]) {
+            [ourChangedSubrepos addObject:ourSubrepoDesc];
+        }
+    }
+
+    *ppFromConfig = [[S7Config alloc] initWithSubrepoDescriptions:ourChangedSubrepos];
+    *ppToConfig = [[S7Config alloc] initWithSubrepoDescriptions:subreposToCheckout];
+}
+
 - (int)mergeRepo:(GitRepository *)repo
       baseConfig:(S7Config *)baseConfig
        ourConfig:(S7Config *)ourConfig
@@ -174,7 +359,34 @@ saveResultToFilePath:(NSString *)resultFilePath
     }
 
     BOOL conflictResolved = YES;
+    NSMutableSet<NSString *> *mergedSubrepoPaths = [NSMutableSet new];
     if (detectedConflict) {
+        NSMutableArray<S7SubrepoDescriptionConflict *> *conflicts = [NSMutableArray new];
+        for (S7SubrepoDescription *subrepoDesc in mergeResult.subrepoDescriptions) {
+            if ([subrepoDesc isKindOfClass:[S7SubrepoDescriptionConflict class]]) {
+                [conflicts addObject:(S7SubrepoDescriptionConflict *)subrepoDesc];
+            }
+        }
+
+        // first, collect all decisions. User answers all questions at once, and then
+        // can go grab a coffee while we are merging – there's nothing else to ask.
+        //
+        [self printConflictsOverview:conflicts];
+
+        NSMutableDictionary<NSString *, NSNumber *> *pathToUserDecision = [NSMutableDictionary dictionaryWithCapacity:conflicts.count];
+        NSMutableArray<S7SubrepoDescriptionConflict *> *conflictsToMerge = [NSMutableArray new];
+        for (S7SubrepoDescriptionConflict *conflict in conflicts) {
+            const S7ConflictResolutionOption userDecision = self.resolveConflictBlock(conflict.ourVersion,
+                                                                                      conflict.theirVersion);
+            pathToUserDecision[conflict.path] = @(userDecision);
+
+            if (S7ConflictResolutionOptionMerge == userDecision) {
+                [conflictsToMerge addObject:conflict];
+            }
+        }
+
+        NSDictionary<NSString *, S7SubrepoDescription *> *pathToMergeResult = [self mergeSubrepoConflicts:conflictsToMerge];
+
         NSMutableArray<S7SubrepoDescription *> *resolvedMergeResultSubrepos =
             [NSMutableArray arrayWithCapacity:mergeResult.subrepoDescriptions.count];
 
@@ -186,8 +398,7 @@ saveResultToFilePath:(NSString *)resultFilePath
 
             S7SubrepoDescriptionConflict *conflict = (S7SubrepoDescriptionConflict *)subrepoDesc;
 
-            const S7ConflictResolutionOption userDecision = self.resolveConflictBlock(conflict.ourVersion,
-                                                                                      conflict.theirVersion);
+            const S7ConflictResolutionOption userDecision = [pathToUserDecision[conflict.path] unsignedIntValue];
 
             if (S7ConflictResolutionOptionKeepConflict == userDecision) {
                 conflictResolved = NO;
@@ -203,14 +414,17 @@ saveResultToFilePath:(NSString *)resultFilePath
                     break;
 
                 case S7ConflictResolutionOptionMerge: {
-                    int subrepoMergeExitStatus = 0;
-                    S7SubrepoDescription *subrepoMergeResult = [self mergeSubrepoConflict:conflict exitStatus:&subrepoMergeExitStatus];
+                    S7SubrepoDescription *subrepoMergeResult = pathToMergeResult[conflict.path];
                     NSAssert(subrepoMergeResult, @"");
                     [resolvedMergeResultSubrepos addObject:subrepoMergeResult];
 
-                    if (0 != subrepoMergeExitStatus) {
+                    // on failure, merge returns the conflict as is
+                    if ([subrepoMergeResult isKindOfClass:[S7SubrepoDescriptionConflict class]]) {
                         conflictResolved = NO;
                     }
+                    else {
+                        [mergedSubrepoPaths addObject:conflict.path];
+                    }
 
                     break;
                 }
@@ -250,12 +464,20 @@ saveResultToFilePath:(NSString *)resultFilePath
         return S7ExitCodeFileOperationFailed;
     }
 
+    S7Config *checkoutFromConfig = nil;
+    S7Config *checkoutToConfig = nil;
+    [self.class getConfigsToCheckoutAfterMergeFromOurConfig:ourConfig
+                                                mergeResult:mergeResult
+                                         mergedSubrepoPaths:mergedSubrepoPaths
+                                                 fromConfig:&checkoutFromConfig
+                                                   toConfig:&checkoutToConfig];
+
     if (NO == conflictResolved) {
-        [S7PostCheckoutHook checkoutSubreposForRepo:repo fromConfig:ourConfig toConfig:mergeResult];
+        [S7PostCheckoutHook checkoutSubreposForRepo:repo fromConfig:checkoutFromConfig toConfig:checkoutToConfig];
         return S7ExitCodeMergeFailed;
     }
 
-    return [S7PostCheckoutHook checkoutSubreposForRepo:repo fromConfig:ourConfig toConfig:mergeResult];
+    return [S7PostCheckoutHook checkoutSubreposForRepo:repo fromConfig:checkoutFromConfig toConfig:checkoutToConfig];
 }
 
 - (S7ConflictResolutionOption)resolveConflictBetweenOurVersion:(S7SubrepoDescription * _Nullable)ourVersion
@@ -7,6 +7,7 @@
 //
 
 #import "S7DefaultOptions.h"
+#import "S7ParallelExecutor.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -22,6 +23,38 @@ NS_ASSUME_NONNULL_BEGIN
     return GitFilterNone;
 }
 
+- (nullable NSNumber *)depth {
+    return @0;
+}
+
+- (nullable NSString *)shallowSince {
+    return nil;
+}
+
+- (nullable NSArray<NSString *> *)sparseCheckoutDirectories {
+    return nil;
+}
+
+- (nullable NSString *)bundleDirectory {
+    return nil;
+}
+
+- (nullable NSNumber *)jobs {
+    return @([S7ParallelExecutor defaultMaxConcurrentTasks]);
+}
+
+- (nullable NSNumber *)lfsDeferred {
+    return @NO;
+}
+
+- (nullable NSNumber *)sshMultiplexing {
+    return @NO;
+}
+
+- (nullable NSArray<GitURLMirror *> *)urlMirrors {
+    return nil;
+}
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -22,6 +22,30 @@ NS_ASSUME_NONNULL_BEGIN
 - (nullable instancetype)initWithContentsOfFile:(NSString *)filePath;
 - (nullable instancetype)initWithIniConfig:(S7IniConfig *)iniConfig NS_DESIGNATED_INITIALIZER;
 
+// Options from `[subrepo "<path>"]` section, e.g.:
+//
+//   [subrepo "Dependencies/ThirdParty/openssl"]
+//     depth = 1
+//     filter = tree:0
+//     sparse-checkout = include, lib
+//
+// Returns nil if there's no such section in the config.
+//
+- (nullable S7IniConfigOptions *)optionsForSubrepoAtPath:(NSString *)subrepoPath;
+
+// Mirror rules are read from `[mirror "<prefix>"]` sections, e.g.:
+//
+//   [mirror "git@github.com:readdle/"]
+//     url = https://git-cache.local/readdle/
+//     scope = fetch
+//
+// `scope` is either `fetch` (default) or `fetch-and-push`.
+//
+
+// Options are parsed lazily on the first access. Once all of them are parsed,
+// instance doesn't change anymore and can be shared between threads.
+- (void)parseAllOptions;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -15,12 +15,35 @@ static NSString * const S7IniConfigOptionsAddCommandSectionName = @"add";
 static NSString * const S7IniConfigOptionsAddCommandAllowedTransportProtocols = @"transport-protocols";
 static NSString * const S7IniConfigOptionsGitCommandSectionName = @"git";
 static NSString * const S7IniConfigOptionsGitCommandFilter = @"filter";
+static NSString * const S7IniConfigOptionsGitCommandDepth = @"depth";
+static NSString * const S7IniConfigOptionsGitCommandShallowSince = @"shallow-since";
+static NSString * const S7IniConfigOptionsGitCommandSparseCheckout = @"sparse-checkout";
+static NSString * const S7IniConfigOptionsGitCommandBundleDirectory = @"bundle-dir";
+static NSString * const S7IniConfigOptionsGitCommandJobs = @"jobs";
+static NSString * const S7IniConfigOptionsGitCommandLFS = @"lfs";
+static NSString * const S7IniConfigOptionsLFSInline = @"inline";
+static NSString * const S7IniConfigOptionsLFSDeferred = @"deferred";
+static NSString * const S7IniConfigOptionsGitCommandSSHMultiplexing = @"ssh-multiplexing";
+static NSString * const S7IniConfigOptionsSubrepoSectionNameFormat = @"subrepo \"%@\"";
+static NSString * const S7IniConfigOptionsMirrorSectionNamePrefix = @"mirror \"";
+static NSString * const S7IniConfigOptionsMirrorURL = @"url";
+static NSString * const S7IniConfigOptionsMirrorScope = @"scope";
+static NSString * const S7IniConfigOptionsMirrorScopeFetch = @"fetch";
+static NSString * const S7IniConfigOptionsMirrorScopeFetchAndPush = @"fetch-and-push";
 
 @interface S7IniConfigOptions()
 
 @property (nonatomic, readonly) S7IniConfig *iniConfig;
+// `git` for global options, `subrepo "<path>"` for subrepo-specific options
+@property (nonatomic, copy) NSString *gitSectionName;
 @property (nonatomic, assign) BOOL areAllowedTransportProtocolsParsed;
 @property (nonatomic, assign) BOOL isFilterParsed;
+@property (nonatomic, assign) BOOL isDepthParsed;
+@property (nonatomic, assign) BOOL isSparseCheckoutDirectoriesParsed;
+@property (nonatomic, assign) BOOL isJobsParsed;
+@property (nonatomic, assign) BOOL isLFSDeferredParsed;
+@property (nonatomic, assign) BOOL isSSHMultiplexingParsed;
+@property (nonatomic, assign) BOOL areURLMirrorsParsed;
 
 @end
 
@@ -30,6 +53,12 @@ static NSString * const S7IniConfigOptionsGitCommandFilter = @"filter";
 
 @synthesize allowedTransportProtocols = _allowedTransportProtocols;
 @synthesize filter = _filter;
+@synthesize depth = _depth;
+@synthesize sparseCheckoutDirectories = _sparseCheckoutDirectories;
+@synthesize jobs = _jobs;
+@synthesize lfsDeferred = _lfsDeferred;
+@synthesize sshMultiplexing = _sshMultiplexing;
+@synthesize urlMirrors = _urlMirrors;
 
 #pragma mark - Initialization -
 
@@ -55,10 +84,33 @@ static NSString * const S7IniConfigOptionsGitCommandFilter = @"filter";
     }
  
     _iniConfig = iniConfig;
+    _gitSectionName = S7IniConfigOptionsGitCommandSectionName;
     
     return self;
 }
 
+- (nullable S7IniConfigOptions *)optionsForSubrepoAtPath:(NSString *)subrepoPath {
+    NSString *sectionName = [NSString stringWithFormat:S7IniConfigOptionsSubrepoSectionNameFormat, subrepoPath];
+    if (nil == self.iniConfig.dictionaryRepresentation[sectionName]) {
+        return nil;
+    }
+
+    S7IniConfigOptions *subrepoOptions = [[S7IniConfigOptions alloc] initWithIniConfig:self.iniConfig];
+    subrepoOptions.gitSectionName = sectionName;
+    return subrepoOptions;
+}
+
+- (void)parseAllOptions {
+    (void)self.allowedTransportProtocols;
+    (void)self.filter;
+    (void)self.depth;
+    (void)self.sparseCheckoutDirectories;
+    (void)self.jobs;
+    (void)self.lfsDeferred;
+    (void)self.sshMultiplexing;
+    (void)self.urlMirrors;
+}
+
 #pragma mark - Properties -
 
 - (nullable NSSet<S7TransportProtocolName> *)allowedTransportProtocols {
@@ -115,7 +167,7 @@ static NSString * const S7IniConfigOptionsGitCommandFilter = @"filter";
     }
     
     NSDictionary<NSString*, NSDictionary<NSString*, NSString *> *> *iniDictionary = self.iniConfig.dictionaryRepresentation;
-    NSString *filterValue = iniDictionary[S7IniConfigOptionsGitCommandSectionName][S7IniConfigOptionsGitCommandFilter].lowercaseString;
+    NSString *filterValue = iniDictionary[self.gitSectionName][S7IniConfigOptionsGitCommandFilter].lowercaseString;
     
     if (filterValue == nil) {
         _filter = GitFilterUnspecified;
@@ -124,6 +176,9 @@ static NSString * const S7IniConfigOptionsGitCommandFilter = @"filter";
         if ([filterValue isEqualToString:kGitFilterBlobNone]) {
             _filter = GitFilterBlobNone;
         }
+        else if ([filterValue isEqualToString:kGitFilterTreeNone]) {
+            _filter = GitFilterTreeNone;
+        }
         else {
             NSString *errorMessage =
             [NSString stringWithFormat:@"error: unsupported filter detected during '%@' option parsing.",
@@ -139,6 +194,248 @@ static NSString * const S7IniConfigOptionsGitCommandFilter = @"filter";
     return _filter;
 }
 
+- (nullable NSNumber *)depth {
+    if (self.isDepthParsed) {
+        return _depth;
+    }
+
+    self.isDepthParsed = YES;
+
+    NSDictionary<NSString*, NSDictionary<NSString*, NSString *> *> *iniDictionary = self.iniConfig.dictionaryRepresentation;
+    NSString *depthValue = iniDictionary[self.gitSectionName][S7IniConfigOptionsGitCommandDepth];
+    if (nil == depthValue) {
+        _depth = nil;
+        return nil;
+    }
+
+    NSScanner *scanner = [NSScanner scannerWithString:depthValue];
+    NSInteger depth = 0;
+    if (NO == [scanner scanInteger:&depth] || NO == scanner.isAtEnd || depth < 0) {
+        NSString *errorMessage =
+        [NSString stringWithFormat:@"error: invalid value '%@' detected during '%@' option parsing. Non-negative integer expected.",
+         depthValue,
+         S7IniConfigOptionsGitCommandDepth];
+
+        logError("%s\n", [errorMessage cStringUsingEncoding:NSUTF8StringEncoding]);
+
+        _depth = nil;
+        return nil;
+    }
+
+    _depth = @(depth);
+    return _depth;
+}
+
+- (nullable NSString *)shallowSince {
+    NSDictionary<NSString*, NSDictionary<NSString*, NSString *> *> *iniDictionary = self.iniConfig.dictionaryRepresentation;
+    NSString *shallowSinceValue = iniDictionary[self.gitSectionName][S7IniConfigOptionsGitCommandShallowSince];
+    if (0 == shallowSinceValue.length) {
+        return nil;
+    }
+
+    return shallowSinceValue;
+}
+
+- (nullable NSString *)bundleDirectory {
+    NSDictionary<NSString*, NSDictionary<NSString*, NSString *> *> *iniDictionary = self.iniConfig.dictionaryRepresentation;
+    NSString *bundleDirectoryValue = iniDictionary[self.gitSectionName][S7IniConfigOptionsGitCommandBundleDirectory];
+    if (0 == bundleDirectoryValue.length) {
+        return nil;
+    }
+
+    return bundleDirectoryValue.stringByExpandingTildeInPath;
+}
+
+- (nullable NSArray<NSString *> *)sparseCheckoutDirectories {
+    if (self.isSparseCheckoutDirectoriesParsed) {
+        return _sparseCheckoutDirectories;
+    }
+
+    self.isSparseCheckoutDirectoriesParsed = YES;
+
+    NSDictionary<NSString*, NSDictionary<NSString*, NSString *> *> *iniDictionary = self.iniConfig.dictionaryRepresentation;
+    NSString *sparseCheckoutValue = iniDictionary[self.gitSectionName][S7IniConfigOptionsGitCommandSparseCheckout];
+    if (nil == sparseCheckoutValue) {
+        _sparseCheckoutDirectories = nil;
+        return nil;
+    }
+
+    NSMutableArray<NSString *> *directories = [NSMutableArray new];
+    for (NSString *component in [sparseCheckoutValue componentsSeparatedByString:@","]) {
+        NSString *directory = [component stringByTrimmingCharactersInSet:NSCharacterSet.whitespaceCharacterSet];
+        if (directory.length > 0) {
+            [directories addObject:directory];
+        }
+    }
+
+    _sparseCheckoutDirectories = directories;
+    return _sparseCheckoutDirectories;
+}
+
+- (nullable NSNumber *)jobs {
+    if (self.isJobsParsed) {
+        return _jobs;
+    }
+
+    self.isJobsParsed = YES;
+
+    NSDictionary<NSString*, NSDictionary<NSString*, NSString *> *> *iniDictionary = self.iniConfig.dictionaryRepresentation;
+    NSString *jobsValue = iniDictionary[self.gitSectionName][S7IniConfigOptionsGitCommandJobs];
+    if (nil == jobsValue) {
+        _jobs = nil;
+        return nil;
+    }
+
+    NSScanner *scanner = [NSScanner scannerWithString:jobsValue];
+    NSInteger jobs = 0;
+    if (NO == [scanner scanInteger:&jobs] || NO == scanner.isAtEnd || jobs < 1) {
+        NSString *errorMessage =
+        [NSString stringWithFormat:@"error: invalid value '%@' detected during '%@' option parsing. Positive integer expected.",
+         jobsValue,
+         S7IniConfigOptionsGitCommandJobs];
+
+        logError("%s\n", [errorMessage cStringUsingEncoding:NSUTF8StringEncoding]);
+
+        _jobs = nil;
+        return nil;
+    }
+
+    _jobs = @(jobs);
+    return _jobs;
+}
+
+- (nullable NSNumber *)lfsDeferred {
+    if (self.isLFSDeferredParsed) {
+        return _lfsDeferred;
+    }
+
+    self.isLFSDeferredParsed = YES;
+
+    NSDictionary<NSString*, NSDictionary<NSString*, NSString *> *> *iniDictionary = self.iniConfig.dictionaryRepresentation;
+    NSString *lfsValue = iniDictionary[self.gitSectionName][S7IniConfigOptionsGitCommandLFS].lowercaseString;
+    if (nil == lfsValue) {
+        _lfsDeferred = nil;
+    }
+    else if ([lfsValue isEqualToString:S7IniConfigOptionsLFSDeferred]) {
+        _lfsDeferred = @YES;
+    }
+    else if ([lfsValue isEqualToString:S7IniConfigOptionsLFSInline]) {
+        _lfsDeferred = @NO;
+    }
+    else {
+        NSString *errorMessage =
+        [NSString stringWithFormat:@"error: invalid value '%@' detected during '%@' option parsing. '%@' or '%@' expected.",
+         lfsValue,
+         S7IniConfigOptionsGitCommandLFS,
+         S7IniConfigOptionsLFSInline,
+         S7IniConfigOptionsLFSDeferred];
+
+        logError("%s\n", [errorMessage cStringUsingEncoding:NSUTF8StringEncoding]);
+
+        _lfsDeferred = nil;
+    }
+
+    return _lfsDeferred;
+}
+
+- (nullable NSNumber *)sshMultiplexing {
+    if (self.isSSHMultiplexingParsed) {
+        return _sshMultiplexing;
+    }
+
+    self.isSSHMultiplexingParsed = YES;
+
+    NSDictionary<NSString*, NSDictionary<NSString*, NSString *> *> *iniDictionary = self.iniConfig.dictionaryRepresentation;
+    NSString *sshMultiplexingValue = iniDictionary[self.gitSectionName][S7IniConfigOptionsGitCommandSSHMultiplexing].lowercaseString;
+    if (nil == sshMultiplexingValue) {
+        _sshMultiplexing = nil;
+    }
+    else if ([@[ @"true", @"yes", @"on" ] containsObject:sshMultiplexingValue]) {
+        _sshMultiplexing = @YES;
+    }
+    else if ([@[ @"false", @"no", @"off" ] containsObject:sshMultiplexingValue]) {
+        _sshMultiplexing = @NO;
+    }
+    else {
+        NSString *errorMessage =
+        [NSString stringWithFormat:@"error: invalid value '%@' detected during '%@' option parsing. 'true' or 'false' expected.",
+         sshMultiplexingValue,
+         S7IniConfigOptionsGitCommandSSHMultiplexing];
+
+        logError("%s\n", [errorMessage cStringUsingEncoding:NSUTF8StringEncoding]);
+
+        _sshMultiplexing = nil;
+    }
+
+    return _sshMultiplexing;
+}
+
+- (nullable NSArray<GitURLMirror *> *)urlMirrors {
+    if (self.areURLMirrorsParsed) {
+        return _urlMirrors;
+    }
+
+    self.areURLMirrorsParsed = YES;
+
+    // mirrors are not subrepo-specific – they belong to the whole config
+    if (NO == [self.gitSectionName isEqualToString:S7IniConfigOptionsGitCommandSectionName]) {
+        _urlMirrors = nil;
+        return nil;
+    }
+
+    NSMutableArray<GitURLMirror *> *mirrors = [NSMutableArray new];
+
+    NSDictionary<NSString*, NSDictionary<NSString*, NSString *> *> *iniDictionary = self.iniConfig.dictionaryRepresentation;
+    // sorted, so that rules come in the same order every time
+    for (NSString *sectionName in [iniDictionary.allKeys sortedArrayUsingSelector:@selector(compare:)]) {
+        if (NO == [sectionName hasPrefix:S7IniConfigOptionsMirrorSectionNamePrefix]
+            || NO == [sectionName hasSuffix:@"\""]
+            || sectionName.length <= S7IniConfigOptionsMirrorSectionNamePrefix.length + 1)
+        {
+            continue;
+        }
+
+        NSString *prefix = [sectionName substringWithRange:NSMakeRange(S7IniConfigOptionsMirrorSectionNamePrefix.length,
+                                                                       sectionName.length - S7IniConfigOptionsMirrorSectionNamePrefix.length - 1)];
+
+        NSString *mirrorPrefix = iniDictionary[sectionName][S7IniConfigOptionsMirrorURL];
+        if (0 == mirrorPrefix.length) {
+            NSString *errorMessage =
+            [NSString stringWithFormat:@"error: no '%@' in mirror rule for '%@'. Rule is ignored.",
+             S7IniConfigOptionsMirrorURL,
+             prefix];
+
+            logError("%s\n", [errorMessage cStringUsingEncoding:NSUTF8StringEncoding]);
+            continue;
+        }
+
+        NSString *scopeValue = iniDictionary[sectionName][S7IniConfigOptionsMirrorScope].lowercaseString;
+        BOOL includesPush = NO;
+        if (nil == scopeValue || [scopeValue isEqualToString:S7IniConfigOptionsMirrorScopeFetch]) {
+            includesPush = NO;
+        }
+        else if ([scopeValue isEqualToString:S7IniConfigOptionsMirrorScopeFetchAndPush]) {
+            includesPush = YES;
+        }
+        else {
+            NSString *errorMessage =
+            [NSString stringWithFormat:@"error: invalid value '%@' detected during '%@' option parsing. '%@' or '%@' expected. Rule is ignored.",
+             scopeValue,
+             S7IniConfigOptionsMirrorScope,
+             S7IniConfigOptionsMirrorScopeFetch,
+             S7IniConfigOptionsMirrorScopeFetchAndPush];
+
+            logError("%s\n", [errorMessage cStringUsingEncoding:NSUTF8StringEncoding]);
+            continue;
+        }
+
+        [mirrors addObject:[GitURLMirror mirrorWithPrefix:prefix mirrorPrefix:mirrorPrefix includesPush:includesPush]];
+    }
+
+    _urlMirrors = mirrors.count > 0 ? mirrors : nil;
+    return _urlMirrors;
+}
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -8,11 +8,28 @@
 
 #import <Foundation/Foundation.h>
 #import "S7OptionsProtocol.h"
+#import "GitCloneOptions.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
 @interface S7Options : NSObject<S7OptionsProtocol>
 
+// Options of the current directory's repo. Reads options files on every call.
+- (instancetype)init;
+
+// Immutable snapshot of options of the repo at the given root: its .s7options,
+// user options file and defaults. Snapshot is cached for the whole process and is
+// re-read only if any of the options files changes on disk. Safe to share between threads.
++ (S7Options *)optionsForRepoAtPath:(NSString *)repoPath;
+
+// options for a specific subrepo: `[subrepo "<path>"]` section of each
+// options file takes precedence over the global options from the same file
+- (S7Options *)optionsForSubrepoAtPath:(NSString *)subrepoPath;
+
+@property (nonatomic, readonly) GitCloneOptions *cloneOptions;
+// `jobs` option or a sensible default
+@property (nonatomic, readonly) NSUInteger maxConcurrentJobs;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -26,37 +26,114 @@ NSString * const S7UserOptionsFilePath = @"~/.s7options";
 
 #pragma mark - Initialization -
 
++ (NSString *)userOptionsFilePath {
+    NSString *userOptionsFilePath = S7UserOptionsFilePath;
+    const char *userOptionsPathEnvVariable = getenv("S7_USER_OPTIONS_PATH");
+
+    if (NULL != userOptionsPathEnvVariable) {
+        userOptionsFilePath = [NSString stringWithUTF8String:userOptionsPathEnvVariable];
+    }
+
+    return userOptionsFilePath.stringByExpandingTildeInPath;
+}
+
 - (instancetype)init {
+    return [self initWithOptionsFilePaths:@[ S7OptionsFileName, [self.class userOptionsFilePath] ]];
+}
+
+- (instancetype)initWithOptionsFilePaths:(NSArray<NSString *> *)optionsFilePaths {
     if (nil == (self = [super init])) {
         return nil;
     }
     
-    NSMutableArray<id<S7OptionsProtocol>> *optionsChain = [NSMutableArray arrayWithCapacity:2];
+    NSMutableArray<id<S7OptionsProtocol>> *optionsChain = [NSMutableArray arrayWithCapacity:optionsFilePaths.count + 1];
     
-    __auto_type addIniConfigOptionsIfPossible = ^(NSString *iniOptionsFilePath) {
-        NSString *fullPath = iniOptionsFilePath.stringByExpandingTildeInPath;
-        
-        if ([[NSFileManager defaultManager] fileExistsAtPath:fullPath]) {
-            [optionsChain addObject:[[S7IniConfigOptions alloc] initWithContentsOfFile:fullPath]];
+    for (NSString *optionsFilePath in optionsFilePaths) {
+        if ([[NSFileManager defaultManager] fileExistsAtPath:optionsFilePath]) {
+            S7IniConfigOptions *options = [[S7IniConfigOptions alloc] initWithContentsOfFile:optionsFilePath];
+            if (options) {
+                [optionsChain addObject:options];
+            }
         }
-    };
-    
-    NSString *userOptionsFilePath = S7UserOptionsFilePath;
-    const char *userOptionsPathEnvVariable = getenv("S7_USER_OPTIONS_PATH");
-
-    if (NULL != userOptionsPathEnvVariable) {
-        userOptionsFilePath = [NSString stringWithUTF8String:userOptionsPathEnvVariable];
     }
     
-    addIniConfigOptionsIfPossible(S7OptionsFileName);
-    addIniConfigOptionsIfPossible(userOptionsFilePath);
-    
     [optionsChain addObject:[S7DefaultOptions new]];
     _optionsChain = optionsChain;
     
     return self;
 }
 
++ (S7Options *)optionsForRepoAtPath:(NSString *)repoPath {
+    if (NO == repoPath.isAbsolutePath) {
+        repoPath = [[NSFileManager.defaultManager currentDirectoryPath] stringByAppendingPathComponent:repoPath];
+    }
+    repoPath = [repoPath stringByStandardizingPath];
+
+    NSArray<NSString *> *optionsFilePaths = @[
+        [repoPath stringByAppendingPathComponent:S7OptionsFileName],
+        [self userOptionsFilePath],
+    ];
+
+    NSMutableArray *optionsFileStamps = [NSMutableArray arrayWithCapacity:optionsFilePaths.count];
+    for (NSString *optionsFilePath in optionsFilePaths) {
+        [optionsFileStamps addObject:fileStampAtPath(optionsFilePath)];
+    }
+
+    static NSMutableDictionary<NSString *, S7Options *> *repoPathToOptions = nil;
+    static NSMutableDictionary<NSString *, NSArray *> *repoPathToOptionsFileStamps = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        repoPathToOptions = [NSMutableDictionary new];
+        repoPathToOptionsFileStamps = [NSMutableDictionary new];
+    });
+
+    // checkout asks for options from multiple threads
+    @synchronized (repoPathToOptions) {
+        S7Options *options = repoPathToOptions[repoPath];
+        if (options && [repoPathToOptionsFileStamps[repoPath] isEqualToArray:optionsFileStamps]) {
+            return options;
+        }
+
+        options = [[S7Options alloc] initWithOptionsFilePaths:optionsFilePaths];
+        for (id<S7OptionsProtocol> optionsLevel in options.optionsChain) {
+            if ([optionsLevel isKindOfClass:[S7IniConfigOptions class]]) {
+                [(S7IniConfigOptions *)optionsLevel parseAllOptions];
+            }
+        }
+
+        repoPathToOptions[repoPath] = options;
+        repoPathToOptionsFileStamps[repoPath] = optionsFileStamps;
+        return options;
+    }
+}
+
+- (instancetype)initWithOptionsChain:(NSArray<id<S7OptionsProtocol>> *)optionsChain {
+    if (nil == (self = [super init])) {
+        return nil;
+    }
+
+    _optionsChain = optionsChain;
+
+    return self;
+}
+
+- (S7Options *)optionsForSubrepoAtPath:(NSString *)subrepoPath {
+    NSMutableArray<id<S7OptionsProtocol>> *optionsChain = [NSMutableArray arrayWithCapacity:self.optionsChain.count * 2];
+
+    for (id<S7OptionsProtocol> options in self.optionsChain) {
+        if ([options isKindOfClass:[S7IniConfigOptions class]]) {
+            S7IniConfigOptions *subrepoOptions = [(S7IniConfigOptions *)options optionsForSubrepoAtPath:subrepoPath];
+            if (subrepoOptions) {
+                [optionsChain addObject:subrepoOptions];
+            }
+        }
+
+        [optionsChain addObject:options];
+    }
+
+    return [[S7Options alloc] initWithOptionsChain:optionsChain];
+}
+
 #pragma mark - Properties -
 
 - (nullable NSSet<S7TransportProtocolName> *)allowedTransportProtocols {
@@ -84,6 +161,129 @@ NSString * const S7UserOptionsFilePath = @"~/.s7options";
     return GitFilterUnspecified;
 }
 
+- (nullable NSNumber *)depth {
+    for (id<S7OptionsProtocol> options in self.optionsChain) {
+        NSNumber *depth = options.depth;
+
+        if (nil != depth) {
+            return depth;
+        }
+    }
+
+    return nil;
+}
+
+- (nullable NSString *)shallowSince {
+    for (id<S7OptionsProtocol> options in self.optionsChain) {
+        NSString *shallowSince = options.shallowSince;
+
+        if (nil != shallowSince) {
+            return shallowSince;
+        }
+    }
+
+    return nil;
+}
+
+- (nullable NSArray<NSString *> *)sparseCheckoutDirectories {
+    for (id<S7OptionsProtocol> options in self.optionsChain) {
+        NSArray<NSString *> *sparseCheckoutDirectories = options.sparseCheckoutDirectories;
+
+        if (nil != sparseCheckoutDirectories) {
+            return sparseCheckoutDirectories;
+        }
+    }
+
+    return nil;
+}
+
+- (nullable NSString *)bundleDirectory {
+    for (id<S7OptionsProtocol> options in self.optionsChain) {
+        NSString *bundleDirectory = options.bundleDirectory;
+
+        if (nil != bundleDirectory) {
+            return bundleDirectory;
+        }
+    }
+
+    return nil;
+}
+
+- (nullable NSNumber *)jobs {
+    for (id<S7OptionsProtocol> options in self.optionsChain) {
+        NSNumber *jobs = options.jobs;
+
+        if (nil != jobs) {
+            return jobs;
+        }
+    }
+
+    return nil;
+}
+
+- (nullable NSNumber *)lfsDeferred {
+    for (id<S7OptionsProtocol> options in self.optionsChain) {
+        NSNumber *lfsDeferred = options.lfsDeferred;
+
+        if (nil != lfsDeferred) {
+            return lfsDeferred;
+        }
+    }
+
+    return nil;
+}
+
+- (nullable NSNumber *)sshMultiplexing {
+    for (id<S7OptionsProtocol> options in self.optionsChain) {
+        NSNumber *sshMultiplexing = options.sshMultiplexing;
+
+        if (nil != sshMultiplexing) {
+            return sshMultiplexing;
+        }
+    }
+
+    return nil;
+}
+
+// unlike other options, rules of all levels are combined. Repo rules go first,
+// thus win over user ones for the same prefix
+- (nullable NSArray<GitURLMirror *> *)urlMirrors {
+    NSMutableArray<GitURLMirror *> *urlMirrors = [NSMutableArray new];
+    for (id<S7OptionsProtocol> options in self.optionsChain) {
+        NSArray<GitURLMirror *> *levelURLMirrors = options.urlMirrors;
+
+        if (nil != levelURLMirrors) {
+            [urlMirrors addObjectsFromArray:levelURLMirrors];
+        }
+    }
+
+    return urlMirrors.count > 0 ? urlMirrors : nil;
+}
+
+- (NSUInteger)maxConcurrentJobs {
+    return MAX(1, self.jobs.unsignedIntegerValue);
+}
+
+- (GitCloneOptions *)cloneOptions {
+    GitCloneOptions *cloneOptions = [GitCloneOptions optionsWithFilter:self.filter];
+
+    // `depth` and `shallow-since` are two ways to say the same thing, thus
+    // the most specific options level that mentions any of them wins
+    for (id<S7OptionsProtocol> options in self.optionsChain) {
+        NSNumber *depth = options.depth;
+        NSString *shallowSince = options.shallowSince;
+
+        if (nil != depth || nil != shallowSince) {
+            cloneOptions.depth = depth.unsignedIntegerValue;
+            cloneOptions.shallowSince = shallowSince;
+            break;
+        }
+    }
+
+    cloneOptions.sparseCheckoutDirectories = self.sparseCheckoutDirectories;
+    return cloneOptions;
+}
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -9,6 +9,7 @@
 #import <Foundation/Foundation.h>
 #import "S7TransportProtocolName.h"
 #import "GitFilter.h"
+#import "GitURLMirror.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -16,6 +17,22 @@ NS_ASSUME_NONNULL_BEGIN
 
 @property (nonatomic, readonly, nullable) NSSet<S7TransportProtocolName> *allowedTransportProtocols;
 @property (nonatomic, readonly) GitFilter filter;
+// nil means 'unspecified', @0 – full history
+@property (nonatomic, readonly, nullable) NSNumber *depth;
+@property (nonatomic, readonly, nullable) NSString *shallowSince;
+@property (nonatomic, readonly, nullable) NSArray<NSString *> *sparseCheckoutDirectories;
+// directory with subrepo bundles created by `s7 bundle create`
+@property (nonatomic, readonly, nullable) NSString *bundleDirectory;
+// max number of subrepos processed concurrently
+@property (nonatomic, readonly, nullable) NSNumber *jobs;
+// `lfs = deferred`: check out subrepos with LFS smudge skipped, and then download
+// LFS content of all of them in one parallel pass. nil means 'unspecified'
+@property (nonatomic, readonly, nullable) NSNumber *lfsDeferred;
+// `ssh-multiplexing = true`: all ssh connections s7 makes to a host during one run go through
+// a single master connection. nil means 'unspecified'
+@property (nonatomic, readonly, nullable) NSNumber *sshMultiplexing;
+// `[mirror "<prefix>"]` rules
+@property (nonatomic, readonly, nullable) NSArray<GitURLMirror *> *urlMirrors;
 
 @end
 
@@ -0,0 +1,35 @@
+//
+//  S7ConfigJournal.h
+//  system7
+//
+//  Copyright © 2026 Readdle. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class GitRepository;
+
+// Journal of .s7substate contents at revisions s7 has already read, kept in .git/s7journal.
+//
+// Hooks, commands and `s7 status` ask for the config at HEAD (and at other revisions)
+// over and over again, and every time it used to cost a `git show`. Config at a revision
+// never changes, so once read, it's recorded here and never asked from Git again.
+//
+// Only full hashes are journaled – 'HEAD', branch names, etc. may point elsewhere tomorrow.
+// Journal keeps the most recent entries only. Anything wrong with the file is treated
+// as an empty journal – callers fall back to Git.
+//
+@interface S7ConfigJournal : NSObject
+
++ (nullable NSString *)configContentsAtRevision:(NSString *)revision inRepo:(GitRepository *)repo;
++ (void)recordConfigContents:(NSString *)configContents atRevision:(NSString *)revision inRepo:(GitRepository *)repo;
+// configs s7 has read lately, most recent first
++ (NSArray<NSString *> *)recentConfigContentsInRepo:(GitRepository *)repo;
+
++ (NSString *)journalPathInRepo:(GitRepository *)repo;
+
+@end
+
+NS_ASSUME_NONNULL_END
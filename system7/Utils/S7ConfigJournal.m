@@ -0,0 +1,144 @@
+//
+//  S7ConfigJournal.m
+//  system7
+//
+//  Copyright © 2026 Readdle. All rights reserved.
+//
+
+#import "S7ConfigJournal.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+static NSString * const S7ConfigJournalFileName = @"s7journal";
+static const NSUInteger S7ConfigJournalVersion = 1;
+// enough for branch switches back and forth, and for a push of a bunch of commits
+static const NSUInteger S7ConfigJournalMaxNumberOfEntries = 32;
+
+static NSString * const S7ConfigJournalVersionKey = @"version";
+static NSString * const S7ConfigJournalEntriesKey = @"entries";
+static NSString * const S7ConfigJournalRevisionKey = @"revision";
+static NSString * const S7ConfigJournalConfigKey = @"config";
+
+static BOOL isFullRevisionHash(NSString *revision) {
+    if (40 != revision.length && 64 != revision.length) {
+        return NO;
+    }
+
+    NSCharacterSet *nonHexCharacters = [[NSCharacterSet characterSetWithCharactersInString:@"0123456789abcdef"] invertedSet];
+    return NSNotFound == [revision rangeOfCharacterFromSet:nonHexCharacters].location;
+}
+
+@implementation S7ConfigJournal
+
++ (NSString *)journalPathInRepo:(GitRepository *)repo {
+    NSString *gitDirPath = repo.isBareRepo
+    ? repo.absolutePath
+    : [repo.absolutePath stringByAppendingPathComponent:@".git"];
+    return [gitDirPath stringByAppendingPathComponent:S7ConfigJournalFileName];
+}
+
+// most recent entry goes last
++ (NSArray<NSDictionary<NSString *, NSString *> *> *)readEntriesFromFileAtPath:(NSString *)journalPath {
+    NSData *data = [NSData dataWithContentsOfFile:journalPath];
+    if (nil == data) {
+        return @[];
+    }
+
+    NSDictionary *journal = [NSJSONSerialization JSONObjectWithData:data options:0 error:nil];
+    if (NO == [journal isKindOfClass:[NSDictionary class]]
+        || NO == [journal[S7ConfigJournalVersionKey] isEqual:@(S7ConfigJournalVersion)])
+    {
+        return @[];
+    }
+
+    NSArray *entries = journal[S7ConfigJournalEntriesKey];
+    if (NO == [entries isKindOfClass:[NSArray class]]) {
+        return @[];
+    }
+
+    NSMutableArray<NSDictionary<NSString *, NSString *> *> *validEntries = [NSMutableArray arrayWithCapacity:entries.count];
+    for (NSDictionary *entry in entries) {
+        if ([entry isKindOfClass:[NSDictionary class]]
+            && [entry[S7ConfigJournalRevisionKey] isKindOfClass:[NSString class]]
+            && [entry[S7ConfigJournalConfigKey] isKindOfClass:[NSString class]])
+        {
+            [validEntries addObject:entry];
+        }
+    }
+
+    return validEntries;
+}
+
++ (nullable NSString *)configContentsAtRevision:(NSString *)revision inRepo:(GitRepository *)repo {
+    if (NO == isFullRevisionHash(revision)) {
+        return nil;
+    }
+
+    NSString *journalPath = [self journalPathInRepo:repo];
+
+    @synchronized (self) {
+        for (NSDictionary<NSString *, NSString *> *entry in [self readEntriesFromFileAtPath:journalPath].reverseObjectEnumerator) {
+            if ([entry[S7ConfigJournalRevisionKey] isEqualToString:revision]) {
+                return entry[S7ConfigJournalConfigKey];
+            }
+        }
+    }
+
+    return nil;
+}
+
++ (NSArray<NSString *> *)recentConfigContentsInRepo:(GitRepository *)repo {
+    NSString *journalPath = [self journalPathInRepo:repo];
+
+    NSMutableOrderedSet<NSString *> *configs = [NSMutableOrderedSet new];
+    @synchronized (self) {
+        for (NSDictionary<NSString *, NSString *> *entry in [self readEntriesFromFileAtPath:journalPath].reverseObjectEnumerator) {
+            [configs addObject:entry[S7ConfigJournalConfigKey]];
+        }
+    }
+
+    return configs.array;
+}
+
++ (void)recordConfigContents:(NSString *)configContents atRevision:(NSString *)revision inRepo:(GitRepository *)repo {
+    if (NO == isFullRevisionHash(revision)) {
+        return;
+    }
+
+    NSString *journalPath = [self journalPathInRepo:repo];
+
+    // nested hooks of other s7 processes may write the same journal. The file is replaced atomically,
+    // so the worst thing that can happen is a lost entry, and it will be just read from Git once again
+    @synchronized (self) {
+        NSMutableArray<NSDictionary<NSString *, NSString *> *> *entries = [[self readEntriesFromFileAtPath:journalPath] mutableCopy];
+
+        NSIndexSet *sameRevisionIndices = [entries indexesOfObjectsPassingTest:^BOOL(NSDictionary<NSString *, NSString *> * _Nonnull entry, NSUInteger idx, BOOL * _Nonnull stop) {
+            return [entry[S7ConfigJournalRevisionKey] isEqualToString:revision];
+        }];
+        [entries removeObjectsAtIndexes:sameRevisionIndices];
+
+        [entries addObject:@{
+            S7ConfigJournalRevisionKey : revision,
+            S7ConfigJournalConfigKey : configContents,
+        }];
+
+        if (entries.count > S7ConfigJournalMaxNumberOfEntries) {
+            [entries removeObjectsInRange:NSMakeRange(0, entries.count - S7ConfigJournalMaxNumberOfEntries)];
+        }
+
+        NSDictionary *journal = @{
+            S7ConfigJournalVersionKey : @(S7ConfigJournalVersion),
+            S7ConfigJournalEntriesKey : entries,
+        };
+
+        NSData *data = [NSJSONSerialization dataWithJSONObject:journal options:0 error:nil];
+        if (nil == data || NO == [data writeToFile:journalPath atomically:YES]) {
+            // not a big deal – config will be read from Git next time
+            logError("failed to write %s\n", journalPath.fileSystemRepresentation);
+        }
+    }
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
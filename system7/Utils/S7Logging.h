@@ -13,4 +13,39 @@ NS_ASSUME_NONNULL_BEGIN
 void logInfo(const char * __restrict, ...) __printflike(1, 2);
 void logError(const char * __restrict, ...) __printflike(1, 2);
 
+// Logging context of a single task (usually – work on a single subrepo)
+// that runs in parallel with others.
+//
+// While a context is active on a thread, everything logInfo/logError print on
+// that thread is collected in the context's own buffer – no locks, no allocations
+// per line. Once the task is done, the buffer is printed out as one block with
+// a single acquisition of the console lock.
+//
+// If context has a label, and stdout is a terminal, then lines are not held till
+// the end of the task, but printed as soon as they are complete, prefixed with
+// the label. That's for long operations (like clone), where user wants to see
+// the progress.
+//
+@interface S7LogContext : NSObject
+@property (nonatomic, readonly, nullable) NSString *prefix;
+@property (nonatomic, readonly, getter=isStreaming) BOOL streaming;
+@end
+
+// Contexts can be nested – every begin must be paired with an end on the same thread.
+// Nested context's label is appended to the outer context prefix.
+S7LogContext *beginLogContext(NSString * _Nullable label);
+// Same, but the outer context is passed explicitly. That's for tasks that run on
+// a worker thread on behalf of a task from another thread – the worker thread has
+// no context of its own, but the output still belongs to that outer task.
+S7LogContext *beginLogContextWithOuterContext(NSString * _Nullable label, S7LogContext * _Nullable outerContext);
+void endLogContext(S7LogContext *context);
+
+// Context active on the current thread, if any
+S7LogContext * _Nullable currentLogContext(void);
+
+// Prints out everything collected by the (already ended) context, so that no other
+// thread can squeeze in the middle of it. If `destination` is passed, output is
+// appended to it instead – that's for tasks run on behalf of an outer task.
+void flushLogContext(S7LogContext *context, S7LogContext * _Nullable destination);
+
 NS_ASSUME_NONNULL_END
@@ -16,6 +16,8 @@ void withTTYLockDo(void(NS_NOESCAPE ^block)(void)) {
     //
     // This doesn't prevent logical soup of course – that's clients responsibility to
     // control how they structure multithreaded logging, so that the end user can understand anything
+    //
+    // Parallel tasks log through S7LogContext, and take this lock once per task, not once per line.
 
     static NSLock *ttyLock = nil;
     static dispatch_once_t onceToken;
@@ -35,50 +37,319 @@ BOOL canUseColorForOutputToFile(int fileno) {
     return isatty(fileno) && term != NULL && strcasecmp(term, "dumb") != 0;
 }
 
-char *formatMessage(const char * __restrict format, va_list *args) {
-    va_list args_copy;
-    va_copy(args_copy, *args);
-    const int writtenSize = vsnprintf(nil, 0, format, args_copy);
-    va_end(args_copy);
+static void printInfo(const char *message, size_t length) {
+    fwrite(message, 1, length, stdout);
+}
+
+static void printError(const char *message, size_t length) {
+    if (canUseColorForOutputToFile(fileno(stderr))) {
+        fputs("\033[31m", stderr);
+        fwrite(message, 1, length, stderr);
+        fputs("\033[0m", stderr);
+    }
+    else {
+        fputs("ERROR: ", stderr);
+        fwrite(message, 1, length, stderr);
+    }
+}
+
+#pragma mark - log context -
+
+typedef struct {
+    size_t offset;
+    size_t length;
+    BOOL isError;
+} S7LogRecord;
 
-    const size_t bufferSize = writtenSize + 1;
-    char *const buffer = malloc(bufferSize);
-    vsnprintf(buffer, bufferSize, format, *args);
+// a thread is always busy with one task at a time, so the plain C thread-local
+// is enough. The context itself is retained by whoever began it till the end.
+static __thread __unsafe_unretained S7LogContext *currentContext = nil;
 
-    return buffer;
+@interface S7LogContext () {
+    char *_arena;
+    size_t _arenaLength;
+    size_t _arenaCapacity;
+
+    S7LogRecord *_records;
+    size_t _recordsCount;
+    size_t _recordsCapacity;
+
+    BOOL _atLineStart;
 }
 
-void logInfo(const char * __restrict format, ...) {
-    va_list args;
-    va_start(args, format);
-    char *const message = formatMessage(format, &args);
-    va_end(args);
+@property (nonatomic, strong, nullable) S7LogContext *outerContext;
+// context that was active on the thread before this one began. Usually it's the
+// outer context, but not if the outer context was passed explicitly
+@property (nonatomic, strong, nullable) S7LogContext *previousThreadContext;
+
+@end
+
+@implementation S7LogContext
+
+- (instancetype)initWithOuterContext:(nullable S7LogContext *)outerContext label:(nullable NSString *)label {
+    self = [super init];
+    if (nil == self) {
+        return nil;
+    }
+
+    _outerContext = outerContext;
+    _atLineStart = YES;
+
+    if (label.length > 0) {
+        _prefix = outerContext.prefix.length > 0
+            ? [outerContext.prefix stringByAppendingFormat:@"/%@", label]
+            : [label copy];
+    }
+    else {
+        _prefix = outerContext.prefix;
+    }
+
+    // If outer context buffers, then we must buffer too – otherwise our lines
+    // would jump ahead of the outer task's lines. A context without own label
+    // buffers as well, and hands over its lines to the streaming outer context at flush.
+    //
+    static BOOL isStdOutTerminal = NO;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        isStdOutTerminal = isatty(fileno(stdout));
+    });
+
+    _streaming = isStdOutTerminal && label.length > 0 && (nil == outerContext || outerContext.isStreaming);
+
+    return self;
+}
+
+- (void)dealloc {
+    free(_arena);
+    free(_records);
+}
+
+- (void)ensureArenaCapacity:(size_t)requiredCapacity {
+    if (requiredCapacity <= _arenaCapacity) {
+        return;
+    }
+
+    size_t newCapacity = MAX(_arenaCapacity * 2, 1024);
+    while (newCapacity < requiredCapacity) {
+        newCapacity *= 2;
+    }
+
+    _arena = reallocf(_arena, newCapacity);
+    _arenaCapacity = newCapacity;
+}
+
+- (void)addRecordWithOffset:(size_t)offset length:(size_t)length isError:(BOOL)isError {
+    if (0 == length) {
+        return;
+    }
+
+    // glue consecutive pieces of the same kind – rebind, for example,
+    // prints a single line in two calls
+    if (_recordsCount > 0) {
+        S7LogRecord *lastRecord = &_records[_recordsCount - 1];
+        if (lastRecord->isError == isError && lastRecord->offset + lastRecord->length == offset) {
+            lastRecord->length += length;
+            return;
+        }
+    }
+
+    if (_recordsCount == _recordsCapacity) {
+        _recordsCapacity = MAX(_recordsCapacity * 2, 16);
+        _records = reallocf(_records, _recordsCapacity * sizeof(S7LogRecord));
+    }
+
+    _records[_recordsCount++] = (S7LogRecord){ offset, length, isError };
+}
+
+- (void)appendFormat:(const char *)format arguments:(va_list)args isError:(BOOL)isError {
+    [self ensureArenaCapacity:_arenaLength + 256];
+
+    va_list argsCopy;
+    va_copy(argsCopy, args);
+    const int writtenSize = vsnprintf(_arena + _arenaLength, _arenaCapacity - _arenaLength, format, argsCopy);
+    va_end(argsCopy);
+
+    if (writtenSize < 0) {
+        return;
+    }
+
+    if ((size_t)writtenSize >= _arenaCapacity - _arenaLength) {
+        [self ensureArenaCapacity:_arenaLength + writtenSize + 1];
+        vsnprintf(_arena + _arenaLength, _arenaCapacity - _arenaLength, format, args);
+    }
+
+    [self appendBytes:NULL length:writtenSize isError:isError];
+}
+
+// bytes == NULL means that bytes are already written to the end of the arena
+- (void)appendBytes:(nullable const char *)bytes length:(size_t)length isError:(BOOL)isError {
+    if (bytes) {
+        [self ensureArenaCapacity:_arenaLength + length];
+        memcpy(_arena + _arenaLength, bytes, length);
+    }
+
+    [self addRecordWithOffset:_arenaLength length:length isError:isError];
+    _arenaLength += length;
+
+    if (self.isStreaming && length > 0 && memchr(_arena + _arenaLength - length, '\n', length)) {
+        [self printCollectedRecords];
+    }
+}
+
+- (void)appendRecordsOfContext:(S7LogContext *)context {
+    @synchronized (self) {
+        for (size_t i = 0; i < context->_recordsCount; ++i) {
+            const S7LogRecord record = context->_records[i];
+            [self appendBytes:context->_arena + record.offset length:record.length isError:record.isError];
+        }
+    }
+}
+
+- (void)printPrefixedBytes:(const char *)bytes length:(size_t)length isError:(BOOL)isError {
+    void (*print)(const char *, size_t) = isError ? printError : printInfo;
+
+    FILE *stream = isError ? stderr : stdout;
+    const char *prefix = [self.prefix cStringUsingEncoding:NSUTF8StringEncoding];
+    const BOOL useColor = canUseColorForOutputToFile(fileno(stream));
+
+    const char *end = bytes + length;
+    while (bytes < end) {
+        if (_atLineStart) {
+            if (useColor) {
+                fprintf(stream, "\033[2m%s |\033[0m ", prefix);
+            }
+            else {
+                fprintf(stream, "%s | ", prefix);
+            }
+        }
+
+        const char *newLine = memchr(bytes, '\n', end - bytes);
+        const char *chunkEnd = newLine ? newLine + 1 : end;
+        print(bytes, chunkEnd - bytes);
+
+        _atLineStart = (NULL != newLine);
+        bytes = chunkEnd;
+    }
+}
+
+- (void)printCollectedRecords {
+    if (0 == _recordsCount) {
+        return;
+    }
 
     withTTYLockDo(^{
-        fprintf(stdout, "%s", message);
+        for (size_t i = 0; i < self->_recordsCount; ++i) {
+            const S7LogRecord record = self->_records[i];
+            if (self.isStreaming) {
+                [self printPrefixedBytes:self->_arena + record.offset length:record.length isError:record.isError];
+            }
+            else if (record.isError) {
+                printError(self->_arena + record.offset, record.length);
+            }
+            else {
+                printInfo(self->_arena + record.offset, record.length);
+            }
+        }
+
+        fflush(stdout);
     });
 
-    free(message);
+    // everything's out – reuse the arena
+    _arenaLength = 0;
+    _recordsCount = 0;
 }
 
-void logError(const char * __restrict format, ...) {
-    va_list args;
-    va_start(args, format);
-    char *const message = formatMessage(format, &args);
-    va_end(args);
+@end
+
+S7LogContext * _Nullable currentLogContext(void) {
+    return currentContext;
+}
+
+S7LogContext *beginLogContext(NSString * _Nullable label) {
+    return beginLogContextWithOuterContext(label, currentContext);
+}
+
+S7LogContext *beginLogContextWithOuterContext(NSString * _Nullable label, S7LogContext * _Nullable outerContext) {
+    S7LogContext *context = [[S7LogContext alloc] initWithOuterContext:outerContext label:label];
+    context.previousThreadContext = currentContext;
+    currentContext = context;
+    return context;
+}
+
+void endLogContext(S7LogContext *context) {
+    NSCAssert(currentContext == context, @"unbalanced begin/end of log context");
+    currentContext = context.previousThreadContext;
+    context.previousThreadContext = nil;
+    context.outerContext = nil;
+
+    if (context.isStreaming) {
+        // the last line might be incomplete
+        [context printCollectedRecords];
+    }
+}
+
+void flushLogContext(S7LogContext *context, S7LogContext * _Nullable destination) {
+    NSCAssert(currentContext != context, @"please, end the context first");
+
+    if (destination) {
+        [destination appendRecordsOfContext:context];
+        return;
+    }
+
+    [context printCollectedRecords];
+}
+
+#pragma mark - log -
+
+static void logMessage(BOOL isError, const char * __restrict format, va_list args) {
+    S7LogContext *context = currentContext;
+    if (context) {
+        [context appendFormat:format arguments:args isError:isError];
+        return;
+    }
+
+    // most messages are short. No need to go to heap for them
+    char stackBuffer[512];
+    char *message = stackBuffer;
+
+    va_list argsCopy;
+    va_copy(argsCopy, args);
+    const int writtenSize = vsnprintf(stackBuffer, sizeof(stackBuffer), format, argsCopy);
+    va_end(argsCopy);
+
+    if (writtenSize < 0) {
+        return;
+    }
+
+    if ((size_t)writtenSize >= sizeof(stackBuffer)) {
+        message = malloc(writtenSize + 1);
+        vsnprintf(message, writtenSize + 1, format, args);
+    }
 
     withTTYLockDo(^{
-        if (canUseColorForOutputToFile(fileno(stderr))) {
-            fprintf(stderr,
-                    "\033[31m"
-                    "%s"
-                    "\033[0m",
-                    message);
+        if (isError) {
+            printError(message, writtenSize);
         }
         else {
-            fprintf(stderr, "ERROR: %s", message);
+            printInfo(message, writtenSize);
         }
     });
 
-    free(message);
+    if (message != stackBuffer) {
+        free(message);
+    }
+}
+
+void logInfo(const char * __restrict format, ...) {
+    va_list args;
+    va_start(args, format);
+    logMessage(NO, format, args);
+    va_end(args);
+}
+
+void logError(const char * __restrict format, ...) {
+    va_list args;
+    va_start(args, format);
+    logMessage(YES, format, args);
+    va_end(args);
 }
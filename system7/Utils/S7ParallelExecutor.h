@@ -0,0 +1,57 @@
+//
+//  S7ParallelExecutor.h
+//  system7
+//
+//  Copyright © 2026 Readdle. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_ENUM(NSUInteger, S7ParallelExecutionErrorPolicy) {
+    // every task is run, no matter how many of them fail
+    S7ParallelExecutionErrorPolicyAllErrors,
+    // once any task fails, tasks that haven't started yet are skipped
+    S7ParallelExecutionErrorPolicyFirstError,
+};
+
+// Runs per-subrepo work concurrently.
+//
+// Everything a task logs is buffered and printed out as one block once the task
+// is done. Blocks are printed in the order of task indices, so the output looks
+// exactly like if tasks were run one after another.
+//
+// If tasks have labels (see S7LogContext), and output goes to a terminal,
+// then tasks' lines are printed live, prefixed with the label.
+//
+@interface S7ParallelExecutor : NSObject
+
+// a git process per core – that's how wide checkout has always been.
+// Network-bound operations may want more (see `jobs` option)
++ (NSUInteger)defaultMaxConcurrentTasks;
+
+// Returns exit code of the failed task with the lowest index,
+// or S7ExitCodeSuccess if all tasks succeeded.
++ (int)runTasks:(NSUInteger)numberOfTasks
+    errorPolicy:(S7ParallelExecutionErrorPolicy)errorPolicy
+           task:(int (NS_NOESCAPE ^)(NSUInteger i))task;
+
++ (int)runTasks:(NSUInteger)numberOfTasks
+    errorPolicy:(S7ParallelExecutionErrorPolicy)errorPolicy
+maxConcurrentTasks:(NSUInteger)maxConcurrentTasks
+           task:(int (NS_NOESCAPE ^)(NSUInteger i))task;
+
+// one task per label
++ (int)runTasksWithLabels:(NSArray<NSString *> *)taskLabels
+              errorPolicy:(S7ParallelExecutionErrorPolicy)errorPolicy
+                     task:(int (NS_NOESCAPE ^)(NSUInteger i))task;
+
++ (int)runTasksWithLabels:(NSArray<NSString *> *)taskLabels
+              errorPolicy:(S7ParallelExecutionErrorPolicy)errorPolicy
+       maxConcurrentTasks:(NSUInteger)maxConcurrentTasks
+                     task:(int (NS_NOESCAPE ^)(NSUInteger i))task;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,166 @@
+//
+//  S7ParallelExecutor.m
+//  system7
+//
+//  Copyright © 2026 Readdle. All rights reserved.
+//
+
+#import "S7ParallelExecutor.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@implementation S7ParallelExecutor
+
++ (NSUInteger)defaultMaxConcurrentTasks {
+    return MAX(1, NSProcessInfo.processInfo.activeProcessorCount);
+}
+
++ (int)runTasks:(NSUInteger)numberOfTasks
+    errorPolicy:(S7ParallelExecutionErrorPolicy)errorPolicy
+           task:(int (NS_NOESCAPE ^)(NSUInteger i))task
+{
+    return [self runTasks:numberOfTasks
+              errorPolicy:errorPolicy
+       maxConcurrentTasks:[self defaultMaxConcurrentTasks]
+                     task:task];
+}
+
++ (int)runTasks:(NSUInteger)numberOfTasks
+    errorPolicy:(S7ParallelExecutionErrorPolicy)errorPolicy
+maxConcurrentTasks:(NSUInteger)maxConcurrentTasks
+           task:(int (NS_NOESCAPE ^)(NSUInteger i))task
+{
+    return [self runTasks:numberOfTasks
+               taskLabels:nil
+              errorPolicy:errorPolicy
+       maxConcurrentTasks:maxConcurrentTasks
+                     task:task];
+}
+
++ (int)runTasksWithLabels:(NSArray<NSString *> *)taskLabels
+              errorPolicy:(S7ParallelExecutionErrorPolicy)errorPolicy
+                     task:(int (NS_NOESCAPE ^)(NSUInteger i))task
+{
+    return [self runTasksWithLabels:taskLabels
+                        errorPolicy:errorPolicy
+                 maxConcurrentTasks:[self defaultMaxConcurrentTasks]
+                               task:task];
+}
+
++ (int)runTasksWithLabels:(NSArray<NSString *> *)taskLabels
+              errorPolicy:(S7ParallelExecutionErrorPolicy)errorPolicy
+       maxConcurrentTasks:(NSUInteger)maxConcurrentTasks
+                     task:(int (NS_NOESCAPE ^)(NSUInteger i))task
+{
+    return [self runTasks:taskLabels.count
+               taskLabels:taskLabels
+              errorPolicy:errorPolicy
+       maxConcurrentTasks:maxConcurrentTasks
+                     task:task];
+}
+
++ (int)runTasks:(NSUInteger)numberOfTasks
+     taskLabels:(nullable NSArray<NSString *> *)taskLabels
+    errorPolicy:(S7ParallelExecutionErrorPolicy)errorPolicy
+maxConcurrentTasks:(NSUInteger)maxConcurrentTasks
+           task:(int (NS_NOESCAPE ^)(NSUInteger i))task
+{
+    NSParameterAssert(nil == taskLabels || taskLabels.count == numberOfTasks);
+
+    if (0 == numberOfTasks) {
+        return S7ExitCodeSuccess;
+    }
+
+    // if we are a task of some outer executor ourselves, then our output
+    // must end up in that task's block, not on the console. Tasks run on
+    // worker threads which know nothing about that task, so its context
+    // is passed to them explicitly
+    S7LogContext *outerLogContext = currentLogContext();
+
+    NSObject *lock = [NSObject new];
+    NSMutableDictionary<NSNumber *, S7LogContext *> *completedTaskLogContexts = [NSMutableDictionary new];
+    __block NSUInteger nextTaskToStart = 0;
+    __block NSUInteger nextTaskToFlush = 0;
+    __block NSUInteger failedTaskIndex = NSNotFound;
+    __block int failedTaskExitCode = S7ExitCodeSuccess;
+
+    void (^runTask)(NSUInteger i) = ^(NSUInteger i) {
+        BOOL skip = NO;
+        if (S7ParallelExecutionErrorPolicyFirstError == errorPolicy) {
+            @synchronized (lock) {
+                skip = (NSNotFound != failedTaskIndex);
+            }
+        }
+
+        int exitCode = S7ExitCodeSuccess;
+        S7LogContext *logContext = beginLogContextWithOuterContext(taskLabels[i], outerLogContext);
+        if (NO == skip) {
+            exitCode = task(i);
+        }
+        endLogContext(logContext);
+
+        @synchronized (lock) {
+            if (S7ExitCodeSuccess != exitCode && (NSNotFound == failedTaskIndex || i < failedTaskIndex)) {
+                failedTaskIndex = i;
+                failedTaskExitCode = exitCode;
+            }
+
+            completedTaskLogContexts[@(i)] = logContext;
+
+            while (nextTaskToFlush < numberOfTasks) {
+                S7LogContext *contextToFlush = completedTaskLogContexts[@(nextTaskToFlush)];
+                if (nil == contextToFlush) {
+                    break;
+                }
+
+                flushLogContext(contextToFlush, outerLogContext);
+                [completedTaskLogContexts removeObjectForKey:@(nextTaskToFlush)];
+                ++nextTaskToFlush;
+            }
+        }
+    };
+
+    // Every worker takes the next task once it's done with the previous one, so exactly
+    // maxConcurrentTasks tasks run at a time. Unlike dispatch_apply, that's not limited by
+    // the number of cores (network-bound tasks, like fetch, gain from more), and doesn't
+    // shrink when executors are nested – GCD splits the width of a nested dispatch_apply
+    // between the outer one's iterations.
+    //
+    void (^runWorker)(void) = ^{
+        while (YES) {
+            NSUInteger i = NSNotFound;
+            @synchronized (lock) {
+                if (nextTaskToStart < numberOfTasks) {
+                    i = nextTaskToStart++;
+                }
+            }
+
+            if (NSNotFound == i) {
+                return;
+            }
+
+            runTask(i);
+        }
+    };
+
+    const NSUInteger numberOfWorkers = MIN(MAX(1, maxConcurrentTasks), numberOfTasks);
+
+    dispatch_queue_t workersQueue = dispatch_queue_create("com.readdle.s7.parallel-executor", DISPATCH_QUEUE_CONCURRENT);
+    dispatch_group_t workersGroup = dispatch_group_create();
+    for (NSUInteger w = 1; w < numberOfWorkers; ++w) {
+        dispatch_group_async(workersGroup, workersQueue, runWorker);
+    }
+
+    // the calling thread would wait anyway – let it work as well
+    runWorker();
+
+    dispatch_group_wait(workersGroup, DISPATCH_TIME_FOREVER);
+
+    NSAssert(nextTaskToFlush == numberOfTasks, @"");
+
+    return failedTaskExitCode;
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
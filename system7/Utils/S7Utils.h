@@ -36,6 +36,10 @@ int saveUpdatedConfigToMainAndControlFile(S7Config *updatedConfig);
 
 BOOL S7ArgumentMatchesFlag(NSString *argument, NSString *longFlag, NSString *shortFlag);
 
+// Identity of file contents on disk – inode, size and modification date, – cheap to get
+// with a single stat. Used to invalidate caches of parsed config files. NSNull for a missing file.
+id fileStampAtPath(NSString *filePath);
+
 #define S7_REPO_PRECONDITION_CHECK()                    \
     do {                                                \
         const int result = s7RepoPreconditionCheck();   \
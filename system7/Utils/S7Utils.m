@@ -8,6 +8,7 @@
 
 #import "S7Utils.h"
 #import "S7BootstrapCommand.h"
+#import "S7ConfigJournal.h"
 
 int executeInDirectory(NSString *directory, int (NS_NOESCAPE ^block)(void)) {
     NSString *cwd = [[NSFileManager defaultManager] currentDirectoryPath];
@@ -30,9 +31,18 @@ int executeInDirectory(NSString *directory, int (NS_NOESCAPE ^block)(void)) {
 }
 
 int getConfig(GitRepository *repo, NSString *revision, S7Config * _Nullable __autoreleasing * _Nonnull ppConfig) {
+    NSString *journaledConfigContents = [S7ConfigJournal configContentsAtRevision:revision inRepo:repo];
+    if (journaledConfigContents) {
+        *ppConfig = [[S7Config alloc] initWithContentsString:journaledConfigContents];
+        return S7ExitCodeSuccess;
+    }
+
     int showExitStatus = 0;
     NSString *configContents = [repo showFile:S7ConfigFileName atRevision:revision exitStatus:&showExitStatus];
-    if (0 != showExitStatus) {
+    if (0 == showExitStatus) {
+        [S7ConfigJournal recordConfigContents:configContents ?: @"" atRevision:revision inRepo:repo];
+    }
+    else {
         if (128 == showExitStatus) {
             // s7 config has been removed or we are back to revision where there was no s7 yet
             // this is a valid situation, so we just return an empty config
@@ -444,3 +454,18 @@ BOOL S7ArgumentMatchesFlag(NSString *argument, NSString *longFlag, NSString *sho
 
     return [argument isEqualToString:shortFlag] || [argument isEqualToString:longFlag];
 }
+
+id fileStampAtPath(NSString *filePath) {
+    // config files are usually rewritten via a lock file and rename, so inode changes
+    // on every write, and we are not at mercy of file system timestamp granularity
+    NSDictionary<NSFileAttributeKey, id> *attributes = [NSFileManager.defaultManager attributesOfItemAtPath:filePath error:nil];
+    if (nil == attributes) {
+        return NSNull.null;
+    }
+
+    return @[
+        attributes[NSFileSystemFileNumber] ?: NSNull.null,
+        attributes[NSFileSize] ?: NSNull.null,
+        attributes[NSFileModificationDate] ?: NSNull.null,
+    ];
+}
@@ -0,0 +1,38 @@
+//
+//  Git+Statistics.h
+//  system7
+//
+//  Copyright © 2026 Readdle. All rights reserved.
+//
+
+#import "Git.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Every git process s7 spawns is counted by its verb (`status`, `rev-parse`, etc.),
+// both for the whole s7 invocation and per repository the command was run in.
+// Most of s7 latency comes from the number of processes it forks, so these numbers
+// are a cheap and stable proxy for performance, which tests can put a budget on.
+//
+@interface GitRepository (Statistics)
+
+// S7_STATS environment variable is set to a positive integer
++ (BOOL)envStatsEnabled;
+
++ (void)resetSpawnStatistics;
+
++ (NSUInteger)numberOfSpawnedCommands;
+// verb -> count
++ (NSDictionary<NSString *, NSNumber *> *)numberOfSpawnedCommandsByVerb;
+// repo absolute path -> verb -> count
++ (NSDictionary<NSString *, NSDictionary<NSString *, NSNumber *> *> *)numberOfSpawnedCommandsByRepository;
+
+// number of commands spawned on behalf of this repository
+@property (nonatomic, readonly) NSUInteger numberOfSpawnedCommands;
+
+// prints the summary to stderr
++ (void)printSpawnStatistics;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -24,6 +24,9 @@ NS_ASSUME_NONNULL_BEGIN
                                                                                    token:(nullable NSString *)token
                                                                       processEnvironment:(NSDictionary<NSString *, NSString *> *)processEnvironment;
 
++ (nullable NSString *)sshMultiplexingCommandWithControlDirectory:(NSString *)controlDirectoryPath
+                                               processEnvironment:(NSDictionary<NSString *, NSString *> *)processEnvironment;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -8,6 +8,8 @@
 
 #import <Foundation/Foundation.h>
 #import "GitFilter.h"
+#import "GitCloneOptions.h"
+#import "GitURLMirror.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -52,11 +54,58 @@ NS_ASSUME_NONNULL_BEGIN
                               stdErrOutput:(NSString * _Nullable __autoreleasing * _Nullable)ppStdErrOutput
                                 exitStatus:(int *)exitStatus;
 
++ (nullable GitRepository *)cloneRepoAtURL:(NSString *)url
+                                    branch:(NSString * _Nullable)branch
+                                      bare:(BOOL)bare
+                           destinationPath:(NSString *)destinationPath
+                              cloneOptions:(nullable GitCloneOptions *)cloneOptions
+                              stdOutOutput:(NSString * _Nullable __autoreleasing * _Nullable)ppStdOutOutput
+                              stdErrOutput:(NSString * _Nullable __autoreleasing * _Nullable)ppStdErrOutput
+                                exitStatus:(int *)exitStatus;
+
+// `clone --no-checkout`. Fetches everything the usual clone would, but leaves the index
+// and the working tree empty – the caller must checkout the necessary revision (and set up
+// sparse-checkout if cloneOptions ask for it).
++ (nullable GitRepository *)cloneRepoWithoutCheckoutAtURL:(NSString *)url
+                                          destinationPath:(NSString *)destinationPath
+                                             cloneOptions:(nullable GitCloneOptions *)cloneOptions
+                                             stdOutOutput:(NSString * _Nullable __autoreleasing * _Nullable)ppStdOutOutput
+                                             stdErrOutput:(NSString * _Nullable __autoreleasing * _Nullable)ppStdErrOutput
+                                               exitStatus:(int *)exitStatus;
+
 + (nullable GitRepository *)initializeRepositoryAtPath:(NSString *)path
                                                   bare:(BOOL)bare
                                      defaultBranchName:(nullable NSString *)defaultBranchName
                                             exitStatus:(int *)exitStatus;
 
+// creates a repo with 'origin' pointing to the url, but takes remote branches, tags and objects
+// from the bundle created with -createBundleAtPath:revisions:. Doesn't touch the network.
+// Working tree is left empty – the caller must checkout the necessary revision
++ (nullable GitRepository *)initializeRepositoryAtPath:(NSString *)path
+                                      fromBundleAtPath:(NSString *)bundlePath
+                                                   url:(NSString *)url
+                                            exitStatus:(int *)exitStatus;
+
+
+// Sets (or, if value is nil, drops) a variable added to the environment of every git
+// command this process spawns from now on. Meant to tweak Git behaviour for a phase
+// of work, for example, to skip LFS smudge while subrepos are being checked out.
++ (void)setEnvironmentOverrideValue:(nullable NSString *)value forKey:(NSString *)key;
++ (nullable NSString *)environmentOverrideValueForKey:(NSString *)key;
+
+// `ssh-multiplexing` option. Every git command this process spawns from now on talks to
+// a host through one ssh master connection, instead of a handshake per subrepo. Nested s7
+// processes inherit GIT_SSH_COMMAND and reuse masters of the top-level one. Does nothing
+// if user has configured GIT_SSH_COMMAND, GIT_SSH or core.sshCommand.
++ (void)startSSHMultiplexing;
+// closes master connections. Safe to call if multiplexing has not been started
++ (void)stopSSHMultiplexing;
+
+// `[mirror]` rules applied to clone, fetch and (if rule says so) push of every repo
+// this process works with. If fetch from a mirror fails, or the mirror doesn't have
+// the revision we need yet, the same fetch is repeated against the original URL.
+@property (class, nonatomic, copy, nullable) NSArray<GitURLMirror *> *urlMirrors;
++ (nullable GitURLMirror *)urlMirrorForURL:(NSString *)url push:(BOOL)push;
 
 @property (nonatomic, readonly, strong) NSString *absolutePath;
 
@@ -69,18 +118,48 @@ NS_ASSUME_NONNULL_BEGIN
 @property (nonatomic, readonly, nullable) NSString *lastCommandStdOutOutput;
 @property (nonatomic, readonly, nullable) NSString *lastCommandStdErrOutput;
 
+// Runs git and hands its stdout to the block line by line as Git writes it (without
+// the trailing newline), never holding the whole output in memory.
+// Set *stop to YES to terminate Git right away – useful for "is there at least one…"
+// queries over `log`/`rev-list`, which otherwise may walk the whole history.
+// Returns 0 if the block has stopped Git, Git exit status otherwise.
+// stdout never ends up in `lastCommandStdOutOutput`, but with `redirectOutputToMemory`
+// stderr is collected in `lastCommandStdErrOutput` as usual.
+- (int)runGitWithArguments:(NSArray<NSString *> *)arguments
+         stdOutLineHandler:(void (NS_NOESCAPE ^)(NSString *line, BOOL *stop))lineHandler;
+
 - (BOOL)isEmptyRepo;
 - (BOOL)isBareRepo;
+- (BOOL)isShallowRepo;
 - (void)printStatus;
 
 - (int)removeLocalConfigSection:(NSString *)section;
 
 - (int)fetch;
 - (int)fetchWithFilter:(GitFilter)filter;
+// respects shallow options only if the repo is shallow already,
+// so that we never cut the history of a repo that was cloned in full
+- (int)fetchWithCloneOptions:(nullable GitCloneOptions *)cloneOptions;
+// if origin is fetched through a mirror that doesn't have the revision yet,
+// fetches from origin's own URL as well
+- (int)fetchWithCloneOptions:(nullable GitCloneOptions *)cloneOptions ensuringRevision:(nullable NSString *)revision;
+// fetches just enough history to make the revision available in a shallow repo
+- (int)deepenToRevision:(NSString *)revision cloneOptions:(nullable GitCloneOptions *)cloneOptions;
+- (int)setSparseCheckoutDirectories:(NSArray<NSString *> *)directories;
+
+- (int)fetchFromBundleAtPath:(NSString *)bundlePath;
+// fetches all branches of origin into refs/s7-prefetch/origin/*. Remote-tracking branches,
+// FETCH_HEAD and the working tree are left intact – nobody notices the prefetch, but objects
+// are already there when a real fetch or checkout needs them. A shallow repo stays shallow.
+- (int)prefetchFromOriginWithCloneOptions:(nullable GitCloneOptions *)cloneOptions;
+// bundles remote branches, tags and the given revisions (even if not pushed).
+// Revisions are bundled as refs/s7/pinned/<revision>; -fetchFromBundleAtPath: keeps these refs.
+- (int)createBundleAtPath:(NSString *)bundlePath revisions:(NSArray<NSString *> *)revisions;
 
 - (int)pull;
 - (int)merge;
 - (int)mergeWith:(NSString *)commit;
+- (int)nonInteractiveMergeWith:(NSString *)commit;
 
 - (BOOL)hasUnpushedCommits;
 - (int)pushCurrentBranch;
@@ -103,11 +182,15 @@ NS_ASSUME_NONNULL_BEGIN
 + (NSString *)nullRevision;
 - (int)getCurrentRevision:(NSString * _Nullable __autoreleasing * _Nonnull)ppRevision;
 - (int)getLatestRemoteRevision:(NSString * _Nullable __autoreleasing * _Nonnull)ppRevision atBranch:(NSString *)branchName;
+- (int)getLocalRevision:(NSString * _Nullable __autoreleasing * _Nonnull)ppRevision atBranch:(NSString *)branchName;
 - (BOOL)isRevisionAvailableLocally:(NSString *)revision;
-- (BOOL)isRevisionDetached:(NSString *)revision numberOfOrphanedCommits:(int *)pNumberOfOrphanedCommits;
+// pass NULL if you don't need the number – this lets us stop at the first orphaned commit
+- (BOOL)isRevisionDetached:(NSString *)revision numberOfOrphanedCommits:(int * _Nullable)pNumberOfOrphanedCommits;
 - (BOOL)isRevision:(NSString *)revision knownAtLocalBranch:(NSString *)branchName;
 - (BOOL)isRevision:(NSString *)revision knownAtRemoteBranch:(NSString *)branchName;
 - (BOOL)isRevisionAnAncestor:(NSString *)possibleAncestor toRevision:(NSString *)possibleDescendant;
+// YES if revisions have a common ancestor
+- (BOOL)isRevision:(NSString *)revision relatedToRevision:(NSString *)otherRevision;
 - (int)checkoutRevision:(NSString *)revision;
 - (BOOL)isCurrentRevisionMerge;
 - (BOOL)isCurrentRevisionCherryPickOrRevert;
@@ -133,12 +216,20 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (int)getRemote:(NSString * _Nullable __autoreleasing * _Nonnull)ppRemote;
 - (int)getUrl:(NSString * _Nullable __autoreleasing * _Nonnull)ppUrl;
+- (int)setUrl:(NSString *)url;
 
 #pragma mark - LFS -
 
+// both are cached per repo and re-evaluated only when .gitattributes or hooks change on disk
 - (BOOL)isGitLFSRepo;
 - (BOOL)isGitLFSProperlyInstalled;
 - (int)installGitLFS;
+// downloads LFS objects of the checked out revision and puts LFS files in place.
+// Used for repos checked out with LFS smudge skipped
+- (int)fetchGitLFSObjects;
+- (int)checkoutGitLFSFiles;
+// total size of objects in the local LFS storage of this repo
+- (unsigned long long)sizeOfLocalGitLFSObjects;
 
 @end
 
@@ -7,11 +7,14 @@
 //
 
 #import "Git+Tests.h"
+#import "Git+Statistics.h"
 #import "GitFilter.h"
+#import "GitConfig.h"
 #import "S7Utils.h"
-#import "S7IniConfig.h"
 
 #include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -20,6 +23,13 @@ NSString *const __trace = [NSString stringWithFormat:__VA_ARGS__]; \
 fprintf(stderr, "%s", [__trace cStringUsingEncoding:NSUTF8StringEncoding]); \
 } } while (0)
 
+@interface GitRepository (StatisticsInternal)
+
++ (void)recordSpawnOfCommandWithArguments:(NSArray<NSString *> *)arguments
+                     currentDirectoryPath:(NSString * _Nullable)currentDirectoryPath;
+
+@end
+
 @implementation GitRepository
 
 static void (^_testRepoConfigureOnInitBlock)(GitRepository *);
@@ -94,6 +104,45 @@ static void (^_testRepoConfigureOnInitBlock)(GitRepository *);
     return taskEnvironment;
 }
 
+static NSMutableDictionary<NSString *, NSString *> *environmentOverrides(void) {
+    static NSMutableDictionary<NSString *, NSString *> *environmentOverrides = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        environmentOverrides = [NSMutableDictionary new];
+    });
+    return environmentOverrides;
+}
+
++ (void)setEnvironmentOverrideValue:(nullable NSString *)value forKey:(NSString *)key {
+    @synchronized (environmentOverrides()) {
+        environmentOverrides()[key] = value;
+    }
+}
+
++ (nullable NSString *)environmentOverrideValueForKey:(NSString *)key {
+    @synchronized (environmentOverrides()) {
+        return environmentOverrides()[key];
+    }
+}
+
+// nil if there's nothing to add to the environment we've been launched with
++ (nullable NSDictionary<NSString *, NSString *> *)taskEnvironment {
+    NSDictionary<NSString *, NSString *> *const environmentWithAuth = [self gitHubTokenAuthTaskEnvironment];
+
+    NSDictionary<NSString *, NSString *> *overrides = nil;
+    @synchronized (environmentOverrides()) {
+        if (0 == environmentOverrides().count) {
+            return environmentWithAuth;
+        }
+
+        overrides = [environmentOverrides() copy];
+    }
+
+    NSMutableDictionary<NSString *, NSString *> *environment = [(environmentWithAuth ?: NSProcessInfo.processInfo.environment) mutableCopy];
+    [environment addEntriesFromDictionary:overrides];
+    return environment;
+}
+
 + (void)logSelectedAuthPathOnce {
     static dispatch_once_t onceToken;
     dispatch_once(&onceToken, ^{
@@ -106,6 +155,129 @@ static void (^_testRepoConfigureOnInitBlock)(GitRepository *);
     });
 }
 
+static NSString * const GitSSHCommandEnvironmentVariable = @"GIT_SSH_COMMAND";
+static NSString * const GitBundlePinnedRevisionRefPrefix = @"refs/s7/pinned/";
+static NSString * _Nullable sshControlDirectoryPath = nil;
+
++ (nullable NSString *)sshMultiplexingCommandWithControlDirectory:(NSString *)controlDirectoryPath
+                                               processEnvironment:(NSDictionary<NSString *, NSString *> *)processEnvironment
+{
+    // user knows better. This is also the case of a nested s7 – it gets our own
+    // GIT_SSH_COMMAND from the top-level s7 and thus shares its masters
+    if (processEnvironment[GitSSHCommandEnvironmentVariable].length > 0 || processEnvironment[@"GIT_SSH"].length > 0) {
+        return nil;
+    }
+
+    // the first connection to a host becomes a master, the rest go through its socket.
+    // %C is a hash of host, port and user – short enough for the socket path limit.
+    // ControlPersist keeps master alive between fetches of different subrepos, and is
+    // also a safety net if we don't get to -stopSSHMultiplexing (crash, kill -9)
+    return [NSString stringWithFormat:@"ssh -o ControlMaster=auto -o ControlPath=%@/%%C -o ControlPersist=60",
+            controlDirectoryPath];
+}
+
++ (void)startSSHMultiplexing {
+    if (sshControlDirectoryPath) {
+        return;
+    }
+
+    NSString *devNull = nil;
+    if (0 == [self runGitWithArguments:@[ @"config", @"--get", @"core.sshCommand" ]
+                          stdOutOutput:&devNull
+                          stdErrOutput:&devNull
+                  currentDirectoryPath:nil])
+    {
+        return;
+    }
+
+    // not NSTemporaryDirectory() – a path of a unix socket must fit into ~100 bytes
+    char controlDirectoryTemplate[] = "/tmp/s7-ssh-XXXXXX";
+    if (NULL == mkdtemp(controlDirectoryTemplate)) {
+        logError("failed to create a directory for ssh control sockets. Error: %s\n", strerror(errno));
+        return;
+    }
+
+    NSString *controlDirectoryPath = [NSString stringWithUTF8String:controlDirectoryTemplate];
+    NSString *sshCommand = [self sshMultiplexingCommandWithControlDirectory:controlDirectoryPath
+                                                         processEnvironment:NSProcessInfo.processInfo.environment];
+    if (nil == sshCommand) {
+        rmdir(controlDirectoryTemplate);
+        return;
+    }
+
+    sshControlDirectoryPath = controlDirectoryPath;
+    [self setEnvironmentOverrideValue:sshCommand forKey:GitSSHCommandEnvironmentVariable];
+
+    s7TraceGit(@"s7: ssh multiplexing via %@\n", controlDirectoryPath);
+}
+
++ (void)stopSSHMultiplexing {
+    NSString *controlDirectoryPath = sshControlDirectoryPath;
+    if (nil == controlDirectoryPath) {
+        return;
+    }
+
+    sshControlDirectoryPath = nil;
+    [self setEnvironmentOverrideValue:nil forKey:GitSSHCommandEnvironmentVariable];
+
+    for (NSString *socketName in [NSFileManager.defaultManager contentsOfDirectoryAtPath:controlDirectoryPath error:nil]) {
+        // host doesn't matter, ControlPath identifies the master
+        NSTask *task = [NSTask new];
+        task.launchPath = @"/usr/bin/env";
+        task.arguments = @[ @"ssh",
+                            @"-o", [@"ControlPath=" stringByAppendingString:[controlDirectoryPath stringByAppendingPathComponent:socketName]],
+                            @"-O", @"exit",
+                            @"s7" ];
+        task.standardInput = NSFileHandle.fileHandleWithNullDevice;
+        task.standardOutput = NSFileHandle.fileHandleWithNullDevice;
+        task.standardError = NSFileHandle.fileHandleWithNullDevice;
+
+        if ([task launchAndReturnError:nil]) {
+            [task waitUntilExit];
+        }
+    }
+
+    [NSFileManager.defaultManager removeItemAtPath:controlDirectoryPath error:nil];
+}
+
+static NSArray<GitURLMirror *> * _Nullable _urlMirrors = nil;
+
++ (nullable NSArray<GitURLMirror *> *)urlMirrors {
+    @synchronized (self) {
+        return _urlMirrors;
+    }
+}
+
++ (void)setUrlMirrors:(nullable NSArray<GitURLMirror *> *)urlMirrors {
+    @synchronized (self) {
+        _urlMirrors = [urlMirrors copy];
+    }
+}
+
++ (nullable GitURLMirror *)urlMirrorForURL:(NSString *)url push:(BOOL)push {
+    NSArray<GitURLMirror *> *rules = self.urlMirrors;
+    if (0 == rules.count) {
+        return nil;
+    }
+
+    return [GitURLMirror mirrorForURL:url amongRules:rules push:push];
+}
+
+- (NSArray<NSString *> *)originMirrorCommandLineArgumentsForPush:(BOOL)push {
+    if (0 == self.class.urlMirrors.count) {
+        return @[];
+    }
+
+    // not -getUrl: – it spawns git if config has includes, and asserts if there's no origin
+    NSString *url = [[self inProcessConfig] stringForKey:@"remote.origin.url"];
+    if (0 == url.length) {
+        return @[];
+    }
+
+    GitURLMirror *mirror = [self.class urlMirrorForURL:url push:push];
+    return mirror ? [mirror configCommandLineArguments] : @[];
+}
+
 #pragma mark - Initialization
 
 - (nullable instancetype)initWithRepoPath:(NSString *)repoPath {
@@ -209,15 +381,91 @@ static void (^_testRepoConfigureOnInitBlock)(GitRepository *);
                               stdOutOutput:(NSString * _Nullable __autoreleasing * _Nullable)ppStdOutOutput
                               stdErrOutput:(NSString * _Nullable __autoreleasing * _Nullable)ppStdErrOutput
                                 exitStatus:(int *)exitStatus
+{
+    return [self cloneRepoAtURL:url
+                         branch:branch
+                           bare:bare
+                destinationPath:destinationPath
+                   cloneOptions:[GitCloneOptions optionsWithFilter:filter]
+                   stdOutOutput:ppStdOutOutput
+                   stdErrOutput:ppStdErrOutput
+                     exitStatus:exitStatus];
+}
+
++ (nullable GitRepository *)cloneRepoAtURL:(NSString *)url
+                                    branch:(NSString * _Nullable)branch
+                                      bare:(BOOL)bare
+                           destinationPath:(NSString *)destinationPath
+                              cloneOptions:(nullable GitCloneOptions *)cloneOptions
+                              stdOutOutput:(NSString * _Nullable __autoreleasing * _Nullable)ppStdOutOutput
+                              stdErrOutput:(NSString * _Nullable __autoreleasing * _Nullable)ppStdErrOutput
+                                exitStatus:(int *)exitStatus
+{
+    return [self cloneRepoAtURL:url
+                         branch:branch
+                           bare:bare
+                     noCheckout:NO
+                destinationPath:destinationPath
+                   cloneOptions:cloneOptions
+                   stdOutOutput:ppStdOutOutput
+                   stdErrOutput:ppStdErrOutput
+                     exitStatus:exitStatus];
+}
+
++ (nullable GitRepository *)cloneRepoWithoutCheckoutAtURL:(NSString *)url
+                                          destinationPath:(NSString *)destinationPath
+                                             cloneOptions:(nullable GitCloneOptions *)cloneOptions
+                                             stdOutOutput:(NSString * _Nullable __autoreleasing * _Nullable)ppStdOutOutput
+                                             stdErrOutput:(NSString * _Nullable __autoreleasing * _Nullable)ppStdErrOutput
+                                               exitStatus:(int *)exitStatus
+{
+    return [self cloneRepoAtURL:url
+                         branch:nil
+                           bare:NO
+                     noCheckout:YES
+                destinationPath:destinationPath
+                   cloneOptions:cloneOptions
+                   stdOutOutput:ppStdOutOutput
+                   stdErrOutput:ppStdErrOutput
+                     exitStatus:exitStatus];
+}
+
++ (nullable GitRepository *)cloneRepoAtURL:(NSString *)url
+                                    branch:(NSString * _Nullable)branch
+                                      bare:(BOOL)bare
+                                noCheckout:(BOOL)noCheckout
+                           destinationPath:(NSString *)destinationPath
+                              cloneOptions:(nullable GitCloneOptions *)cloneOptions
+                              stdOutOutput:(NSString * _Nullable __autoreleasing * _Nullable)ppStdOutOutput
+                              stdErrOutput:(NSString * _Nullable __autoreleasing * _Nullable)ppStdErrOutput
+                                exitStatus:(int *)exitStatus
 {
     NSMutableArray<NSString *> *arguments = [NSMutableArray new];
 
     [arguments addObject:@"clone"];
 
-    if (filter == GitFilterBlobNone) {
-        [arguments addObject:[NSString stringWithFormat: @"--filter=%@", kGitFilterBlobNone]];
+    if (noCheckout) {
+        [arguments addObject:@"--no-checkout"];
     }
-    
+
+    NSString *filterArgument = GitFilterCommandLineArgument(cloneOptions.filter);
+    if (filterArgument) {
+        [arguments addObject:filterArgument];
+    }
+
+    if (cloneOptions.isShallow) {
+        [arguments addObjectsFromArray:[cloneOptions shallowCommandLineArguments]];
+        // `--depth` implies `--single-branch`. Subrepo can be switched to any other
+        // branch later, so we want remote refs for all branches to be fetched
+        [arguments addObject:@"--no-single-branch"];
+    }
+
+    // without checkout, sparse-checkout is the business of whoever checks out the working tree
+    const BOOL sparse = cloneOptions.isSparse && NO == bare && NO == noCheckout;
+    if (sparse) {
+        [arguments addObject:@"--sparse"];
+    }
+
     if (branch.length > 0) {
         [arguments addObject:@"-b"];
         [arguments addObject:branch];
@@ -230,17 +478,46 @@ static void (^_testRepoConfigureOnInitBlock)(GitRepository *);
     [arguments addObject:url];
     [arguments addObject:destinationPath];
 
-    *exitStatus = [self
-                   runGitWithArguments:arguments
-                   stdOutOutput:ppStdOutOutput
-                   stdErrOutput:ppStdErrOutput
-                   currentDirectoryPath:nil];
+    GitURLMirror *mirror = [self urlMirrorForURL:url push:NO];
+    if (mirror) {
+        // `git -c`, not `git clone -c` – the latter would save the rule to config of the new repo
+        *exitStatus = [self
+                       runGitWithArguments:[[mirror configCommandLineArguments] arrayByAddingObjectsFromArray:arguments]
+                       stdOutOutput:ppStdOutOutput
+                       stdErrOutput:ppStdErrOutput
+                       currentDirectoryPath:nil];
+
+        if (0 != *exitStatus) {
+            logInfo("  failed to clone from mirror '%s', cloning from '%s'\n",
+                    [mirror.mirrorPrefix cStringUsingEncoding:NSUTF8StringEncoding],
+                    [url cStringUsingEncoding:NSUTF8StringEncoding]);
+        }
+    }
+
+    if (nil == mirror || 0 != *exitStatus) {
+        *exitStatus = [self
+                       runGitWithArguments:arguments
+                       stdOutOutput:ppStdOutOutput
+                       stdErrOutput:ppStdErrOutput
+                       currentDirectoryPath:nil];
+    }
 
     if (0 != *exitStatus) {
         return nil;
     }
 
-    return [[GitRepository alloc] initWithRepoPath:destinationPath bare:bare];
+    GitRepository *repo = [[GitRepository alloc] initWithRepoPath:destinationPath bare:bare];
+
+    if (sparse) {
+        // `clone --sparse` leaves just top-level files in the working tree,
+        // the rest is populated by `sparse-checkout set`
+        *exitStatus = [repo setSparseCheckoutDirectories:cloneOptions.sparseCheckoutDirectories];
+        if (0 != *exitStatus) {
+            return nil;
+        }
+    }
+
+    return repo;
 }
 
 + (nullable GitRepository *)initializeRepositoryAtPath:(NSString *)path
@@ -267,16 +544,60 @@ static void (^_testRepoConfigureOnInitBlock)(GitRepository *);
     return [[GitRepository alloc] initWithRepoPath:path bare:bare];
 }
 
++ (nullable GitRepository *)initializeRepositoryAtPath:(NSString *)path
+                                      fromBundleAtPath:(NSString *)bundlePath
+                                                   url:(NSString *)url
+                                            exitStatus:(int *)exitStatus
+{
+    NSString *devNull = nil;
+    *exitStatus = [self runGitWithArguments:@[ @"init", @"-q", path ]
+                               stdOutOutput:&devNull
+                               stdErrOutput:&devNull
+                       currentDirectoryPath:nil];
+    if (0 != *exitStatus) {
+        return nil;
+    }
+
+    GitRepository *repo = [[GitRepository alloc] initWithRepoPath:path];
+    if (nil == repo) {
+        *exitStatus = S7ExitCodeGitOperationFailed;
+        return nil;
+    }
+
+    *exitStatus = [repo runGitWithArguments:@[ @"remote", @"add", @"origin", url ]
+                               stdOutOutput:NULL
+                               stdErrOutput:NULL];
+    if (0 != *exitStatus) {
+        return nil;
+    }
+
+    *exitStatus = [repo fetchFromBundleAtPath:bundlePath];
+    if (0 != *exitStatus) {
+        return nil;
+    }
+
+    return repo;
+}
+
 #pragma mark - utils -
 
 + (int)executeCommand:(NSString *)command {
     s7TraceGit(@"s7: %@\n", command);
+    [self recordSpawnOfCommandWithArguments:[command componentsSeparatedByCharactersInSet:[NSCharacterSet whitespaceCharacterSet]]
+                       currentDirectoryPath:nil];
     const int exitCode = system([command cStringUsingEncoding:NSUTF8StringEncoding]);
     s7TraceGit(@"s7: git exit code %@\n", @(exitCode));
     
     return exitCode;
 }
 
++ (NSArray<NSString *> *)argumentsOfCommand:(NSString *)command {
+    NSArray<NSString *> *arguments = [command componentsSeparatedByCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+    return [arguments filteredArrayUsingPredicate:[NSPredicate predicateWithBlock:^BOOL(NSString * _Nullable evaluatedObject, NSDictionary<NSString *,id> * _Nullable bindings) {
+        return evaluatedObject.length > 0;
+    }]];
+}
+
 - (int)runGitCommand:(NSString *)command
         stdOutOutput:(NSString * _Nullable __autoreleasing * _Nullable)ppStdOutOutput
         stdErrOutput:(NSString * _Nullable __autoreleasing * _Nullable)ppStdErrOutput
@@ -291,10 +612,7 @@ static void (^_testRepoConfigureOnInitBlock)(GitRepository *);
     // for example, "commit -m\"up pdf kit\"" is a bad 'command' – it will confuse git
     // and it will fail.
     //
-    NSArray<NSString *> *arguments = [command componentsSeparatedByCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
-    arguments = [arguments filteredArrayUsingPredicate:[NSPredicate predicateWithBlock:^BOOL(NSString * _Nullable evaluatedObject, NSDictionary<NSString *,id> * _Nullable bindings) {
-        return evaluatedObject.length > 0;
-    }]];
+    NSArray<NSString *> *arguments = [self.class argumentsOfCommand:command];
 
     NSAssert(NO == [arguments.firstObject isEqualToString:@"git"],
              @"please, don't use git command itself – just arguments to git");
@@ -304,10 +622,7 @@ static void (^_testRepoConfigureOnInitBlock)(GitRepository *);
                         stdErrOutput:ppStdErrOutput];
 }
 
-- (int)runGitWithArguments:(NSArray<NSString *> *)arguments
-              stdOutOutput:(NSString * _Nullable __autoreleasing * _Nullable)ppStdOutOutput
-              stdErrOutput:(NSString * _Nullable __autoreleasing * _Nullable)ppStdErrOutput
-{
+- (NSArray<NSString *> *)argumentsByPrependingGitDirOption:(NSArray<NSString *> *)arguments {
     // pastey:
     // we must add `--git-dir` option to every command we run to fix the following issue.
     //  - clone main repo with .s7bootstrap
@@ -335,7 +650,14 @@ static void (^_testRepoConfigureOnInitBlock)(GitRepository *);
     NSString *gitDirOption = [@"--git-dir=" stringByAppendingString:dotGitDirPath];
     NSArray<NSString *> *defaultArguments = @[ gitDirOption ];
 
-    arguments = [defaultArguments arrayByAddingObjectsFromArray:arguments];
+    return [defaultArguments arrayByAddingObjectsFromArray:arguments];
+}
+
+- (int)runGitWithArguments:(NSArray<NSString *> *)arguments
+              stdOutOutput:(NSString * _Nullable __autoreleasing * _Nullable)ppStdOutOutput
+              stdErrOutput:(NSString * _Nullable __autoreleasing * _Nullable)ppStdErrOutput
+{
+    arguments = [self argumentsByPrependingGitDirOption:arguments];
 
     NSString *stdOutOutput = nil;
     NSString *stdErrOutput = nil;
@@ -383,9 +705,9 @@ static void (^_testRepoConfigureOnInitBlock)(GitRepository *);
     // Inject the HTTPS auth config via the child's environment (see
     // +gitHubTokenAuthTaskEnvironment). nil on the SSH path, so dev machines and
     // any non-token use are completely unaffected (no task.environment override).
-    NSDictionary<NSString *, NSString *> *const environmentWithAuth = [self gitHubTokenAuthTaskEnvironment];
-    if (nil != environmentWithAuth) {
-        task.environment = environmentWithAuth;
+    NSDictionary<NSString *, NSString *> *const taskEnvironment = [self taskEnvironment];
+    if (nil != taskEnvironment) {
+        task.environment = taskEnvironment;
     }
 
     // https://stackoverflow.com/questions/49184623/nstask-race-condition-with-readabilityhandler-block
@@ -447,6 +769,7 @@ static void (^_testRepoConfigureOnInitBlock)(GitRepository *);
     }
     
     s7TraceGit(@"s7: git %@\n", [task.arguments componentsJoinedByString:@" "]);
+    [self recordSpawnOfCommandWithArguments:arguments currentDirectoryPath:currentDirectoryPath];
 
     [task waitUntilExit];
 
@@ -473,6 +796,176 @@ static void (^_testRepoConfigureOnInitBlock)(GitRepository *);
     return [task terminationStatus];
 }
 
+- (int)runGitWithArguments:(NSArray<NSString *> *)arguments
+         stdOutLineHandler:(void (NS_NOESCAPE ^)(NSString *line, BOOL *stop))lineHandler
+{
+    _lastCommandStdOutOutput = nil;
+    _lastCommandStdErrOutput = nil;
+
+    NSString *stdErrOutput = nil;
+
+    const int exitCode =
+        [self.class
+         runGitWithArguments:[self argumentsByPrependingGitDirOption:arguments]
+         stdOutLineHandler:lineHandler
+         stdErrOutput:self.redirectOutputToMemory ? &stdErrOutput : NULL
+         currentDirectoryPath:self.absolutePath];
+
+    if (self.redirectOutputToMemory) {
+        // stdout has been consumed by the line handler – there's nothing to keep
+        _lastCommandStdErrOutput = stdErrOutput;
+    }
+
+    return exitCode;
+}
+
++ (int)runGitWithArguments:(NSArray<NSString *> *)arguments
+         stdOutLineHandler:(void (NS_NOESCAPE ^)(NSString *line, BOOL *stop))lineHandler
+              stdErrOutput:(NSString * _Nullable __autoreleasing * _Nullable)ppStdErrOutput
+      currentDirectoryPath:(NSString * _Nullable)currentDirectoryPath
+{
+    // Unlike -runGitWithArguments:stdOutOutput:..., we read stdout on the calling thread
+    // as it arrives and never hold more than one read chunk plus an unfinished line.
+    // If ppStdErrOutput is passed, stderr is collected in the background (otherwise Git
+    // could block on a full stderr pipe while we wait for its stdout). If not, stderr
+    // goes wherever our own stderr goes.
+    //
+    NSTask *task = [NSTask new];
+    [task setLaunchPath:[self envGitExecutablePath]];
+    [task setArguments:arguments];
+    if (currentDirectoryPath) {
+        task.currentDirectoryURL = [NSURL fileURLWithPath:currentDirectoryPath];
+    }
+
+    [self logSelectedAuthPathOnce];
+
+    NSDictionary<NSString *, NSString *> *const taskEnvironment = [self taskEnvironment];
+    if (nil != taskEnvironment) {
+        task.environment = taskEnvironment;
+    }
+
+    NSPipe *outputPipe = [NSPipe new];
+    task.standardOutput = outputPipe;
+
+    // see -runGitWithArguments:stdOutOutput:stdErrOutput:currentDirectoryPath: on why we need the semaphore
+    dispatch_semaphore_t errorPipeCloseSemaphore = NULL;
+    NSMutableData *errorData = nil;
+    if (ppStdErrOutput) {
+        errorPipeCloseSemaphore = dispatch_semaphore_create(0);
+        errorData = [NSMutableData new];
+
+        NSPipe *errorPipe = [NSPipe new];
+        task.standardError = errorPipe;
+
+        __weak __auto_type weakErrorPipe = errorPipe;
+        errorPipe.fileHandleForReading.readabilityHandler = ^ (NSFileHandle * _Nonnull handle) {
+            // DO NOT use -availableData in these handlers.
+            NSData *newData = [handle readDataOfLength:NSUIntegerMax];
+            if (0 == newData.length) {
+                dispatch_semaphore_signal(errorPipeCloseSemaphore);
+
+                __strong __auto_type strongErrorPipe = weakErrorPipe;
+                strongErrorPipe.fileHandleForReading.readabilityHandler = nil;
+            }
+            else {
+                [errorData appendData:newData];
+            }
+        };
+    }
+
+    NSError *error = nil;
+    if (NO == [task launchAndReturnError:&error]) {
+        logError("failed to run git command. Error = %s", [[error description] cStringUsingEncoding:NSUTF8StringEncoding]);
+        return 1;
+    }
+
+    s7TraceGit(@"s7: git %@\n", [task.arguments componentsJoinedByString:@" "]);
+    [self recordSpawnOfCommandWithArguments:arguments currentDirectoryPath:currentDirectoryPath];
+
+    __block BOOL stop = NO;
+    __auto_type yieldLine = ^ (const char *bytes, NSUInteger length) {
+        @autoreleasepool {
+            NSString *line = [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding];
+            if (nil == line) {
+                // we don't expect anything but ASCII from log/rev-list style commands
+                line = [[NSString alloc] initWithBytes:bytes length:length encoding:NSISOLatin1StringEncoding];
+            }
+
+            s7TraceGit(@"%@\n", line);
+
+            lineHandler(line, &stop);
+        }
+    };
+
+    const int outputFileDescriptor = outputPipe.fileHandleForReading.fileDescriptor;
+    NSMutableData *unfinishedLine = [NSMutableData new];
+    char buffer[16 * 1024];
+    while (NO == stop) {
+        const ssize_t bytesRead = read(outputFileDescriptor, buffer, sizeof(buffer));
+        if (bytesRead < 0 && EINTR == errno) {
+            continue;
+        }
+
+        if (bytesRead <= 0) {
+            break;
+        }
+
+        const char *lineStart = buffer;
+        const char *const bufferEnd = buffer + bytesRead;
+        while (NO == stop && lineStart < bufferEnd) {
+            const char *const lineEnd = memchr(lineStart, '\n', bufferEnd - lineStart);
+            if (NULL == lineEnd) {
+                [unfinishedLine appendBytes:lineStart length:bufferEnd - lineStart];
+                break;
+            }
+
+            if (0 == unfinishedLine.length) {
+                yieldLine(lineStart, lineEnd - lineStart);
+            }
+            else {
+                [unfinishedLine appendBytes:lineStart length:lineEnd - lineStart];
+                yieldLine(unfinishedLine.bytes, unfinishedLine.length);
+                unfinishedLine.length = 0;
+            }
+
+            lineStart = lineEnd + 1;
+        }
+    }
+
+    // `log --pretty=format:` doesn't terminate the last line
+    if (NO == stop && unfinishedLine.length > 0) {
+        yieldLine(unfinishedLine.bytes, unfinishedLine.length);
+    }
+
+    if (stop && task.isRunning) {
+        // closing the pipe is not enough – Git would notice that only on the next write,
+        // and it can be deep in a history walk for a long time before that happens
+        [task terminate];
+    }
+
+    [outputPipe.fileHandleForReading closeFile];
+
+    [task waitUntilExit];
+
+    if (errorPipeCloseSemaphore) {
+        dispatch_semaphore_wait(errorPipeCloseSemaphore, DISPATCH_TIME_FOREVER);
+
+        NSString *stdErrOutput = [[NSString alloc] initWithData:errorData encoding:NSUTF8StringEncoding];
+        s7TraceGit(@"%@", stdErrOutput);
+        *ppStdErrOutput = stdErrOutput;
+    }
+
+    if (stop) {
+        // the caller has got everything it wanted, so it doesn't care how Git felt about being killed
+        s7TraceGit(@"s7: git terminated early on s7 request\n");
+        return 0;
+    }
+
+    s7TraceGit(@"s7: git exit code %@\n", @([task terminationStatus]));
+
+    return [task terminationStatus];
+}
+
 #pragma mark - repo info -
 
 - (BOOL)isBareRepo {
@@ -483,9 +976,19 @@ static void (^_testRepoConfigureOnInitBlock)(GitRepository *);
     //
     if (NO == [NSFileManager.defaultManager fileExistsAtPath:[self.absolutePath stringByAppendingPathComponent:@".git"]]) {
         if ([NSFileManager.defaultManager fileExistsAtPath:[self.absolutePath stringByAppendingPathComponent:@"HEAD"]]) {
-            NSString *config = [[NSString alloc] initWithContentsOfFile:[self.absolutePath stringByAppendingPathComponent:@"config"] encoding:NSUTF8StringEncoding error:nil];
-            NSArray<NSString *> *configLines = [config componentsSeparatedByCharactersInSet:[NSCharacterSet newlineCharacterSet]];
-            return [configLines containsObject:@"\tbare = true"];
+            GitConfig *config = [GitConfig configForGitDirectory:self.absolutePath];
+            if (NO == config.requiresGit) {
+                return [config boolForKey:@"core.bare" defaultValue:NO];
+            }
+
+            // can't use -runGitCommand: here, as it asks us whether the repo is bare
+            NSString *stdOutOutput = nil;
+            const int exitStatus = [self.class runGitWithArguments:@[ [@"--git-dir=" stringByAppendingString:self.absolutePath],
+                                                                      @"config", @"--bool", @"core.bare" ]
+                                                      stdOutOutput:&stdOutOutput
+                                                      stdErrOutput:NULL
+                                              currentDirectoryPath:self.absolutePath];
+            return 0 == exitStatus && [stdOutOutput containsString:@"true"];
         }
     }
 
@@ -502,6 +1005,23 @@ static void (^_testRepoConfigureOnInitBlock)(GitRepository *);
 //    return [stdOutOutput containsString:@"true"];
 }
 
+- (BOOL)isShallowRepo {
+    NSString *gitDirPath = [self plainGitDirPath];
+    if (gitDirPath) {
+        return [NSFileManager.defaultManager fileExistsAtPath:[gitDirPath stringByAppendingPathComponent:@"shallow"]];
+    }
+
+    NSString *stdOutOutput = nil;
+    if (0 != [self runGitWithArguments:@[ @"rev-parse", @"--is-shallow-repository" ]
+                          stdOutOutput:&stdOutOutput
+                          stdErrOutput:NULL])
+    {
+        return NO;
+    }
+
+    return [[stdOutOutput stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]] isEqualToString:@"true"];
+}
+
 - (BOOL)isEmptyRepo {
     NSError *error = nil;
     NSArray *headsDirectoryContents =
@@ -534,6 +1054,41 @@ static void (^_testRepoConfigureOnInitBlock)(GitRepository *);
 
 #pragma mark - config -
 
+// Path to the git dir, if we can look into it ourselves. If `.git` is a gitfile
+// (a worktree, or a repo with --separate-git-dir), then config, shallow and others
+// live elsewhere – in the dir the gitfile points to, or in its common dir.
+// That's for Git itself to figure out, so nil is returned.
+- (nullable NSString *)plainGitDirPath {
+    if (self.isBareRepo) {
+        return self.absolutePath;
+    }
+
+    NSString *dotGitDirPath = [self.absolutePath stringByAppendingPathComponent:@".git"];
+
+    BOOL isDirectory = NO;
+    if ([NSFileManager.defaultManager fileExistsAtPath:dotGitDirPath isDirectory:&isDirectory] && isDirectory) {
+        return dotGitDirPath;
+    }
+
+    return nil;
+}
+
+// nil if config contains something that only Git itself can interpret,
+// or if we don't know where the config is (see -plainGitDirPath)
+- (nullable GitConfig *)inProcessConfig {
+    NSString *gitDirPath = [self plainGitDirPath];
+    if (nil == gitDirPath) {
+        return nil;
+    }
+
+    GitConfig *config = [GitConfig configForGitDirectory:gitDirPath];
+    if (config.requiresGit) {
+        return nil;
+    }
+
+    return config;
+}
+
 - (int)removeLocalConfigSection:(NSString *)section {
     int gitExitCode = [self runGitWithArguments:@[ @"config", @"--local", @"--remove-section", section ]
                                    stdOutOutput:nil
@@ -549,6 +1104,11 @@ static void (^_testRepoConfigureOnInitBlock)(GitRepository *);
 
 - (BOOL)isBranchTrackingRemoteBranch:(NSString *)branchName {
     // check if we are tracking this branch already
+    GitConfig *config = [self inProcessConfig];
+    if (config) {
+        return nil != [config stringForKey:[NSString stringWithFormat:@"branch.%@.merge", branchName]];
+    }
+
     NSString *devNullOutput = nil;
     if (0 == [self runGitCommand:[NSString stringWithFormat:@"config branch.%@.merge", branchName]
                     stdOutOutput:&devNullOutput
@@ -804,24 +1364,30 @@ static void (^_testRepoConfigureOnInitBlock)(GitRepository *);
     return 0 == exitStatus;
 }
 
-- (BOOL)isRevisionDetached:(NSString *)revision numberOfOrphanedCommits:(int *)pNumberOfOrphanedCommits {
-    NSString *stdOutOutput = nil;
-    __unused const int exitStatus = [self
-                                    runGitCommand:[NSString stringWithFormat:@"rev-list %@ --not --branches --remotes", revision]
-                                    stdOutOutput:&stdOutOutput
-                                    stdErrOutput:NULL];
-    NSAssert(0 == exitStatus, @"");
+- (BOOL)isRevisionDetached:(NSString *)revision numberOfOrphanedCommits:(int * _Nullable)pNumberOfOrphanedCommits {
+    // if caller doesn't need the number, the first orphaned commit is enough to answer,
+    // and we don't let Git walk the rest of the history
+    __block int numberOfOrphanedCommits = 0;
+    __unused const int exitStatus =
+    [self
+     runGitWithArguments:@[ @"rev-list", revision, @"--not", @"--branches", @"--remotes" ]
+     stdOutLineHandler:^(NSString * _Nonnull line, BOOL * _Nonnull stop) {
+        if (0 == line.length) {
+            return;
+        }
 
-    stdOutOutput = [stdOutOutput stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
-    if (0 == stdOutOutput.length) {
-        *pNumberOfOrphanedCommits = 0;
-        return NO;
-    }
-    else {
-        NSArray<NSString *> *commits = [stdOutOutput componentsSeparatedByCharactersInSet:[NSCharacterSet newlineCharacterSet]];
-        *pNumberOfOrphanedCommits = (int)commits.count;
-        return YES;
+        ++numberOfOrphanedCommits;
+        if (NULL == pNumberOfOrphanedCommits) {
+            *stop = YES;
+        }
+    }];
+    NSAssert(0 == exitStatus, @"");
+
+    if (pNumberOfOrphanedCommits) {
+        *pNumberOfOrphanedCommits = numberOfOrphanedCommits;
     }
+
+    return numberOfOrphanedCommits > 0;
 }
 
 - (BOOL)isRevision:(NSString *)revision knownAtBranch:(NSString *)branchName isRemoteBranch:(BOOL)remoteBranch {
@@ -873,6 +1439,19 @@ static void (^_testRepoConfigureOnInitBlock)(GitRepository *);
     return 0 == exitStatus;
 }
 
+- (BOOL)isRevision:(NSString *)revision relatedToRevision:(NSString *)otherRevision {
+    NSParameterAssert(40 == revision.length);
+    NSParameterAssert(40 == otherRevision.length);
+
+    NSString *devNull = nil;
+    const int exitStatus = [self runGitCommand:[NSString stringWithFormat:@"merge-base %@ %@",
+                                                revision,
+                                                otherRevision]
+                                  stdOutOutput:&devNull
+                                  stdErrOutput:&devNull];
+    return 0 == exitStatus;
+}
+
 - (BOOL)isCurrentRevisionMerge {
     NSString *devNull;
     const int exitStatus = [self runGitCommand:@"show HEAD^2 -- -s"
@@ -1023,6 +1602,20 @@ static void (^_testRepoConfigureOnInitBlock)(GitRepository *);
     return 0;
 }
 
+- (int)getLocalRevision:(NSString * _Nullable __autoreleasing * _Nonnull)ppRevision atBranch:(NSString *)branchName {
+    NSString *stdOutOutput = nil;
+    const int revParseExitStatus = [self runGitWithArguments:@[ @"rev-parse", @"--verify", [@"refs/heads/" stringByAppendingString:branchName] ]
+                                                stdOutOutput:&stdOutOutput
+                                                stdErrOutput:NULL];
+    if (0 != revParseExitStatus) {
+        return revParseExitStatus;
+    }
+
+    *ppRevision = [stdOutOutput stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
+
+    return 0;
+}
+
 - (int)checkoutRevision:(NSString *)revision {
     const int exitStatus = [self runGitCommand:[NSString stringWithFormat:@"checkout %@", revision]
                                   stdOutOutput:NULL
@@ -1073,6 +1666,25 @@ static void (^_testRepoConfigureOnInitBlock)(GitRepository *);
 #pragma mark - remote -
 
 - (int)getRemote:(NSString * _Nullable __autoreleasing * _Nonnull)ppRemote {
+    GitConfig *config = [self inProcessConfig];
+    if (config) {
+        // `git remote` lists every remote with a url, fetch or push settings.
+        // We have never had more than one remote per repo.
+        NSMutableArray<NSString *> *remotes = [NSMutableArray new];
+        for (NSString *remote in [config subsectionsOfSection:@"remote"]) {
+            NSString *keyPrefix = [@"remote." stringByAppendingString:remote];
+            if ([config stringForKey:[keyPrefix stringByAppendingString:@".url"]]
+                || [config stringForKey:[keyPrefix stringByAppendingString:@".fetch"]]
+                || [config stringForKey:[keyPrefix stringByAppendingString:@".pushurl"]])
+            {
+                [remotes addObject:remote];
+            }
+        }
+
+        *ppRemote = [remotes componentsJoinedByString:@"\n"];
+        return 0;
+    }
+
     NSString *stdOutOutput = nil;
     const int exitStatus = [self runGitCommand:@"remote"
                                   stdOutOutput:&stdOutOutput
@@ -1088,19 +1700,21 @@ static void (^_testRepoConfigureOnInitBlock)(GitRepository *);
 }
 
 - (int)getUrl:(NSString * _Nullable __autoreleasing * _Nonnull)ppUrl {
-    S7IniConfig *parsedGitConfig = [S7IniConfig configWithContentsOfFile:[self.absolutePath stringByAppendingPathComponent:@".git/config"]];
-    if (nil == parsedGitConfig) {
-        NSAssert(NO, @"WTF?");
-        return S7ExitCodeGitOperationFailed;
-    }
+    GitConfig *config = [self inProcessConfig];
+    if (nil == config) {
+        NSString *stdOutOutput = nil;
+        const int exitStatus = [self runGitCommand:@"config remote.origin.url"
+                                      stdOutOutput:&stdOutOutput
+                                      stdErrOutput:NULL];
+        if (0 != exitStatus) {
+            return S7ExitCodeGitOperationFailed;
+        }
 
-    NSDictionary<NSString *, NSString *> *remoteSection = parsedGitConfig.dictionaryRepresentation[@"remote \"origin\""];
-    if (nil == remoteSection) {
-        NSAssert(NO, @"WTF?");
-        return S7ExitCodeGitOperationFailed;
+        *ppUrl = [stdOutOutput stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
+        return S7ExitCodeSuccess;
     }
 
-    NSString *url = remoteSection[@"url"];
+    NSString *url = [config stringForKey:@"remote.origin.url"];
     if (0 == url.length) {
         NSAssert(NO, @"WTF?");
         return S7ExitCodeGitOperationFailed;
@@ -1111,6 +1725,12 @@ static void (^_testRepoConfigureOnInitBlock)(GitRepository *);
     return S7ExitCodeSuccess;
 }
 
+- (int)setUrl:(NSString *)url {
+    return [self runGitWithArguments:@[ @"remote", @"set-url", @"origin", url ]
+                        stdOutOutput:NULL
+                        stdErrOutput:NULL];
+}
+
 #pragma mark - exchange -
 
 - (int)fetch {
@@ -1118,19 +1738,166 @@ static void (^_testRepoConfigureOnInitBlock)(GitRepository *);
 }
 
 - (int)fetchWithFilter:(GitFilter)filter {
-    NSString *filterOption = @"";
-    if (filter == GitFilterBlobNone) {
-        filterOption = [NSString stringWithFormat: @"--filter=%@", kGitFilterBlobNone];
+    return [self fetchWithCloneOptions:[GitCloneOptions optionsWithFilter:filter]];
+}
+
+- (int)fetchWithCloneOptions:(nullable GitCloneOptions *)cloneOptions {
+    return [self fetchWithCloneOptions:cloneOptions ensuringRevision:nil];
+}
+
+- (int)fetchWithCloneOptions:(nullable GitCloneOptions *)cloneOptions ensuringRevision:(nullable NSString *)revision {
+    NSMutableArray<NSString *> *arguments = [NSMutableArray arrayWithObject:@"fetch"];
+
+    NSString *filterArgument = GitFilterCommandLineArgument(cloneOptions.filter);
+    if (filterArgument) {
+        [arguments addObject:filterArgument];
     }
-    
-    NSString *gitCommand = [NSString stringWithFormat:@"fetch %@ -p", filterOption];
-    
-    const int exitStatus = [self runGitCommand:gitCommand
+
+    // `fetch --depth` on a repo with full history would make it shallow.
+    // Someone, who has already got the full history, definitely doesn't want it to be cut.
+    if (cloneOptions.isShallow && self.isShallowRepo) {
+        [arguments addObjectsFromArray:[cloneOptions shallowCommandLineArguments]];
+    }
+
+    [arguments addObject:@"-p"];
+
+    return [self runFetchWithArguments:arguments ensuringRevision:revision];
+}
+
+// mirror (if origin has one) goes first. If it has failed us, or lags behind, we repeat
+// the same fetch against origin's own URL
+- (int)runFetchWithArguments:(NSArray<NSString *> *)arguments ensuringRevision:(nullable NSString *)revision {
+    NSArray<NSString *> *mirrorArguments = [self originMirrorCommandLineArgumentsForPush:NO];
+    if (mirrorArguments.count > 0) {
+        const int mirrorExitStatus = [self runGitWithArguments:[mirrorArguments arrayByAddingObjectsFromArray:arguments]
+                                                  stdOutOutput:NULL
+                                                  stdErrOutput:NULL];
+        if (0 == mirrorExitStatus && (nil == revision || [self isRevisionAvailableLocally:revision])) {
+            return 0;
+        }
+
+        logInfo("  %s, fetching from origin\n",
+                0 == mirrorExitStatus ? "mirror doesn't have the revision yet" : "failed to fetch from mirror");
+    }
+
+    return [self runGitWithArguments:arguments
+                        stdOutOutput:NULL
+                        stdErrOutput:NULL];
+}
+
+- (int)deepenToRevision:(NSString *)revision cloneOptions:(nullable GitCloneOptions *)cloneOptions {
+    if (NO == self.isShallowRepo) {
+        return 0;
+    }
+
+    // first, try to get just the revision we need (and some history before it if
+    // the depth is specified). Most hostings allow to fetch any reachable commit by hash.
+    NSMutableArray<NSString *> *arguments = [NSMutableArray arrayWithObject:@"fetch"];
+
+    NSString *filterArgument = GitFilterCommandLineArgument(cloneOptions.filter);
+    if (filterArgument) {
+        [arguments addObject:filterArgument];
+    }
+
+    [arguments addObject:[NSString stringWithFormat:@"--depth=%lu", (unsigned long)MAX(cloneOptions.depth, 1)]];
+    [arguments addObject:@"origin"];
+    [arguments addObject:revision];
+
+    int exitStatus = [self runFetchWithArguments:arguments ensuringRevision:revision];
+    if (0 == exitStatus && [self isRevisionAvailableLocally:revision]) {
+        return 0;
+    }
+
+    // the server didn't allow to fetch a commit by hash – fall back to the full history
+    exitStatus = [self runFetchWithArguments:@[ @"fetch", @"--unshallow", @"-p" ] ensuringRevision:revision];
+    return exitStatus;
+}
+
+- (int)fetchFromBundleAtPath:(NSString *)bundlePath {
+    // bundle contains remote branches of the repo it was created from, so we map them
+    // as if they were fetched from origin. Pinned revisions keep their refs here too –
+    // otherwise nothing would reference not pushed ones, and gc could prune them.
+    return [self runGitWithArguments:@[ @"fetch",
+                                        @"-q",
+                                        bundlePath,
+                                        @"+refs/remotes/origin/*:refs/remotes/origin/*",
+                                        @"+refs/tags/*:refs/tags/*",
+                                        [NSString stringWithFormat:@"+%@*:%@*", GitBundlePinnedRevisionRefPrefix, GitBundlePinnedRevisionRefPrefix] ]
+                        stdOutOutput:NULL
+                        stdErrOutput:NULL];
+}
+
+- (int)prefetchFromOriginWithCloneOptions:(nullable GitCloneOptions *)cloneOptions {
+    NSMutableArray<NSString *> *arguments = [@[ @"fetch",
+                                                @"-q",
+                                                @"--prune",
+                                                @"--no-tags",
+                                                @"--no-write-fetch-head" ] mutableCopy];
+
+    NSString *filterArgument = GitFilterCommandLineArgument(cloneOptions.filter);
+    if (filterArgument) {
+        [arguments addObject:filterArgument];
+    }
+
+    // the same as -fetchWithCloneOptions:ensuringRevision: – otherwise a new branch
+    // would come with its full history, and the shallow subrepo wouldn't be shallow anymore
+    if (cloneOptions.isShallow && self.isShallowRepo) {
+        [arguments addObjectsFromArray:[cloneOptions shallowCommandLineArguments]];
+    }
+
+    [arguments addObject:@"origin"];
+    [arguments addObject:@"+refs/heads/*:refs/s7-prefetch/origin/*"];
+
+    return [self runFetchWithArguments:arguments ensuringRevision:nil];
+}
+
+- (int)createBundleAtPath:(NSString *)bundlePath revisions:(NSArray<NSString *> *)revisions {
+    // bundle lists only refs as its heads. Objects of a raw hash get into the bundle,
+    // but nothing on the receiving side would point to them. So every pinned revision
+    // gets a ref of its own for the time of bundling.
+    NSMutableArray<NSString *> *pinnedRefs = [NSMutableArray arrayWithCapacity:revisions.count];
+
+    int exitStatus = 0;
+    for (NSString *revision in revisions) {
+        NSString *pinnedRef = [GitBundlePinnedRevisionRefPrefix stringByAppendingString:revision];
+        exitStatus = [self runGitWithArguments:@[ @"update-ref", pinnedRef, revision ]
+                                  stdOutOutput:NULL
+                                  stdErrOutput:NULL];
+        if (0 != exitStatus) {
+            break;
+        }
+
+        [pinnedRefs addObject:pinnedRef];
+    }
+
+    if (0 == exitStatus) {
+        NSArray<NSString *> *arguments = @[ @"bundle", @"create", @"-q", bundlePath, @"--remotes", @"--tags" ];
+        exitStatus = [self runGitWithArguments:[arguments arrayByAddingObjectsFromArray:pinnedRefs]
                                   stdOutOutput:NULL
                                   stdErrOutput:NULL];
+    }
+
+    // the caller wants to know why bundling failed, not how the clean up went
+    NSString *stdErrOutput = _lastCommandStdErrOutput;
+
+    for (NSString *pinnedRef in pinnedRefs) {
+        [self runGitWithArguments:@[ @"update-ref", @"-d", pinnedRef ]
+                     stdOutOutput:NULL
+                     stdErrOutput:NULL];
+    }
+
+    _lastCommandStdErrOutput = stdErrOutput;
+
     return exitStatus;
 }
 
+- (int)setSparseCheckoutDirectories:(NSArray<NSString *> *)directories {
+    NSArray<NSString *> *arguments = [@[ @"sparse-checkout", @"set", @"--cone" ] arrayByAddingObjectsFromArray:directories];
+    return [self runGitWithArguments:arguments
+                        stdOutOutput:NULL
+                        stdErrOutput:NULL];
+}
+
 - (int)pull {
     const int exitStatus = [self runGitCommand:@"pull"
                                   stdOutOutput:NULL
@@ -1173,6 +1940,18 @@ static void (^_testRepoConfigureOnInitBlock)(GitRepository *);
     });
 }
 
+- (int)nonInteractiveMergeWith:(NSString *)commit {
+    // unlike -mergeWith:, this one doesn't change current directory of the whole process
+    // and runs git as a regular child process, thus it's safe to merge several subrepos
+    // concurrently. The price is that nested merge driver (if subrepo is an s7 repo itself)
+    // won't be able to ask user anything – so use it only if all decisions are known
+    // in advance (S7_MERGE_DRIVER_RESPONSE) or nobody's there to answer anyway.
+    //
+    return [self runGitWithArguments:@[ @"merge", @"--no-edit", commit ]
+                        stdOutOutput:NULL
+                        stdErrOutput:NULL];
+}
+
 - (int)merge {
     return [self runGitCommand:@"merge --no-edit"
                   stdOutOutput:NULL
@@ -1180,21 +1959,21 @@ static void (^_testRepoConfigureOnInitBlock)(GitRepository *);
 }
 
 - (BOOL)hasUnpushedCommits {
-    NSString *stdOutOutput = nil;
-    const int logExitStatus = [self runGitCommand:@"log --branches --not --remotes --pretty=format:%h"
-                                     stdOutOutput:&stdOutOutput
-                                     stdErrOutput:NULL];
-    if (0 != logExitStatus) {
-        return NO;
-    }
-
+    // the first line is the answer. No need to let Git list all unpushed commits
+    // in a subrepo that has a long local history
     __block BOOL result = NO;
-    [stdOutOutput enumerateLinesUsingBlock:^(NSString * _Nonnull line, BOOL * _Nonnull stop) {
+    const int logExitStatus =
+    [self
+     runGitWithArguments:@[ @"log", @"--branches", @"--not", @"--remotes", @"--pretty=format:%h" ]
+     stdOutLineHandler:^(NSString * _Nonnull line, BOOL * _Nonnull stop) {
         if (line.length > 0) {
             result = YES;
             *stop = YES;
         }
     }];
+    if (0 != logExitStatus) {
+        return NO;
+    }
 
     return result;
 }
@@ -1216,16 +1995,18 @@ static void (^_testRepoConfigureOnInitBlock)(GitRepository *);
 }
 
 - (int)pushBranch:(NSString *)branchName {
-    const int exitStatus = [self runGitCommand:[NSString stringWithFormat:@"push -u origin %@", branchName]
-                                  stdOutOutput:NULL
-                                  stdErrOutput:NULL];
+    NSArray<NSString *> *arguments = @[ @"push", @"-u", @"origin", branchName ];
+    const int exitStatus = [self runGitWithArguments:[[self originMirrorCommandLineArgumentsForPush:YES] arrayByAddingObjectsFromArray:arguments]
+                                        stdOutOutput:NULL
+                                        stdErrOutput:NULL];
     return exitStatus;
 }
 
 - (int)pushAll {
-    const int exitStatus = [self runGitCommand:@"push --all"
-                                  stdOutOutput:NULL
-                                  stdErrOutput:NULL];
+    NSArray<NSString *> *arguments = @[ @"push", @"--all" ];
+    const int exitStatus = [self runGitWithArguments:[[self originMirrorCommandLineArgumentsForPush:YES] arrayByAddingObjectsFromArray:arguments]
+                                        stdOutOutput:NULL
+                                        stdErrOutput:NULL];
     return exitStatus;
 }
 
@@ -1284,23 +2065,24 @@ static void (^_testRepoConfigureOnInitBlock)(GitRepository *);
                                   exitStatus:(int *)exitStatus
 {
     NSParameterAssert(command);
-    
-    NSString *stdOutOutput = nil;
-    const int logExitStatus = [self runGitCommand:command
-                                     stdOutOutput:&stdOutOutput
-                                     stdErrOutput:NULL];
-    *exitStatus = logExitStatus;
-    if (0 != logExitStatus) {
-        NSAssert(NO, @"what?s");
-        return @[];
-    }
+
+    NSArray<NSString *> *arguments = [self.class argumentsOfCommand:command];
 
     NSMutableArray<NSString *> *result = [NSMutableArray new];
-    [stdOutOutput enumerateLinesUsingBlock:^(NSString * _Nonnull line, BOOL * _Nonnull stop) {
+    const int logExitStatus =
+    [self
+     runGitWithArguments:arguments
+     stdOutLineHandler:^(NSString * _Nonnull line, BOOL * _Nonnull stop) {
         if (line.length > 0) {
             [result addObject:line];
         }
     }];
+    *exitStatus = logExitStatus;
+    if (0 != logExitStatus) {
+        NSAssert(NO, @"what?s");
+        return @[];
+    }
+
     return result;
 }
 
@@ -1360,7 +2142,72 @@ static void (^_testRepoConfigureOnInitBlock)(GitRepository *);
 
 #pragma mark - LFS -
 
+// .gitattributes and hooks are checked on every post-checkout and post-merge
+// in every repo, while they change once in a blue moon
+- (BOOL)cachedBoolForKey:(NSString *)key
+          stampedByFiles:(NSArray<NSString *> *)filePaths
+                 compute:(BOOL (NS_NOESCAPE ^)(void))compute
+{
+    static NSMutableDictionary<NSString *, NSArray *> *cacheKeyToStampsAndValue = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        cacheKeyToStampsAndValue = [NSMutableDictionary new];
+    });
+
+    NSString *cacheKey = [self.absolutePath stringByAppendingFormat:@"#%@", key];
+
+    NSMutableArray *stamps = [NSMutableArray arrayWithCapacity:filePaths.count];
+    for (NSString *filePath in filePaths) {
+        [stamps addObject:fileStampAtPath(filePath)];
+    }
+
+    @synchronized (cacheKeyToStampsAndValue) {
+        NSArray *stampsAndValue = cacheKeyToStampsAndValue[cacheKey];
+        if (stampsAndValue && [stampsAndValue.firstObject isEqualToArray:stamps]) {
+            return [stampsAndValue.lastObject boolValue];
+        }
+    }
+
+    const BOOL value = compute();
+
+    @synchronized (cacheKeyToStampsAndValue) {
+        cacheKeyToStampsAndValue[cacheKey] = @[ stamps, @(value) ];
+    }
+
+    return value;
+}
+
 - (BOOL)isGitLFSRepo {
+    NSString *gitAttributesPath = [self.absolutePath stringByAppendingPathComponent:@".gitattributes"];
+    return [self cachedBoolForKey:@"lfs-repo"
+                   stampedByFiles:@[ gitAttributesPath ]
+                          compute:^BOOL{
+        return [self readIsGitLFSRepo];
+    }];
+}
+
+static NSArray<NSString *> *gitLFSHookNames(void) {
+    return @[@"pre-push",
+             @"post-checkout",
+             @"post-commit",
+             @"post-merge"];
+}
+
+- (BOOL)isGitLFSProperlyInstalled {
+    NSString *hooksDirPath = [self.absolutePath stringByAppendingPathComponent:@".git/hooks"];
+    NSMutableArray<NSString *> *hookPaths = [NSMutableArray new];
+    for (NSString *hookName in gitLFSHookNames()) {
+        [hookPaths addObject:[hooksDirPath stringByAppendingPathComponent:hookName]];
+    }
+
+    return [self cachedBoolForKey:@"lfs-hooks"
+                   stampedByFiles:hookPaths
+                          compute:^BOOL{
+        return [self readIsGitLFSProperlyInstalled];
+    }];
+}
+
+- (BOOL)readIsGitLFSRepo {
     NSString *gitAttributesPath = [self.absolutePath stringByAppendingPathComponent:@".gitattributes"];
     if (NO == [NSFileManager.defaultManager fileExistsAtPath:gitAttributesPath]) {
         return NO;
@@ -1389,12 +2236,8 @@ static void (^_testRepoConfigureOnInitBlock)(GitRepository *);
     return NO;
 }
 
-- (BOOL)isGitLFSProperlyInstalled {
-    for (NSString *hookName in @[@"pre-push",
-                                 @"post-checkout",
-                                 @"post-commit",
-                                 @"post-merge"])
-    {
+- (BOOL)readIsGitLFSProperlyInstalled {
+    for (NSString *hookName in gitLFSHookNames()) {
         NSString *absoluteHookPath = [[self.absolutePath stringByAppendingPathComponent:@".git/hooks"] stringByAppendingPathComponent:hookName];
 
         if (NO == [NSFileManager.defaultManager fileExistsAtPath:absoluteHookPath]) {
@@ -1451,11 +2294,7 @@ static void (^_testRepoConfigureOnInitBlock)(GitRepository *);
     // We will hardcode the hooks for now and regret that in the future in the worst case scenario.
     //
 
-    for (NSString *hookName in @[@"pre-push",
-                                 @"post-checkout",
-                                 @"post-commit",
-                                 @"post-merge"])
-    {
+    for (NSString *hookName in gitLFSHookNames()) {
         NSString *commandLine =
         [NSString
          stringWithFormat:@"command -v git-lfs >/dev/null 2>&1 || { printf >&2 \"\\n%%s\\n\\n\" \"This repository is configured for Git LFS but 'git-lfs' was not found on your path. If you no longer wish to use Git LFS, remove this hook by deleting the '%@' file in the hooks directory (set by 'core.hookspath'; usually '.git/hooks').\"; exit 2; }\ngit lfs %@ \"$@\" <&0\n",
@@ -1480,6 +2319,214 @@ static void (^_testRepoConfigureOnInitBlock)(GitRepository *);
             stdErrOutput:NULL];
 }
 
+- (int)fetchGitLFSObjects {
+    // without arguments fetches objects of the checked out revision only
+    return [self runGitWithArguments:@[@"lfs", @"fetch"]
+                        stdOutOutput:NULL
+                        stdErrOutput:NULL];
+}
+
+- (int)checkoutGitLFSFiles {
+    // pastey:
+    // `git lfs checkout` writes files itself – it doesn't go through the smudge filter,
+    // thus it works even if GIT_LFS_SKIP_SMUDGE is still set in our environment
+    return [self runGitWithArguments:@[@"lfs", @"checkout"]
+                        stdOutOutput:NULL
+                        stdErrOutput:NULL];
+}
+
+- (unsigned long long)sizeOfLocalGitLFSObjects {
+    NSString *objectsDirPath = [self.absolutePath stringByAppendingPathComponent:@".git/lfs/objects"];
+    NSDirectoryEnumerator<NSURL *> *enumerator =
+    [NSFileManager.defaultManager
+     enumeratorAtURL:[NSURL fileURLWithPath:objectsDirPath]
+     includingPropertiesForKeys:@[ NSURLFileSizeKey ]
+     options:0
+     errorHandler:nil];
+
+    unsigned long long size = 0;
+    for (NSURL *url in enumerator) {
+        NSNumber *fileSize = nil;
+        if ([url getResourceValue:&fileSize forKey:NSURLFileSizeKey error:nil]) {
+            size += fileSize.unsignedLongLongValue;
+        }
+    }
+
+    return size;
+}
+
+@end
+
+#pragma mark - statistics -
+
+@implementation GitRepository (Statistics)
+
+// commands are spawned from multiple threads during checkout, merge, etc.
+static NSMutableDictionary<NSString *, NSMutableDictionary<NSString *, NSNumber *> *> *repoPathToVerbToSpawnCount(void) {
+    static NSMutableDictionary<NSString *, NSMutableDictionary<NSString *, NSNumber *> *> *repoPathToVerbToSpawnCount = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        repoPathToVerbToSpawnCount = [NSMutableDictionary new];
+    });
+    return repoPathToVerbToSpawnCount;
+}
+
++ (BOOL)envStatsEnabled {
+    static dispatch_once_t onceToken;
+    static BOOL statsEnabled;
+
+    dispatch_once(&onceToken, ^{
+        statsEnabled = [[NSProcessInfo processInfo].environment[@"S7_STATS"] intValue] != 0;
+    });
+    return statsEnabled;
+}
+
++ (void)recordSpawnOfCommandWithArguments:(NSArray<NSString *> *)arguments
+                     currentDirectoryPath:(NSString * _Nullable)currentDirectoryPath
+{
+    NSString *verb = nil;
+    NSString *repoPath = currentDirectoryPath;
+    for (NSUInteger i = 0; i < arguments.count; ++i) {
+        NSString *argument = arguments[i];
+        if (0 == argument.length || (0 == i && [argument isEqualToString:@"git"])) {
+            // -executeCommand: passes the whole command line, including git itself
+            continue;
+        }
+
+        if ([argument hasPrefix:@"--git-dir="]) {
+            repoPath = [argument substringFromIndex:@"--git-dir=".length];
+            if ([repoPath.lastPathComponent isEqualToString:@".git"]) {
+                repoPath = [repoPath stringByDeletingLastPathComponent];
+            }
+            continue;
+        }
+
+        if ([argument isEqualToString:@"-c"] || [argument isEqualToString:@"-C"]) {
+            // skip option value
+            ++i;
+            continue;
+        }
+
+        if ([argument hasPrefix:@"-"]) {
+            continue;
+        }
+
+        verb = argument;
+        break;
+    }
+
+    if (nil == verb) {
+        verb = @"git";
+    }
+
+    if (nil == repoPath) {
+        repoPath = [NSFileManager.defaultManager currentDirectoryPath];
+    }
+
+    repoPath = [repoPath stringByStandardizingPath];
+
+    NSMutableDictionary<NSString *, NSMutableDictionary<NSString *, NSNumber *> *> *statistics = repoPathToVerbToSpawnCount();
+    @synchronized (statistics) {
+        NSMutableDictionary<NSString *, NSNumber *> *verbToCount = statistics[repoPath];
+        if (nil == verbToCount) {
+            verbToCount = [NSMutableDictionary new];
+            statistics[repoPath] = verbToCount;
+        }
+
+        verbToCount[verb] = @(verbToCount[verb].unsignedIntegerValue + 1);
+    }
+}
+
++ (void)resetSpawnStatistics {
+    NSMutableDictionary<NSString *, NSMutableDictionary<NSString *, NSNumber *> *> *statistics = repoPathToVerbToSpawnCount();
+    @synchronized (statistics) {
+        [statistics removeAllObjects];
+    }
+}
+
++ (NSDictionary<NSString *, NSDictionary<NSString *, NSNumber *> *> *)numberOfSpawnedCommandsByRepository {
+    NSMutableDictionary<NSString *, NSMutableDictionary<NSString *, NSNumber *> *> *statistics = repoPathToVerbToSpawnCount();
+    NSMutableDictionary<NSString *, NSDictionary<NSString *, NSNumber *> *> *result = [NSMutableDictionary new];
+    @synchronized (statistics) {
+        [statistics enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull repoPath, NSMutableDictionary<NSString *, NSNumber *> * _Nonnull verbToCount, BOOL * _Nonnull stop) {
+            result[repoPath] = [verbToCount copy];
+        }];
+    }
+    return result;
+}
+
++ (NSDictionary<NSString *, NSNumber *> *)numberOfSpawnedCommandsByVerb {
+    NSMutableDictionary<NSString *, NSNumber *> *result = [NSMutableDictionary new];
+    [[self numberOfSpawnedCommandsByRepository] enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull repoPath, NSDictionary<NSString *, NSNumber *> * _Nonnull verbToCount, BOOL * _Nonnull stop) {
+        [verbToCount enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull verb, NSNumber * _Nonnull count, BOOL * _Nonnull stop) {
+            result[verb] = @(result[verb].unsignedIntegerValue + count.unsignedIntegerValue);
+        }];
+    }];
+    return result;
+}
+
++ (NSUInteger)numberOfSpawnedCommands {
+    NSUInteger result = 0;
+    for (NSNumber *count in [self numberOfSpawnedCommandsByVerb].allValues) {
+        result += count.unsignedIntegerValue;
+    }
+    return result;
+}
+
+- (NSUInteger)numberOfSpawnedCommands {
+    NSUInteger result = 0;
+    for (NSNumber *count in [self.class numberOfSpawnedCommandsByRepository][self.absolutePath].allValues) {
+        result += count.unsignedIntegerValue;
+    }
+    return result;
+}
+
+static NSString *formatVerbCounts(NSDictionary<NSString *, NSNumber *> *verbToCount) {
+    NSArray<NSString *> *verbs = [verbToCount keysSortedByValueUsingComparator:^NSComparisonResult(NSNumber * _Nonnull lhs, NSNumber * _Nonnull rhs) {
+        return [rhs compare:lhs];
+    }];
+
+    NSMutableArray<NSString *> *components = [NSMutableArray arrayWithCapacity:verbs.count];
+    for (NSString *verb in verbs) {
+        [components addObject:[NSString stringWithFormat:@"%@ %@", verb, verbToCount[verb]]];
+    }
+
+    return [components componentsJoinedByString:@", "];
+}
+
++ (void)printSpawnStatistics {
+    NSDictionary<NSString *, NSDictionary<NSString *, NSNumber *> *> *repoPathToVerbToCount = [self numberOfSpawnedCommandsByRepository];
+
+    fprintf(stderr, "s7 stats: %lu git process(es) spawned\n", (unsigned long)[self numberOfSpawnedCommands]);
+    if (0 == repoPathToVerbToCount.count) {
+        return;
+    }
+
+    fprintf(stderr, "  by command: %s\n", [formatVerbCounts([self numberOfSpawnedCommandsByVerb]) cStringUsingEncoding:NSUTF8StringEncoding]);
+    fprintf(stderr, "  by repository:\n");
+
+    NSString *cwd = [[NSFileManager.defaultManager currentDirectoryPath] stringByStandardizingPath];
+    for (NSString *repoPath in [repoPathToVerbToCount.allKeys sortedArrayUsingSelector:@selector(compare:)]) {
+        NSString *displayPath = repoPath;
+        if ([repoPath isEqualToString:cwd]) {
+            displayPath = @".";
+        }
+        else if ([repoPath hasPrefix:[cwd stringByAppendingString:@"/"]]) {
+            displayPath = [repoPath substringFromIndex:cwd.length + 1];
+        }
+
+        NSUInteger total = 0;
+        for (NSNumber *count in repoPathToVerbToCount[repoPath].allValues) {
+            total += count.unsignedIntegerValue;
+        }
+
+        fprintf(stderr, "    %s: %lu (%s)\n",
+                displayPath.fileSystemRepresentation,
+                (unsigned long)total,
+                [formatVerbCounts(repoPathToVerbToCount[repoPath]) cStringUsingEncoding:NSUTF8StringEncoding]);
+    }
+}
+
 @end
 
 #pragma mark - utils for tests -
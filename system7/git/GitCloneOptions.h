@@ -0,0 +1,41 @@
+//
+//  GitCloneOptions.h
+//  system7
+//
+//  Copyright © 2026 Readdle. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "GitFilter.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Describes how much of a repository we want to have locally.
+// Used for both clone and subsequent fetches, so that a shallow or a sparse
+// subrepo stays shallow/sparse after the first clone.
+//
+@interface GitCloneOptions : NSObject <NSCopying>
+
++ (instancetype)optionsWithFilter:(GitFilter)filter;
+
+@property (nonatomic, assign) GitFilter filter;
+
+// `--depth`. 0 means full history
+@property (nonatomic, assign) NSUInteger depth;
+
+// `--shallow-since`. Any date format git understands. Ignored if depth is set,
+// as git doesn't allow to mix these two.
+@property (nonatomic, copy, nullable) NSString *shallowSince;
+
+// directories for cone-mode sparse-checkout. nil or empty means full checkout
+@property (nonatomic, copy, nullable) NSArray<NSString *> *sparseCheckoutDirectories;
+
+@property (nonatomic, readonly, getter=isShallow) BOOL shallow;
+@property (nonatomic, readonly, getter=isSparse) BOOL sparse;
+
+// `--depth`/`--shallow-since` arguments or an empty array for a full-history clone
+- (NSArray<NSString *> *)shallowCommandLineArguments;
+
+@end
+
+NS_ASSUME_NONNULL_END
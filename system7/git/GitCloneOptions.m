@@ -0,0 +1,69 @@
+//
+//  GitCloneOptions.m
+//  system7
+//
+//  Copyright © 2026 Readdle. All rights reserved.
+//
+
+#import "GitCloneOptions.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@implementation GitCloneOptions
+
++ (instancetype)optionsWithFilter:(GitFilter)filter {
+    GitCloneOptions *options = [self new];
+    options.filter = filter;
+    return options;
+}
+
+- (BOOL)isShallow {
+    return self.depth > 0 || self.shallowSince.length > 0;
+}
+
+- (BOOL)isSparse {
+    return self.sparseCheckoutDirectories.count > 0;
+}
+
+- (NSArray<NSString *> *)shallowCommandLineArguments {
+    if (self.depth > 0) {
+        return @[ [NSString stringWithFormat:@"--depth=%lu", (unsigned long)self.depth] ];
+    }
+
+    if (self.shallowSince.length > 0) {
+        return @[ [NSString stringWithFormat:@"--shallow-since=%@", self.shallowSince] ];
+    }
+
+    return @[];
+}
+
+- (id)copyWithZone:(nullable NSZone *)zone {
+    GitCloneOptions *copy = [[self.class allocWithZone:zone] init];
+    copy.filter = self.filter;
+    copy.depth = self.depth;
+    copy.shallowSince = self.shallowSince;
+    copy.sparseCheckoutDirectories = self.sparseCheckoutDirectories;
+    return copy;
+}
+
+- (NSString *)description {
+    NSMutableArray<NSString *> *components = [NSMutableArray new];
+
+    NSString *filterArgument = GitFilterCommandLineArgument(self.filter);
+    if (filterArgument) {
+        [components addObject:filterArgument];
+    }
+
+    [components addObjectsFromArray:[self shallowCommandLineArguments]];
+
+    if (self.isSparse) {
+        [components addObject:[NSString stringWithFormat:@"--sparse (%@)",
+                               [self.sparseCheckoutDirectories componentsJoinedByString:@", "]]];
+    }
+
+    return [NSString stringWithFormat:@"<%@: %@>", NSStringFromClass(self.class), [components componentsJoinedByString:@" "]];
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,51 @@
+//
+//  GitConfig.h
+//  system7
+//
+//  Copyright © 2026 Readdle. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// In-process reader of Git config, so that simple questions like "what's the url of origin"
+// or "is this branch tracking anything" don't cost us a `git config` process per subrepo.
+//
+// Reads system, global and local config files in the same order Git does, follows
+// `include.path` and `includeIf "gitdir:..."`, and keeps every value of multi-valued keys.
+//
+// Anything we don't understand (`onbranch:` conditions, value continuation lines,
+// config passed through environment, etc.) marks config as `requiresGit`.
+// Callers must ask real Git in that case.
+//
+@interface GitConfig : NSObject
+
+- (instancetype)init NS_UNAVAILABLE;
++ (instancetype)new NS_UNAVAILABLE;
+
+// Cached per git dir. Cached config is re-read if any of the files it was built from
+// has changed on disk (or appeared/disappeared).
++ (GitConfig *)configForGitDirectory:(NSString *)gitDirPath;
+
++ (void)invalidateCache;
+
+@property (nonatomic, readonly) BOOL requiresGit;
+
+// key is 'section.key' or 'section.subsection.key'. Section and key names are case-insensitive,
+// subsection is case-sensitive – just like in Git.
+// The last value wins – just like `git config <key>`. nil if key is not set.
+- (nullable NSString *)stringForKey:(NSString *)key;
+// all values in the order Git would report them with `git config --get-all <key>`
+- (NSArray<NSString *> *)stringsForKey:(NSString *)key;
+- (BOOL)boolForKey:(NSString *)key defaultValue:(BOOL)defaultValue;
+
+// subsections of a section in order of appearance. For example, names of remotes for "remote"
+- (NSArray<NSString *> *)subsectionsOfSection:(NSString *)section;
+
+// for tests and private use. Doesn't read any files except for the given one and its includes
++ (GitConfig *)configWithContentsOfFile:(NSString *)filePath gitDirectory:(nullable NSString *)gitDirPath;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,504 @@
+//
+//  GitConfig.m
+//  system7
+//
+//  Copyright © 2026 Readdle. All rights reserved.
+//
+
+#import "GitConfig.h"
+
+#import "S7IniConfig.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+// Git refuses to go deeper than that too
+static const NSUInteger GitConfigMaxIncludeDepth = 10;
+
+static BOOL parseSectionTitle(NSString *sectionTitle, NSString * _Nullable __autoreleasing * _Nonnull ppSection, NSString * _Nullable __autoreleasing * _Nonnull ppSubsection) {
+    const NSRange whitespaceRange = [sectionTitle rangeOfCharacterFromSet:[NSCharacterSet whitespaceCharacterSet]];
+    if (NSNotFound != whitespaceRange.location) {
+        // [section "subsection"]
+        NSString *quotedSubsection = [[sectionTitle substringFromIndex:whitespaceRange.location]
+                                      stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+        if (quotedSubsection.length < 2 || NO == [quotedSubsection hasPrefix:@"\""] || NO == [quotedSubsection hasSuffix:@"\""]) {
+            return NO;
+        }
+
+        NSMutableString *subsection = [NSMutableString new];
+        BOOL escaped = NO;
+        for (NSUInteger i = 1; i < quotedSubsection.length - 1; ++i) {
+            const unichar c = [quotedSubsection characterAtIndex:i];
+            if (NO == escaped && '\\' == c) {
+                escaped = YES;
+                continue;
+            }
+
+            escaped = NO;
+            [subsection appendFormat:@"%C", c];
+        }
+
+        *ppSection = [sectionTitle substringToIndex:whitespaceRange.location].lowercaseString;
+        *ppSubsection = subsection;
+        return YES;
+    }
+
+    const NSRange dotRange = [sectionTitle rangeOfString:@"."];
+    if (NSNotFound != dotRange.location) {
+        // deprecated [section.subsection] syntax. Subsection is lowercased in this case.
+        *ppSection = [sectionTitle substringToIndex:dotRange.location].lowercaseString;
+        *ppSubsection = [sectionTitle substringFromIndex:NSMaxRange(dotRange)].lowercaseString;
+        return YES;
+    }
+
+    *ppSection = sectionTitle.lowercaseString;
+    *ppSubsection = nil;
+    return YES;
+}
+
+// nil if value is continued on the next line – S7IniConfig doesn't support that
+static NSString * _Nullable unquoteValue(NSString *value) {
+    if (NSNotFound == [value rangeOfCharacterFromSet:[NSCharacterSet characterSetWithCharactersInString:@"\"\\"]].location) {
+        return value;
+    }
+
+    NSMutableString *result = [NSMutableString new];
+    for (NSUInteger i = 0; i < value.length; ++i) {
+        const unichar c = [value characterAtIndex:i];
+        if ('"' == c) {
+            continue;
+        }
+
+        if ('\\' == c) {
+            if (i + 1 == value.length) {
+                return nil;
+            }
+
+            const unichar escapedChar = [value characterAtIndex:++i];
+            switch (escapedChar) {
+                case 'n': [result appendString:@"\n"]; break;
+                case 't': [result appendString:@"\t"]; break;
+                case 'b': [result appendString:@"\b"]; break;
+                default: [result appendFormat:@"%C", escapedChar]; break;
+            }
+            continue;
+        }
+
+        [result appendFormat:@"%C", c];
+    }
+
+    return result;
+}
+
+static NSString *canonicalKeyFromComponents(NSString *section, NSString * _Nullable subsection, NSString *key) {
+    if (subsection) {
+        return [NSString stringWithFormat:@"%@.%@.%@", section, subsection, key];
+    }
+    return [NSString stringWithFormat:@"%@.%@", section, key];
+}
+
+static NSString * _Nullable canonicalKey(NSString *key) {
+    const NSRange firstDotRange = [key rangeOfString:@"."];
+    const NSRange lastDotRange = [key rangeOfString:@"." options:NSBackwardsSearch];
+    if (NSNotFound == firstDotRange.location) {
+        return nil;
+    }
+
+    NSString *section = [key substringToIndex:firstDotRange.location].lowercaseString;
+    NSString *name = [key substringFromIndex:NSMaxRange(lastDotRange)].lowercaseString;
+    NSString *subsection = nil;
+    if (firstDotRange.location != lastDotRange.location) {
+        subsection = [key substringWithRange:NSMakeRange(NSMaxRange(firstDotRange),
+                                                         lastDotRange.location - NSMaxRange(firstDotRange))];
+    }
+
+    return canonicalKeyFromComponents(section, subsection, name);
+}
+
+static NSRegularExpression * _Nullable regexFromWildmatchPattern(NSString *pattern, BOOL caseInsensitive) {
+    NSMutableString *regexPattern = [NSMutableString stringWithString:@"^"];
+
+    for (NSUInteger i = 0; i < pattern.length; ++i) {
+        const unichar c = [pattern characterAtIndex:i];
+        switch (c) {
+            case '*': {
+                const BOOL doubleStar = (i + 1 < pattern.length && '*' == [pattern characterAtIndex:i + 1]);
+                if (NO == doubleStar) {
+                    [regexPattern appendString:@"[^/]*"];
+                    break;
+                }
+
+                ++i;
+                if (i + 1 < pattern.length && '/' == [pattern characterAtIndex:i + 1]) {
+                    // '**/' – zero or more directories
+                    ++i;
+                    [regexPattern appendString:@"(?:.*/)?"];
+                }
+                else {
+                    [regexPattern appendString:@".*"];
+                }
+                break;
+            }
+
+            case '?':
+                [regexPattern appendString:@"[^/]"];
+                break;
+
+            case '[': {
+                const NSRange closingBracketRange = [pattern rangeOfString:@"]" options:0 range:NSMakeRange(i + 1, pattern.length - i - 1)];
+                if (NSNotFound == closingBracketRange.location) {
+                    return nil;
+                }
+
+                NSString *characterClass = [pattern substringWithRange:NSMakeRange(i + 1, closingBracketRange.location - i - 1)];
+                if ([characterClass hasPrefix:@"!"]) {
+                    characterClass = [@"^" stringByAppendingString:[characterClass substringFromIndex:1]];
+                }
+                [regexPattern appendFormat:@"[%@]", characterClass];
+                i = closingBracketRange.location;
+                break;
+            }
+
+            case '\\':
+                if (i + 1 < pattern.length) {
+                    ++i;
+                    [regexPattern appendString:[NSRegularExpression escapedPatternForString:[NSString stringWithFormat:@"%C", [pattern characterAtIndex:i]]]];
+                }
+                break;
+
+            default:
+                [regexPattern appendString:[NSRegularExpression escapedPatternForString:[NSString stringWithFormat:@"%C", c]]];
+                break;
+        }
+    }
+
+    [regexPattern appendString:@"$"];
+
+    return [NSRegularExpression regularExpressionWithPattern:regexPattern
+                                                     options:caseInsensitive ? NSRegularExpressionCaseInsensitive : 0
+                                                       error:nil];
+}
+
+@interface GitConfig ()
+
+@property (nonatomic, nullable, strong) NSString *gitDirPath;
+
+// canonical key -> values in order of appearance.
+// Canonical key has section and key names lowercased, subsection untouched.
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSMutableArray<NSString *> *> *keyToValues;
+// lowercased section -> subsections
+@property (nonatomic, strong) NSMutableDictionary<NSString *, NSMutableOrderedSet<NSString *> *> *sectionToSubsections;
+
+// every file we've looked at (even non-existing) -> its stamp at the moment we read it
+@property (nonatomic, strong) NSMutableDictionary<NSString *, id> *filePathToStamp;
+
+@property (nonatomic, assign) BOOL requiresGit;
+
+@end
+
+@implementation GitConfig
+
+- (instancetype)initWithGitDirectory:(nullable NSString *)gitDirPath {
+    self = [super init];
+    if (nil == self) {
+        return nil;
+    }
+
+    _gitDirPath = gitDirPath;
+    _keyToValues = [NSMutableDictionary new];
+    _sectionToSubsections = [NSMutableDictionary new];
+    _filePathToStamp = [NSMutableDictionary new];
+
+    return self;
+}
+
+#pragma mark - cache -
+
++ (NSMutableDictionary<NSString *, GitConfig *> *)cache {
+    static NSMutableDictionary<NSString *, GitConfig *> *gitDirPathToConfig = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        gitDirPathToConfig = [NSMutableDictionary new];
+    });
+    return gitDirPathToConfig;
+}
+
++ (GitConfig *)configForGitDirectory:(NSString *)gitDirPath {
+    // subrepos are checked out from multiple threads
+    NSMutableDictionary<NSString *, GitConfig *> *cache = [self cache];
+    @synchronized (cache) {
+        GitConfig *config = cache[gitDirPath];
+        if (config && config.isUpToDate) {
+            return config;
+        }
+
+        config = [self readConfigForGitDirectory:gitDirPath];
+        cache[gitDirPath] = config;
+        return config;
+    }
+}
+
++ (void)invalidateCache {
+    NSMutableDictionary<NSString *, GitConfig *> *cache = [self cache];
+    @synchronized (cache) {
+        [cache removeAllObjects];
+    }
+}
+
+- (BOOL)isUpToDate {
+    for (NSString *filePath in self.filePathToStamp) {
+        if (NO == [self.filePathToStamp[filePath] isEqual:fileStampAtPath(filePath)]) {
+            return NO;
+        }
+    }
+
+    return YES;
+}
+
+#pragma mark - reading -
+
++ (GitConfig *)readConfigForGitDirectory:(NSString *)gitDirPath {
+    GitConfig *config = [[GitConfig alloc] initWithGitDirectory:gitDirPath];
+
+    NSDictionary<NSString *, NSString *> *environment = NSProcessInfo.processInfo.environment;
+    if (environment[@"GIT_CONFIG"] || environment[@"GIT_CONFIG_PARAMETERS"] || environment[@"GIT_CONFIG_COUNT"]) {
+        // `git -c` or something alike. Let git deal with it.
+        config.requiresGit = YES;
+        return config;
+    }
+
+    // System-wide config is read only if GIT_CONFIG_SYSTEM points to it. Its default
+    // location depends on how Git was built (Apple's git keeps it inside the toolchain),
+    // and s7 never asks about things that live there – remotes and branches of a particular
+    // repo, or whether it's bare.
+    NSString *systemConfigPath = environment[@"GIT_CONFIG_SYSTEM"];
+    if (systemConfigPath.length > 0 && nil == environment[@"GIT_CONFIG_NOSYSTEM"]) {
+        [config readFileAtPath:systemConfigPath depth:0];
+    }
+
+    NSString *globalConfigPath = environment[@"GIT_CONFIG_GLOBAL"];
+    if (globalConfigPath) {
+        if (globalConfigPath.length > 0) {
+            [config readFileAtPath:globalConfigPath depth:0];
+        }
+    }
+    else {
+        NSString *xdgConfigHome = environment[@"XDG_CONFIG_HOME"];
+        if (0 == xdgConfigHome.length) {
+            xdgConfigHome = [NSHomeDirectory() stringByAppendingPathComponent:@".config"];
+        }
+
+        [config readFileAtPath:[xdgConfigHome stringByAppendingPathComponent:@"git/config"] depth:0];
+        [config readFileAtPath:[NSHomeDirectory() stringByAppendingPathComponent:@".gitconfig"] depth:0];
+    }
+
+    [config readFileAtPath:[gitDirPath stringByAppendingPathComponent:@"config"] depth:0];
+
+    if ([config boolForKey:@"extensions.worktreeConfig" defaultValue:NO]) {
+        config.requiresGit = YES;
+    }
+
+    return config;
+}
+
++ (GitConfig *)configWithContentsOfFile:(NSString *)filePath gitDirectory:(nullable NSString *)gitDirPath {
+    GitConfig *config = [[GitConfig alloc] initWithGitDirectory:gitDirPath];
+    [config readFileAtPath:filePath depth:0];
+    return config;
+}
+
+- (void)readFileAtPath:(NSString *)filePath depth:(NSUInteger)depth {
+    if (self.requiresGit) {
+        return;
+    }
+
+    if (depth > GitConfigMaxIncludeDepth) {
+        self.requiresGit = YES;
+        return;
+    }
+
+    self.filePathToStamp[filePath] = fileStampAtPath(filePath);
+
+    if (NO == [NSFileManager.defaultManager fileExistsAtPath:filePath]) {
+        return;
+    }
+
+    NSString *contents = [[NSString alloc] initWithContentsOfFile:filePath encoding:NSUTF8StringEncoding error:nil];
+    if (nil == contents) {
+        self.requiresGit = YES;
+        return;
+    }
+
+    __block NSString *section = nil;
+    __block NSString *subsection = nil;
+
+    [S7IniConfig
+     enumerateEntriesOfString:contents
+     usingBlock:^(NSString * _Nonnull sectionTitle, NSString * _Nullable key, NSString * _Nullable value) {
+        if (self.requiresGit) {
+            return;
+        }
+
+        if (nil == key) {
+            NSString *parsedSection = nil;
+            NSString *parsedSubsection = nil;
+            if (NO == parseSectionTitle(sectionTitle, &parsedSection, &parsedSubsection)) {
+                self.requiresGit = YES;
+                return;
+            }
+
+            section = parsedSection;
+            subsection = parsedSubsection;
+
+            if (subsection) {
+                NSMutableOrderedSet<NSString *> *subsections = self.sectionToSubsections[section];
+                if (nil == subsections) {
+                    subsections = [NSMutableOrderedSet new];
+                    self.sectionToSubsections[section] = subsections;
+                }
+                [subsections addObject:subsection];
+            }
+
+            return;
+        }
+
+        NSString *unquotedValue = unquoteValue(value);
+        if (nil == unquotedValue) {
+            self.requiresGit = YES;
+            return;
+        }
+
+        NSString *canonicalKey = canonicalKeyFromComponents(section, subsection, key.lowercaseString);
+
+        NSMutableArray<NSString *> *values = self.keyToValues[canonicalKey];
+        if (nil == values) {
+            values = [NSMutableArray new];
+            self.keyToValues[canonicalKey] = values;
+        }
+        [values addObject:unquotedValue];
+
+        if (NO == [key.lowercaseString isEqualToString:@"path"]) {
+            return;
+        }
+
+        if ([section isEqualToString:@"include"] && nil == subsection) {
+            [self readFileAtPath:[self resolveIncludePath:unquotedValue includedFromFileAtPath:filePath] depth:depth + 1];
+        }
+        else if ([section isEqualToString:@"includeif"] && subsection) {
+            BOOL conditionSupported = NO;
+            if ([self evaluateIncludeCondition:subsection includedFromFileAtPath:filePath supported:&conditionSupported]) {
+                [self readFileAtPath:[self resolveIncludePath:unquotedValue includedFromFileAtPath:filePath] depth:depth + 1];
+            }
+            else if (NO == conditionSupported) {
+                self.requiresGit = YES;
+            }
+        }
+    }
+     malformedLineBlock:^(NSString * _Nonnull trimmedLine, NSString * _Nonnull lineKind) {
+        // for example, a key without value, which Git treats as boolean 'true'
+        self.requiresGit = YES;
+    }];
+}
+
+- (NSString *)resolveIncludePath:(NSString *)includePath includedFromFileAtPath:(NSString *)filePath {
+    NSString *path = [includePath stringByExpandingTildeInPath];
+    if (NO == path.isAbsolutePath) {
+        path = [[filePath stringByDeletingLastPathComponent] stringByAppendingPathComponent:path];
+    }
+    return [path stringByStandardizingPath];
+}
+
+- (BOOL)evaluateIncludeCondition:(NSString *)condition
+          includedFromFileAtPath:(NSString *)filePath
+                       supported:(BOOL *)supported
+{
+    BOOL caseInsensitive = NO;
+    NSString *pattern = nil;
+    if ([condition hasPrefix:@"gitdir:"]) {
+        pattern = [condition substringFromIndex:@"gitdir:".length];
+    }
+    else if ([condition hasPrefix:@"gitdir/i:"]) {
+        pattern = [condition substringFromIndex:@"gitdir/i:".length];
+        caseInsensitive = YES;
+    }
+    else {
+        // onbranch:, hasconfig:remote.*.url: and whatever comes next
+        *supported = NO;
+        return NO;
+    }
+
+    *supported = YES;
+
+    if (nil == self.gitDirPath) {
+        return NO;
+    }
+
+    // rules are from https://git-scm.com/docs/git-config#_conditional_includes
+    if ([pattern hasPrefix:@"~/"]) {
+        pattern = [pattern stringByExpandingTildeInPath];
+    }
+    else if ([pattern hasPrefix:@"./"]) {
+        pattern = [[filePath stringByDeletingLastPathComponent] stringByAppendingPathComponent:[pattern substringFromIndex:2]];
+    }
+    else if (NO == [pattern hasPrefix:@"/"]) {
+        pattern = [@"**/" stringByAppendingString:pattern];
+    }
+
+    if ([pattern hasSuffix:@"/"]) {
+        pattern = [pattern stringByAppendingString:@"**"];
+    }
+
+    NSRegularExpression *regex = regexFromWildmatchPattern(pattern, caseInsensitive);
+    if (nil == regex) {
+        *supported = NO;
+        return NO;
+    }
+
+    NSString *gitDirPath = [self.gitDirPath stringByStandardizingPath];
+    for (NSString *path in @[ gitDirPath, [gitDirPath stringByResolvingSymlinksInPath] ]) {
+        if ([regex firstMatchInString:path options:0 range:NSMakeRange(0, path.length)]) {
+            return YES;
+        }
+    }
+
+    return NO;
+}
+
+#pragma mark - queries -
+
+- (nullable NSString *)stringForKey:(NSString *)key {
+    return [self stringsForKey:key].lastObject;
+}
+
+- (NSArray<NSString *> *)stringsForKey:(NSString *)key {
+    NSString *canonical = canonicalKey(key);
+    if (nil == canonical) {
+        return @[];
+    }
+
+    return [self.keyToValues[canonical] copy] ?: @[];
+}
+
+- (BOOL)boolForKey:(NSString *)key defaultValue:(BOOL)defaultValue {
+    NSString *value = [self stringForKey:key].lowercaseString;
+    if (nil == value) {
+        return defaultValue;
+    }
+
+    if ([@[ @"true", @"yes", @"on" ] containsObject:value]) {
+        return YES;
+    }
+
+    if ([@[ @"false", @"no", @"off", @"" ] containsObject:value]) {
+        return NO;
+    }
+
+    return [value integerValue] != 0;
+}
+
+- (NSArray<NSString *> *)subsectionsOfSection:(NSString *)section {
+    return self.sectionToSubsections[section.lowercaseString].array ?: @[];
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -11,9 +11,14 @@ NS_ASSUME_NONNULL_BEGIN
 typedef NS_ENUM(NSInteger, GitFilter) {
     GitFilterUnspecified,
     GitFilterNone,
-    GitFilterBlobNone
+    GitFilterBlobNone,
+    GitFilterTreeNone
 };
 
 extern NSString * const kGitFilterBlobNone;
+extern NSString * const kGitFilterTreeNone;
+
+// returns `--filter=<spec>` argument for git clone/fetch or nil if filter doesn't require any
+NSString * _Nullable GitFilterCommandLineArgument(GitFilter filter);
 
 NS_ASSUME_NONNULL_END
@@ -12,5 +12,22 @@
 NS_ASSUME_NONNULL_BEGIN
 
 NSString * const kGitFilterBlobNone = @"blob:none";
+NSString * const kGitFilterTreeNone = @"tree:0";
+
+NSString * _Nullable GitFilterCommandLineArgument(GitFilter filter) {
+    switch (filter) {
+        case GitFilterBlobNone:
+            return [NSString stringWithFormat:@"--filter=%@", kGitFilterBlobNone];
+
+        case GitFilterTreeNone:
+            return [NSString stringWithFormat:@"--filter=%@", kGitFilterTreeNone];
+
+        case GitFilterUnspecified:
+        case GitFilterNone:
+            return nil;
+    }
+
+    return nil;
+}
 
 NS_ASSUME_NONNULL_END
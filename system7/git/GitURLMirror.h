@@ -0,0 +1,42 @@
+//
+//  GitURLMirror.h
+//  system7
+//
+//  Copyright © 2026 Readdle. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+// A `[mirror "<prefix>"]` rule: repos with URLs starting with `prefix` are fetched
+// from `mirrorPrefix` + the rest of the URL.
+//
+// The rule is passed to each git command as `-c url.<mirror prefix>.insteadOf=<prefix>`,
+// thus .s7substate and remotes of subrepos keep the original URL, and a machine without
+// the rule (or with a different mirror) works with the same repos as usual.
+//
+@interface GitURLMirror : NSObject
+
++ (instancetype)mirrorWithPrefix:(NSString *)prefix
+                    mirrorPrefix:(NSString *)mirrorPrefix
+                    includesPush:(BOOL)includesPush;
+
+@property (nonatomic, readonly, copy) NSString *prefix;
+@property (nonatomic, readonly, copy) NSString *mirrorPrefix;
+// `scope = fetch-and-push`. Otherwise pushes go to the original URL
+@property (nonatomic, readonly) BOOL includesPush;
+
+- (BOOL)appliesToURL:(NSString *)url;
+
+// to be put before git command verb
+- (NSArray<NSString *> *)configCommandLineArguments;
+
+// the most specific (longest prefix) rule, the same as Git picks among `insteadOf`-s
++ (nullable GitURLMirror *)mirrorForURL:(NSString *)url
+                              amongRules:(NSArray<GitURLMirror *> *)rules
+                                    push:(BOOL)push;
+
+@end
+
+NS_ASSUME_NONNULL_END
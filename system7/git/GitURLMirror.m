@@ -0,0 +1,75 @@
+//
+//  GitURLMirror.m
+//  system7
+//
+//  Copyright © 2026 Readdle. All rights reserved.
+//
+
+#import "GitURLMirror.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@implementation GitURLMirror
+
++ (instancetype)mirrorWithPrefix:(NSString *)prefix
+                    mirrorPrefix:(NSString *)mirrorPrefix
+                    includesPush:(BOOL)includesPush
+{
+    GitURLMirror *mirror = [self new];
+    mirror->_prefix = [prefix copy];
+    mirror->_mirrorPrefix = [mirrorPrefix copy];
+    mirror->_includesPush = includesPush;
+    return mirror;
+}
+
+- (BOOL)appliesToURL:(NSString *)url {
+    return self.prefix.length > 0 && [url hasPrefix:self.prefix];
+}
+
+- (NSArray<NSString *> *)configCommandLineArguments {
+    return @[ @"-c", [NSString stringWithFormat:@"url.%@.insteadOf=%@", self.mirrorPrefix, self.prefix] ];
+}
+
++ (nullable GitURLMirror *)mirrorForURL:(NSString *)url
+                              amongRules:(NSArray<GitURLMirror *> *)rules
+                                    push:(BOOL)push
+{
+    GitURLMirror *result = nil;
+    for (GitURLMirror *rule in rules) {
+        if (push && NO == rule.includesPush) {
+            continue;
+        }
+
+        if ([rule appliesToURL:url] && rule.prefix.length > result.prefix.length) {
+            result = rule;
+        }
+    }
+
+    return result;
+}
+
+- (BOOL)isEqual:(id)object {
+    if (NO == [object isKindOfClass:[GitURLMirror class]]) {
+        return NO;
+    }
+
+    GitURLMirror *other = (GitURLMirror *)object;
+    return [self.prefix isEqualToString:other.prefix]
+           && [self.mirrorPrefix isEqualToString:other.mirrorPrefix]
+           && self.includesPush == other.includesPush;
+}
+
+- (NSUInteger)hash {
+    return self.prefix.hash ^ self.mirrorPrefix.hash;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"%@ -> %@ (%@)",
+            self.prefix,
+            self.mirrorPrefix,
+            self.includesPush ? @"fetch-and-push" : @"fetch"];
+}
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -20,6 +20,9 @@
 #import "S7CheckoutCommand.h"
 #import "S7BootstrapCommand.h"
 #import "S7VersionCommand.h"
+#import "S7BundleCommand.h"
+#import "S7PrefetchCommand.h"
+#import "S7PullCommand.h"
 
 #import "S7PrePushHook.h"
 #import "S7PostCheckoutHook.h"
@@ -30,6 +33,8 @@
 #import "S7ConfigMergeDriver.h"
 
 #import "S7HelpPager.h"
+#import "S7Options.h"
+#import "Git+Statistics.h"
 
 void printHelp(void) {
     help_puts("");
@@ -56,6 +61,12 @@ void printHelp(void) {
     help_puts("");
     help_puts("  status    show changed subrepos");
     help_puts("");
+    help_puts("  bundle    create git bundles of all subrepos to seed clones on CI");
+    help_puts("");
+    help_puts("  prefetch  fetch subrepos in background (from cron, at idle, etc.)");
+    help_puts("");
+    help_puts("  pull      `git pull` that fetches the main repo and subrepos at once");
+    help_puts("");
     help_puts("\033[1mFAQ\033[0m");
     help_puts("");
     help_puts(" Q: how to push changes to subrepos together with the main repo?");
@@ -80,9 +91,14 @@ void printHelp(void) {
     help_puts("    positive integer, s7 will log each git command, it's stdout and stderr");
     help_puts("    output (if any), and git return code.");
     help_puts("");
+    help_puts(" S7_STATS");
+    help_puts("    If set to positive integer, s7 prints the number of git processes it has");
+    help_puts("    spawned, by git command and by repository, to stderr at exit.");
+    help_puts("");
     help_puts(" S7_MERGE_DRIVER_RESPONSE");
     help_puts("    Specific response that automates s7 merge driver. Options are the same as");
     help_puts("    driver's prompt input: (m)erge, keep (l)ocal or keep (r)emote.");
+    help_puts("    With the response known in advance, diverged subrepos are merged in parallel.");
     help_puts(" S7_MERGE_DRIVER_INTERMEDIATE_BRANCH");
     help_puts("    If this option is set and user chooses (m)erge resolution. Then the merge is");
     help_puts("    performed not directly to the <local>, but an intermediate branch named");
@@ -125,6 +141,9 @@ Class commandClassByName(NSString *commandName) {
             [S7CheckoutCommand class],
             [S7BootstrapCommand class],
             [S7VersionCommand class],
+            [S7BundleCommand class],
+            [S7PrefetchCommand class],
+            [S7PullCommand class],
         ]];
 
         for (Class<S7Command> commandClass in commandClasses) {
@@ -217,6 +236,18 @@ int helpCommand(NSArray<NSString *> *arguments) {
     });
 }
 
+static void printSpawnStatisticsAtExit(void) {
+    @autoreleasepool {
+        [GitRepository printSpawnStatistics];
+    }
+}
+
+static void stopSSHMultiplexingAtExit(void) {
+    @autoreleasepool {
+        [GitRepository stopSSHMultiplexing];
+    }
+}
+
 int main(int argc, const char * argv[]) {
     // Turn off stdout buffering to make sure that the order of output corresponds to the logic we have in code.
     // stderr is not buffered by default. If we don't flush stdout after each fprintf,
@@ -238,6 +269,11 @@ int main(int argc, const char * argv[]) {
     //
     setbuf(stdout, NULL);
 
+    if ([GitRepository envStatsEnabled]) {
+        // atexit to catch every return path, as well as exit() calls deep inside
+        atexit(printSpawnStatisticsAtExit);
+    }
+
     if (argc < 2) {
         helpCommand(@[]);
         return S7ExitCodeUnknownCommand;
@@ -266,6 +302,15 @@ int main(int argc, const char * argv[]) {
         return S7ExitCodeNotGitRepository;
     }
 
+    S7Options *options = [S7Options optionsForRepoAtPath:cwd];
+
+    GitRepository.urlMirrors = options.urlMirrors;
+
+    if (options.sshMultiplexing.boolValue) {
+        [GitRepository startSSHMultiplexing];
+        atexit(stopSSHMultiplexingAtExit);
+    }
+
     if ([commandName hasSuffix:@"-hook"]) {
         commandName = [commandName stringByReplacingOccurrencesOfString:@"-hook" withString:@""];
         Class<S7Hook> hookClass = hookClassByName(commandName);